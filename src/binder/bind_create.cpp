@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -112,7 +113,39 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  auto format = TableFormat::ROW;
+  auto encoding = TableEncoding::PLAIN;
+  if (pg_stmt->options != nullptr) {
+    for (auto c = pg_stmt->options->head; c != nullptr; c = lnext(c)) {
+      auto option = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(c->data.ptr_value);
+      if ((strcmp(option->defname, "format") != 0 && strcmp(option->defname, "encoding") != 0) ||
+          option->arg == nullptr) {
+        throw NotImplementedException(fmt::format("unsupported table option {}", option->defname));
+      }
+      // `format=pax` arrives as a type name, `format='pax'` as a string
+      std::string value;
+      if (option->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(option->arg);
+        value = reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str;
+      } else if (option->arg->type == duckdb_libpgquery::T_PGString) {
+        value = reinterpret_cast<duckdb_libpgquery::PGValue *>(option->arg)->val.str;
+      }
+      value = StringUtil::Lower(value);
+      if (strcmp(option->defname, "encoding") == 0) {
+        if (value == "dictionary") {
+          encoding = TableEncoding::DICTIONARY;
+        } else if (value != "plain") {
+          throw NotImplementedException(fmt::format("unsupported table encoding {}", value));
+        }
+      } else if (value == "pax") {
+        format = TableFormat::PAX;
+      } else if (value != "row") {
+        throw NotImplementedException(fmt::format("unsupported table format {}", value));
+      }
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), format, encoding);
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
@@ -129,7 +162,8 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols),
+                                          StringUtil::Lower(stmt->accessMethod));
 }
 
 }  // namespace bustub
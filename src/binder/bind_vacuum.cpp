@@ -0,0 +1,21 @@
+#include <memory>
+#include <optional>
+
+#include "binder/binder.h"
+#include "binder/statement/vacuum_statement.h"
+#include "binder/table_ref/bound_base_table_ref.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+auto Binder::BindVacuum(duckdb_libpgquery::PGVacuumStmt *stmt) -> std::unique_ptr<VacuumStatement> {
+  if ((stmt->options & duckdb_libpgquery::PG_VACOPT_ANALYZE) != 0) {
+    throw NotImplementedException("vacuum analyze is not supported");
+  }
+  if (stmt->relation == nullptr) {
+    return std::make_unique<VacuumStatement>(nullptr);
+  }
+  return std::make_unique<VacuumStatement>(BindBaseTableRef(stmt->relation->relname, std::nullopt));
+}
+
+}  // namespace bustub
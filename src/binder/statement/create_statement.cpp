@@ -5,11 +5,18 @@
 
 namespace bustub {
 
-CreateStatement::CreateStatement(std::string table, std::vector<Column> columns)
-    : BoundStatement(StatementType::CREATE_STATEMENT), table_(std::move(table)), columns_(std::move(columns)) {}
+CreateStatement::CreateStatement(std::string table, std::vector<Column> columns, TableFormat format,
+                                 TableEncoding encoding)
+    : BoundStatement(StatementType::CREATE_STATEMENT),
+      table_(std::move(table)),
+      columns_(std::move(columns)),
+      format_(format),
+      encoding_(encoding) {}
 
 auto CreateStatement::ToString() const -> std::string {
-  return fmt::format("BoundCreate {{\n  table={}\n  columns={}\n}}", table_, columns_);
+  return fmt::format("BoundCreate {{\n  table={}\n  columns={}\n  format={}\n  encoding={}\n}}", table_, columns_,
+                     format_ == TableFormat::PAX ? "pax" : "row",
+                     encoding_ == TableEncoding::DICTIONARY ? "dictionary" : "plain");
 }
 
 }  // namespace bustub
@@ -148,6 +148,12 @@ auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unus
   return is_success;
 }
 
+void BufferPoolManager::PrefetchPage(page_id_t page_id) {
+  if (FetchPage(page_id, AccessType::Scan) != nullptr) {
+    UnpinPage(page_id, false, AccessType::Scan);
+  }
+}
+
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
   bool is_success;
   latch_.lock();
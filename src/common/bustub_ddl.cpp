@@ -1,5 +1,5 @@
-// DDL (Data Definition Language) statement handling in BusTub, including create table, create index, and set/show
-// variable.
+// DDL (Data Definition Language) statement handling in BusTub, including create table, create index, set/show
+// variable, and vacuum.
 
 #include <optional>
 #include <shared_mutex>
@@ -14,6 +14,7 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "binder/statement/vacuum_statement.h"
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
@@ -42,7 +43,7 @@ namespace bustub {
 
 void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer) {
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_));
+  auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_), true, stmt.format_, stmt.encoding_);
   l.unlock();
 
   if (info == nullptr) {
@@ -71,10 +72,20 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
     throw NotImplementedException("only support creating index with exactly one or two columns");
   }
 
+  // Without `USING` the parser reports its own default access method, which we take as a B+ tree.
+  IndexType index_type;
+  if (stmt.index_type_ == "hash") {
+    index_type = IndexType::HashTableIndex;
+  } else if (stmt.index_type_ == "art" || stmt.index_type_ == "btree" || stmt.index_type_ == "bplustree") {
+    index_type = IndexType::BPlusTreeIndex;
+  } else {
+    throw NotImplementedException(fmt::format("unsupported index type {}", stmt.index_type_));
+  }
+
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
   auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
       txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+      IntegerHashFunctionType{}, index_type);
   l.unlock();
 
   if (info == nullptr) {
@@ -127,6 +138,10 @@ void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainState
 
 void BustubInstance::HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt,
                                                  ResultWriter &writer) {
+  if (stmt.variable_ == "index_stats") {
+    CmdDisplayIndexStats(writer);
+    return;
+  }
   auto content = GetSessionVariable(stmt.variable_);
   WriteOneCell(fmt::format("{}={}", stmt.variable_, content), writer);
 }
@@ -136,4 +151,46 @@ void BustubInstance::HandleVariableSetStatement(Transaction *txn, const Variable
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
+void BustubInstance::HandleVacuumStatement(Transaction *txn, const VacuumStatement &stmt, ResultWriter &writer) {
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+  std::vector<TableInfo *> tables;
+  if (stmt.table_ != nullptr) {
+    auto *table_info = catalog_->GetTable(stmt.table_->oid_);
+    if (table_info->table_ == nullptr) {
+      throw NotImplementedException(fmt::format("cannot vacuum {}", table_info->name_));
+    }
+    tables.push_back(table_info);
+  } else {
+    for (const auto &table_name : catalog_->GetTableNames()) {
+      // Mock tables are registered without a heap
+      if (auto *table_info = catalog_->GetTable(table_name); table_info->table_ != nullptr) {
+        tables.push_back(table_info);
+      }
+    }
+  }
+  l.unlock();
+
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("table");
+  writer.WriteHeaderCell("compacted_pages");
+  writer.WriteHeaderCell("reclaimed_bytes");
+  writer.WriteHeaderCell("freed_pages");
+  writer.EndHeader();
+  for (auto *table_info : tables) {
+    // Vacuum frees pages, so it waits for every transaction that may still scan the table
+    if (!lock_manager_->LockTable(txn, LockManager::LockMode::EXCLUSIVE, table_info->oid_)) {
+      throw Exception(fmt::format("cannot lock table {} for vacuum", table_info->name_));
+    }
+    auto stats = table_info->table_->Vacuum();
+    writer.BeginRow();
+    writer.WriteCell(table_info->name_);
+    writer.WriteCell(fmt::format("{}", stats.num_compacted_pages_));
+    writer.WriteCell(fmt::format("{}", stats.num_reclaimed_bytes_));
+    writer.WriteCell(fmt::format("{}", stats.num_freed_pages_));
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 }  // namespace bustub
@@ -2,6 +2,7 @@
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -11,6 +12,7 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "binder/statement/vacuum_statement.h"
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
@@ -28,12 +30,14 @@
 #include "execution/plans/abstract_plan.h"
 #include "fmt/core.h"
 #include "fmt/format.h"
+#include "fmt/ranges.h"
 #include "optimizer/optimizer.h"
 #include "planner/planner.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -163,6 +167,76 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayIndexStats(ResultWriter &writer) {
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+  auto table_names = catalog_->GetTableNames();
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("index_name");
+  writer.WriteHeaderCell("height");
+  writer.WriteHeaderCell("internal_pages");
+  writer.WriteHeaderCell("leaf_pages");
+  writer.WriteHeaderCell("entries");
+  writer.WriteHeaderCell("leaf_fill");
+  writer.WriteHeaderCell("internal_fill");
+  writer.WriteHeaderCell("underfull_leaves");
+  writer.WriteHeaderCell("leaf_discontinuities");
+  writer.WriteHeaderCell("leaf_fill_histogram");
+  writer.EndHeader();
+  for (const auto &table_name : table_names) {
+    for (const auto *index_info : catalog_->GetTableIndexes(table_name)) {
+      auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info->index_.get());
+      if (tree == nullptr) {
+        continue;
+      }
+      auto stats = tree->CollectStats();
+      writer.BeginRow();
+      writer.WriteCell(index_info->name_);
+      writer.WriteCell(fmt::format("{}", stats.height_));
+      writer.WriteCell(fmt::format("{}", stats.num_internal_pages_));
+      writer.WriteCell(fmt::format("{}", stats.num_leaf_pages_));
+      writer.WriteCell(fmt::format("{}", stats.num_entries_));
+      writer.WriteCell(fmt::format("{:.2f}", stats.avg_leaf_fill_));
+      writer.WriteCell(fmt::format("{:.2f}", stats.avg_internal_fill_));
+      writer.WriteCell(fmt::format("{}", stats.num_underfull_leaves_));
+      writer.WriteCell(fmt::format("{}", stats.num_leaf_discontinuities_));
+      writer.WriteCell(fmt::format("{}", fmt::join(stats.leaf_fill_histogram_, " ")));
+      writer.EndRow();
+    }
+  }
+  writer.EndTable();
+}
+
+void BustubInstance::CmdReindex(const std::string &index_name, ResultWriter &writer) {
+  // planning reads the root and statistics of an index, keep it out while trees are swapped and freed
+  std::unique_lock<std::shared_mutex> l(catalog_lock_);
+  std::vector<std::string> rebuilt;
+  bool found = false;
+  for (const auto &table_name : catalog_->GetTableNames()) {
+    for (const auto *index_info : catalog_->GetTableIndexes(table_name)) {
+      if (!index_name.empty() && index_info->name_ != index_name) {
+        continue;
+      }
+      found = true;
+      auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info->index_.get());
+      // Without a name only the fragmented indexes are rebuilt, a named index is always rebuilt.
+      if (tree == nullptr || (index_name.empty() && !tree->NeedsRebuild())) {
+        continue;
+      }
+      tree->Rebuild();
+      rebuilt.push_back(index_info->name_);
+    }
+  }
+  if (!index_name.empty() && !found) {
+    throw Exception(fmt::format("index {} not found", index_name));
+  }
+  if (rebuilt.empty()) {
+    WriteOneCell("no index needs reindexing", writer);
+    return;
+  }
+  WriteOneCell(fmt::format("reindexed: {}", fmt::join(rebuilt, ", ")), writer);
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -176,6 +250,8 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\dis: show the structure and fill of all indices, same as `show index_stats`
+\reindex [index]: rebuild the given index, or every index that deletes have left sparse
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -216,6 +292,14 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\dis") {
+      CmdDisplayIndexStats(writer);
+      return true;
+    }
+    if (sql == "\\reindex" || StringUtil::StartsWith(sql, "\\reindex ")) {
+      CmdReindex(StringUtil::Strip(sql.substr(std::string("\\reindex").size()), ' '), writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -261,6 +345,11 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         HandleExplainStatement(txn, explain_stmt, writer);
         continue;
       }
+      case StatementType::VACUUM_STATEMENT: {
+        const auto &vacuum_stmt = dynamic_cast<const VacuumStatement &>(*statement);
+        HandleVacuumStatement(txn, vacuum_stmt, writer);
+        continue;
+      }
       case StatementType::DELETE_STATEMENT:
       case StatementType::UPDATE_STATEMENT:
         is_delete = true;
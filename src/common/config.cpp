@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <thread>  // NOLINT
+
 #include "common/config.h"
 
 namespace bustub {
@@ -20,4 +23,16 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<size_t> parallel_scan_workers(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8));
+
+std::atomic<size_t> pipeline_workers(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8));
+
+std::atomic<bool> pipeline_table_locks(false);
+
+std::atomic<size_t> hash_join_workers(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8));
+
+std::atomic<bool> enable_runtime_filters(true);
+
+std::atomic<size_t> query_memory_budget(256 << 20);
+
 }  // namespace bustub
@@ -25,11 +25,25 @@ namespace bustub {
 void TransactionManager::Commit(Transaction *txn) {
   txn->SetState(TransactionState::COMMITTED);
 
+  // The deletes of this transaction are complete, vacuum may now reclaim the tuples.
+  for (auto &write : *(txn->GetWriteSet())) {
+    if (write.wtype_ != WType::DELETE) {
+      continue;
+    }
+    TupleMeta meta = write.table_heap_->GetTupleMeta(write.rid_);
+    if (meta.is_deleted_ && meta.delete_txn_id_ == txn->GetTransactionId()) {
+      meta.delete_txn_id_ = INVALID_TXN_ID;
+      write.table_heap_->UpdateTupleMeta(meta, write.rid_);
+    }
+  }
+
   if (enable_logging) {
     LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
     auto lsn = log_manager_->AppendLogRecord(&log_record);
     txn->SetPrevLSN(lsn);
   }
+  // Hand the reserved insert pages back while the table locks still keep a vacuum from freeing them.
+  ReleaseInsertPages(txn);
   // Release all the locks.
   ReleaseLocks(txn);
 }
@@ -37,13 +51,22 @@ void TransactionManager::Commit(Transaction *txn) {
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
 
-  /* TODO: revert all the changes in write set */
-  for (auto write : *(txn->GetWriteSet())) {
+  // Undo newest first, a tuple updated several times ends up with its oldest version
+  auto write_set = txn->GetWriteSet();
+  for (auto it = write_set->rbegin(); it != write_set->rend(); ++it) {
+    auto &write = *it;
+    if (write.wtype_ == WType::UPDATE) {
+      write.table_heap_->UpdateTuple(write.old_tuple_, write.rid_);
+      continue;
+    }
     TupleMeta meta = write.table_heap_->GetTupleMeta(write.rid_);
     meta.is_deleted_ = !meta.is_deleted_;
+    meta.delete_txn_id_ = INVALID_TXN_ID;
     write.table_heap_->UpdateTupleMeta(meta, write.rid_);
   }
-  for (auto write : *(txn->GetIndexWriteSet())) {
+  auto index_write_set = txn->GetIndexWriteSet();
+  for (auto it = index_write_set->rbegin(); it != index_write_set->rend(); ++it) {
+    auto &write = *it;
     IndexInfo *index_info = write.catalog_->GetIndex(write.index_oid_);
     TableInfo *table_info = write.catalog_->GetTable(write.table_oid_);
     if (write.wtype_ == WType::DELETE) {
@@ -70,9 +93,17 @@ void TransactionManager::Abort(Transaction *txn) {
     txn->SetPrevLSN(lsn);
   }
 
+  ReleaseInsertPages(txn);
   ReleaseLocks(txn);
 }
 
+void TransactionManager::ReleaseInsertPages(Transaction *txn) {
+  for (auto [table_heap, page_id] : *txn->GetInsertPageSet()) {
+    table_heap->ReleaseInsertPage(page_id);
+  }
+  txn->GetInsertPageSet()->clear();
+}
+
 void TransactionManager::BlockAllTransactions() { UNIMPLEMENTED("block is not supported now!"); }
 
 void TransactionManager::ResumeTransactions() { UNIMPLEMENTED("resume is not supported now!"); }
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,7 +28,17 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // Start with a single bucket of local depth 0 that every key maps to
+  auto dir_guard = buffer_pool_manager_->NewPageGuarded(&directory_page_id_);
+  auto *dir_page = dir_guard.AsMut<HashTableDirectoryPage>();
+  dir_page->SetPageId(directory_page_id_);
+
+  page_id_t bucket_page_id;
+  auto bucket_guard = buffer_pool_manager_->NewPageGuarded(&bucket_page_id);
+  // An empty bucket is all zeroes, marking it dirty is enough to get it written out
+  bucket_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
 }
 
 /*****************************************************************************
@@ -46,22 +58,22 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
 }
 
 /*****************************************************************************
@@ -69,7 +81,19 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint8_t fingerprint = HASH_TABLE_BUCKET_TYPE::Fingerprint(Hash(key));
+  // The directory only changes under the exclusive table latch, so a shared one lets us read it unlatched
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  bool found;
+  {
+    auto bucket_guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+    found = bucket_guard.template As<HASH_TABLE_BUCKET_TYPE>()->GetValue(key, comparator_, result, fingerprint);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +101,84 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint8_t fingerprint = HASH_TABLE_BUCKET_TYPE::Fingerprint(Hash(key));
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  std::optional<bool> inserted;
+  {
+    auto bucket_guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
+    auto *bucket_page = bucket_guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+    if (!bucket_page->IsFull()) {
+      inserted = bucket_page->Insert(key, value, comparator_, fingerprint);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (inserted.has_value()) {
+    return *inserted;
+  }
+  // Only a full bucket needs the directory to change
+  return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint8_t fingerprint = HASH_TABLE_BUCKET_TYPE::Fingerprint(Hash(key));
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  bool inserted = false;
+  // Nobody else holds a bucket while we hold the exclusive table latch, so buckets are accessed unlatched here.
+  // Another thread may have split the bucket already, and all keys may land on the same side, so loop until it fits.
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    if (!bucket_page->IsFull()) {
+      inserted = bucket_page->Insert(key, value, comparator_, fingerprint);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+    std::vector<ValueType> values;
+    bucket_page->GetValue(key, comparator_, &values, fingerprint);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (std::find(values.begin(), values.end(), value) != values.end() ||
+        (local_depth == dir_page->GetGlobalDepth() && dir_page->Size() * 2 > DIRECTORY_ARRAY_SIZE)) {
+      // A duplicate pair, or the directory cannot grow any further
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+
+    page_id_t image_page_id;
+    auto *image_page =
+        reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&image_page_id)->GetData());
+    uint32_t high_bit = 1U << local_depth;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if (dir_page->GetBucketPageId(i) == bucket_page_id) {
+        dir_page->IncrLocalDepth(i);
+        if ((i & high_bit) != 0) {
+          dir_page->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && bucket_page->IsOccupied(i); i++) {
+      if (bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & high_bit) != 0) {
+        image_page->Insert(bucket_page->KeyAt(i), bucket_page->ValueAt(i), comparator_,
+                           bucket_page->FingerprintAt(i));
+        bucket_page->RemoveAt(i);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    dir_dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,14 +186,69 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint8_t fingerprint = HASH_TABLE_BUCKET_TYPE::Fingerprint(Hash(key));
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+  bool removed;
+  bool empty;
+  {
+    auto bucket_guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
+    auto *bucket_page = bucket_guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+    removed = bucket_page->Remove(key, value, comparator_, fingerprint);
+    empty = bucket_page->IsEmpty();
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  // The merged bucket may be empty as well when its image was, so keep folding until a condition fails
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
+    bool empty = bucket_page->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      break;
+    }
+
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if (dir_page->GetBucketPageId(i) == bucket_page_id || dir_page->GetBucketPageId(i) == image_page_id) {
+        dir_page->SetBucketPageId(i, image_page_id);
+        dir_page->DecrLocalDepth(i);
+      }
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+    dir_dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,21 +27,226 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateTable(std::min(num_buckets, HashTableHeaderPage::MAX_BLOCKS * BLOCK_ARRAY_SIZE));
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage * {
+  return reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->FetchPage(header_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE * {
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(buffer_pool_manager_->FetchPage(block_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::CreateTable(size_t num_slots) -> page_id_t {
+  page_id_t header_page_id;
+  auto *header_page =
+      reinterpret_cast<HashTableHeaderPage *>(buffer_pool_manager_->NewPage(&header_page_id)->GetData());
+  header_page->SetPageId(header_page_id);
+  size_t num_blocks = std::max<size_t>(1, (num_slots + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE);
+  for (size_t i = 0; i < num_blocks; i++) {
+    // Fresh pages are zeroed, which is an empty block
+    page_id_t block_page_id;
+    buffer_pool_manager_->NewPage(&block_page_id);
+    header_page->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteBlockPages(page_id_t header_page_id) {
+  HashTableHeaderPage *header_page = GetHeaderPage(header_page_id);
+  for (size_t i = 0; i < header_page->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(header_page->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::Probe(page_id_t header_page_id, const KeyType &key,
+                            const std::function<bool(HASH_TABLE_BLOCK_TYPE *, slot_offset_t, bool *)> &on_match)
+    -> std::optional<size_t> {
+  HashTableHeaderPage *header_page = GetHeaderPage(header_page_id);
+  size_t size = header_page->GetSize();
+  size_t home = hash_fn_.GetHash(key) % size;
+  std::optional<size_t> free_slot;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  HASH_TABLE_BLOCK_TYPE *block_page = nullptr;
+  bool block_dirty = false;
+  for (size_t i = 0; i < size; i++) {
+    size_t slot = (home + i) % size;
+    if (page_id_t slot_page_id = header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE); slot_page_id != block_page_id) {
+      if (block_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, block_dirty);
+      }
+      block_page_id = slot_page_id;
+      block_page = GetBlockPage(block_page_id);
+      block_dirty = false;
+    }
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (!block_page->IsOccupied(offset)) {
+      free_slot = slot;
+      break;
+    }
+    bool wrote = false;
+    bool stop = block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0 &&
+                on_match(block_page, offset, &wrote);
+    block_dirty = block_dirty || wrote;
+    if (stop) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(block_page_id, block_dirty);
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return free_slot;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ProbeGetValue(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result)
+    -> bool {
+  bool found = false;
+  Probe(header_page_id, key, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset, bool * /*wrote*/) {
+    result->push_back(block_page->ValueAt(offset));
+    found = true;
+    return false;
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ProbeInsert(page_id_t header_page_id, const KeyType &key, const ValueType &value)
+    -> std::optional<size_t> {
+  HashTableHeaderPage *header_page = GetHeaderPage(header_page_id);
+  size_t size = header_page->GetSize();
+  size_t home = hash_fn_.GetHash(key) % size;
+  std::optional<size_t> inserted_slot;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  HASH_TABLE_BLOCK_TYPE *block_page = nullptr;
+  for (size_t i = 0; i < size; i++) {
+    size_t slot = (home + i) % size;
+    if (page_id_t slot_page_id = header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE); slot_page_id != block_page_id) {
+      if (block_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, false);
+      }
+      block_page_id = slot_page_id;
+      block_page = GetBlockPage(block_page_id);
+    }
+    // Tombstones are not reused, a lookup may still be reading the pair that was there
+    slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+    if (!block_page->IsOccupied(offset) && block_page->Insert(offset, key, value)) {
+      inserted_slot = slot;
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(block_page_id, inserted_slot.has_value());
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return inserted_slot;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ProbeRemove(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool {
+  bool removed = false;
+  Probe(header_page_id, key, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset, bool *wrote) {
+    removed = block_page->ValueAt(offset) == value && block_page->Remove(offset);
+    *wrote = removed;
+    return removed;
+  });
+  return removed;
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  size_t first = result->size();
+  table_latch_.RLock();
+  bool drop_old_table = MigrateSome(MIGRATE_SLOTS_PER_OP);
+  bool resizing = old_header_page_id_ != INVALID_PAGE_ID;
+  // A pair only ever moves from the old table to the new one, so checking them in this order cannot miss it
+  if (resizing) {
+    ProbeGetValue(old_header_page_id_, key, result);
+  }
+  ProbeGetValue(header_page_id_, key, result);
+  table_latch_.RUnlock();
+  if (drop_old_table) {
+    DropOldTable();
+  }
+
+  if (resizing) {
+    // A pair moved while we were looking is seen in both tables
+    auto last = result->begin() + first;
+    for (auto it = result->begin() + first; it != result->end(); ++it) {
+      if (std::find(result->begin() + first, last, *it) == last) {
+        *last++ = *it;
+      }
+    }
+    result->erase(last, result->end());
+  }
+  return result->size() > first;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  auto has_pair = [&](page_id_t header_page_id) {
+    bool found = false;
+    Probe(header_page_id, key, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset, bool * /*wrote*/) {
+      found = block_page->ValueAt(offset) == value;
+      return found;
+    });
+    return found;
+  };
+
+  table_latch_.RLock();
+  bool drop_old_table = MigrateSome(MIGRATE_SLOTS_PER_OP);
+  // Two inserts of the same pair could both miss it and put it in two slots, so the check and the insert of a key
+  // happen under its stripe. The stripe is taken inside the table latch and nothing is waited for while holding it.
+  std::unique_lock<std::mutex> insert_lock(insert_latches_[hash_fn_.GetHash(key) % INSERT_LATCH_STRIPES]);
+  if ((old_header_page_id_ != INVALID_PAGE_ID && has_pair(old_header_page_id_)) || has_pair(header_page_id_)) {
+    insert_lock.unlock();
+    table_latch_.RUnlock();
+    if (drop_old_table) {
+      DropOldTable();
+    }
+    return false;
+  }
+  auto slot = ProbeInsert(header_page_id_, key, value);
+  insert_lock.unlock();
+  HashTableHeaderPage *header_page = GetHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  bool grow = slot.has_value() && (num_occupied_.fetch_add(1) + 1) * 2 > size;
+  table_latch_.RUnlock();
+  if (drop_old_table) {
+    DropOldTable();
+  }
+
+  if (slot.has_value()) {
+    if (grow) {
+      Resize(size);
+    }
+    return true;
+  }
+  // The table is full, which only happens when it cannot grow any further
+  Resize(size);
+  if (GetSize() == size) {
+    return false;
+  }
+  return Insert(transaction, key, value);
 }
 
 /*****************************************************************************
@@ -48,21 +254,143 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  table_latch_.RLock();
+  bool drop_old_table = MigrateSome(MIGRATE_SLOTS_PER_OP);
+  // A pair the old table no longer has is either gone or already moved to the new table
+  bool removed = (old_header_page_id_ != INVALID_PAGE_ID && ProbeRemove(old_header_page_id_, key, value)) ||
+                 ProbeRemove(header_page_id_, key, value);
+  table_latch_.RUnlock();
+  if (drop_old_table) {
+    DropOldTable();
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  size_t num_blocks = std::min((2 * initial_size + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE,
+                               HashTableHeaderPage::MAX_BLOCKS);
+  table_latch_.WLock();
+  HashTableHeaderPage *header_page = GetHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  // Another thread may have grown the table already
+  if (num_blocks * BLOCK_ARRAY_SIZE > size) {
+    // Entries are only ever moved out of one table at a time
+    FinishMigrationLatched();
+    if (old_header_page_id_ == INVALID_PAGE_ID) {
+      old_header_page_id_ = header_page_id_;
+      header_page_id_ = CreateTable(num_blocks * BLOCK_ARRAY_SIZE);
+      migrate_cursor_ = 0;
+      num_occupied_ = 0;
+    }
+  }
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::MigrateSome(size_t num_slots) -> bool {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  std::unique_lock<std::mutex> migrate_lock(migrate_latch_, std::try_to_lock);
+  if (!migrate_lock.owns_lock()) {
+    return false;
+  }
+
+  HashTableHeaderPage *old_header_page = GetHeaderPage(old_header_page_id_);
+  size_t old_size = old_header_page->GetSize();
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  HASH_TABLE_BLOCK_TYPE *block_page = nullptr;
+  bool block_dirty = false;
+  for (size_t i = 0; i < num_slots && migrate_cursor_ < old_size; i++) {
+    if (page_id_t slot_page_id = old_header_page->GetBlockPageId(migrate_cursor_ / BLOCK_ARRAY_SIZE);
+        slot_page_id != block_page_id) {
+      if (block_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, block_dirty);
+      }
+      block_page_id = slot_page_id;
+      block_page = GetBlockPage(block_page_id);
+      block_dirty = false;
+    }
+    slot_offset_t offset = migrate_cursor_ % BLOCK_ARRAY_SIZE;
+    if (block_page->IsReadable(offset)) {
+      // Copy first and only then take the pair out of the old table, so that it is always in at least one of them
+      auto new_slot = ProbeInsert(header_page_id_, block_page->KeyAt(offset), block_page->ValueAt(offset));
+      if (!new_slot.has_value()) {
+        break;
+      }
+      num_occupied_++;
+      block_dirty = true;
+      if (!block_page->Remove(offset)) {
+        // A remove took the pair out of the old table meanwhile, so the copy has to go as well
+        HashTableHeaderPage *header_page = GetHeaderPage(header_page_id_);
+        page_id_t new_block_page_id = header_page->GetBlockPageId(*new_slot / BLOCK_ARRAY_SIZE);
+        GetBlockPage(new_block_page_id)->Remove(*new_slot % BLOCK_ARRAY_SIZE);
+        buffer_pool_manager_->UnpinPage(new_block_page_id, true);
+        buffer_pool_manager_->UnpinPage(header_page_id_, false);
+      }
+    }
+    migrate_cursor_++;
+  }
+  if (block_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(block_page_id, block_dirty);
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  return migrate_cursor_ >= old_size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DropOldTable() {
+  table_latch_.WLock();
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    HashTableHeaderPage *old_header_page = GetHeaderPage(old_header_page_id_);
+    size_t old_size = old_header_page->GetSize();
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    if (migrate_cursor_ >= old_size) {
+      DeleteBlockPages(old_header_page_id_);
+      old_header_page_id_ = INVALID_PAGE_ID;
+    }
+  }
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FinishMigrationLatched() {
+  while (old_header_page_id_ != INVALID_PAGE_ID) {
+    size_t cursor = migrate_cursor_;
+    if (MigrateSome(BLOCK_ARRAY_SIZE)) {
+      DeleteBlockPages(old_header_page_id_);
+      old_header_page_id_ = INVALID_PAGE_ID;
+    } else if (migrate_cursor_ == cursor) {
+      // The new table is full
+      return;
+    }
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  table_latch_.RLock();
+  HashTableHeaderPage *header_page = GetHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::IsResizing() -> bool {
+  table_latch_.RLock();
+  bool resizing = old_header_page_id_ != INVALID_PAGE_ID;
+  table_latch_.RUnlock();
+  return resizing;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
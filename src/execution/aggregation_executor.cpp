@@ -24,31 +24,48 @@ AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const Aggreg
 }
 
 void AggregationExecutor::Init() {
-  std::vector<AbstractExpressionRef> aggregates = plan_->GetAggregates();
-  std::vector<AbstractExpressionRef> group_bys = plan_->GetGroupBys();
-  std::vector<AggregationType> arr_types = plan_->GetAggregateTypes();
-  Tuple produce_tuple;
-  RID produce_rid;
+  child_->Init();
+  BeginInput();
+  TupleBatch batch;
+  while (child_->NextBatch(&batch)) {
+    Consume(batch);
+  }
+  FinishInput();
+}
+
+void AggregationExecutor::BeginInput() { aht_.Clear(); }
+
+void AggregationExecutor::Consume(const TupleBatch &batch) {
+  const auto &child_schema = plan_->GetChildPlan()->OutputSchema();
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  // The group-by and aggregate expressions are evaluated a column at a time, the table is updated row by row
+  std::vector<std::vector<Value>> group_by_columns(group_bys.size());
+  std::vector<std::vector<Value>> aggregate_columns(aggregates.size());
+  for (uint32_t i = 0; i < group_bys.size(); i++) {
+    group_by_columns[i] = group_bys[i]->EvaluateBatch(batch, child_schema);
+  }
+  for (uint32_t i = 0; i < aggregates.size(); i++) {
+    aggregate_columns[i] = aggregates[i]->EvaluateBatch(batch, child_schema);
+  }
   AggregateKey key;
   AggregateValue val;
-  aht_.Clear();
-  child_->Init();
-  while (child_->Next(&produce_tuple, &produce_rid)) {
-    for (auto &it : group_bys) {
-      key.group_bys_.push_back(it->Evaluate(&produce_tuple, child_->GetOutputSchema()));
+  for (size_t row = 0; row < batch.Size(); row++) {
+    for (auto &column : group_by_columns) {
+      key.group_bys_.push_back(std::move(column[row]));
     }
-    for (auto &it : aggregates) {
-      val.aggregates_.push_back(it->Evaluate(&produce_tuple, child_->GetOutputSchema()));
+    for (auto &column : aggregate_columns) {
+      val.aggregates_.push_back(std::move(column[row]));
     }
     aht_.InsertCombine(key, val);
     key.group_bys_.clear();
     val.aggregates_.clear();
   }
-  if (aht_.Begin() == aht_.End() && group_bys.empty()) {
-    key.group_bys_.clear();
-    val.aggregates_.clear();
-    val = aht_.GenerateInitialAggregateValue();
-    aht_.Insert(key, val);
+}
+
+void AggregationExecutor::FinishInput() {
+  if (aht_.Begin() == aht_.End() && plan_->GetGroupBys().empty()) {
+    aht_.Insert(AggregateKey{}, aht_.GenerateInitialAggregateValue());
   }
   aht_iterator_ = aht_.Begin();
 }
@@ -72,5 +89,19 @@ auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   return false;
 }
 
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(GetOutputSchema());
+  for (; aht_iterator_ != aht_.End() && !batch->IsFull(); ++aht_iterator_) {
+    const auto &key = aht_iterator_.Key();
+    const auto &value = aht_iterator_.Val();
+    std::vector<Value> values;
+    values.reserve(key.group_bys_.size() + value.aggregates_.size());
+    values.insert(values.end(), key.group_bys_.begin(), key.group_bys_.end());
+    values.insert(values.end(), value.aggregates_.begin(), value.aggregates_.end());
+    batch->Append(std::move(values), RID{});
+  }
+  return !batch->IsEmpty();
+}
+
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 }  // namespace bustub
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "execution/executors/delete_executor.h"
 
@@ -31,22 +33,25 @@ void DeleteExecutor::Init() {
 }
 
 auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
-  Tuple produce_tuple;
-  RID produce_rid;
+  Tuple child_tuple;
+  RID child_rid;
   int count = 0;
-  while (true) {
-    if (child_executor_ == nullptr) {
-      return false;
-    }
-    bool status = child_executor_->Next(&produce_tuple, &produce_rid);
-    if (!status) {
-      break;
-    }
+  if (child_executor_ == nullptr) {
+    return false;
+  }
+  // Drain the child first, an index scan below must not walk leaves this delete is shrinking
+  std::vector<std::pair<Tuple, RID>> targets;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    targets.emplace_back(child_tuple, child_rid);
+  }
+  for (auto &[produce_tuple, produce_rid] : targets) {
     TupleMeta tuple_meta = table_info_->table_->GetTupleMeta(produce_rid);
     tuple_meta.is_deleted_ = true;
+    // The tuple must survive vacuum until the delete commits, an abort brings it back
+    tuple_meta.delete_txn_id_ = exec_ctx_->GetTransaction()->GetTransactionId();
     table_info_->table_->UpdateTupleMeta(tuple_meta, produce_rid);
     exec_ctx_->GetTransaction()->AppendTableWriteRecord(
-        TableWriteRecord(table_id_, produce_rid, table_info_->table_.get()));
+        TableWriteRecord(table_id_, produce_rid, table_info_->table_.get(), WType::DELETE));
     count++;
     for (auto &index_info : index_list_) {
       if (index_info != nullptr) {
@@ -27,6 +27,7 @@
 #include "execution/executors/mock_scan_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
 #include "execution/executors/projection_executor.h"
 #include "execution/executors/seq_scan_executor.h"
 #include "execution/executors/sort_executor.h"
@@ -50,7 +51,11 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
   switch (plan->GetType()) {
     // Create a new sequential scan executor
     case PlanType::SeqScan: {
-      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan.get()));
+      auto seq_scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan.get());
+      if (ParallelSeqScanExecutor::CanRun(exec_ctx, seq_scan_plan)) {
+        return std::make_unique<ParallelSeqScanExecutor>(exec_ctx, seq_scan_plan);
+      }
+      return std::make_unique<SeqScanExecutor>(exec_ctx, seq_scan_plan);
     }
 
     // Create a new index scan executor
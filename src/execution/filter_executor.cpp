@@ -31,4 +31,15 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  // A batch the predicate drops every row of is not handed up, the parent would take it for the end
+  while (child_executor_->NextBatch(batch)) {
+    batch->Select(plan_->GetPredicate()->EvaluateBatch(*batch, child_executor_->GetOutputSchema()));
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
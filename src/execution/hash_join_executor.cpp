@@ -11,6 +11,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/hash_join_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -26,90 +32,342 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
   plan_ = plan;
   left_child_ = std::move(left_child);
   right_child_ = std::move(right_child);
+  if (plan_->GetLeftPlan()->GetType() == PlanType::SeqScan) {
+    filter_target_ = dynamic_cast<RuntimeFilterTarget *>(left_child_.get());
+  }
 }
 
+HashJoinExecutor::~HashJoinExecutor() { ReleaseTable(); }
+
 void HashJoinExecutor::Init() {
-  std::vector<AbstractExpressionRef> left_expr = plan_->left_key_expressions_;
-  std::vector<AbstractExpressionRef> right_expr = plan_->right_key_expressions_;
-  uint32_t right_count = plan_->GetRightPlan()->OutputSchema().GetColumnCount();
-  uint32_t left_count = plan_->GetLeftPlan()->OutputSchema().GetColumnCount();
   left_child_->Init();
   right_child_->Init();
-  Tuple produce_tuple;
-  RID produce_rid;
-  HashJoinKey key;
-  HashJoinValue value;
-  while (right_child_->Next(&produce_tuple, &produce_rid)) {
-    for (auto &it : right_expr) {
-      key.keys_.emplace_back(it->Evaluate(&produce_tuple, plan_->GetRightPlan()->OutputSchema()));
-    }
-    if (ht_.find(key) == ht_.end()) {
-      ht_[key] = std::vector<Tuple>{produce_tuple};
-    } else {
-      ht_[key].push_back(produce_tuple);
-    }
-    key.keys_.clear();
-  }
-  if (plan_->GetJoinType() == JoinType::LEFT) {
-    while (left_child_->Next(&produce_tuple, &produce_rid)) {
-      key.keys_.clear();
-      for (auto &it : left_expr) {
-        key.keys_.emplace_back(it->Evaluate(&produce_tuple, plan_->GetLeftPlan()->OutputSchema()));
+
+  // Only the right side is read here, the left side is probed as the joined rows are asked for
+  TupleBatch batch;
+  BeginInput();
+  while (right_child_->NextBatch(&batch)) {
+    Consume(batch);
+  }
+  FinishInput();
+  left_batch_.Reset(plan_->GetLeftPlan()->OutputSchema());
+  left_heads_.clear();
+  left_row_ = 0;
+  left_done_ = false;
+  match_table_ = nullptr;
+  match_row_ = JoinHashTable::NO_ROW;
+}
+
+void HashJoinExecutor::BeginInput() {
+  ReleaseTable();
+  // Left rows without a match are only dropped by an inner join
+  runtime_filter_ = nullptr;
+  if (filter_target_ != nullptr && plan_->GetJoinType() == JoinType::INNER && enable_runtime_filters.load()) {
+    runtime_filter_ = std::make_shared<RuntimeFilter>(plan_->left_key_expressions_);
+  }
+  tables_.assign(SPILL_PARTITIONS, JoinHashTable(plan_->right_key_expressions_.size()));
+  right_spills_.clear();
+  right_spills_.resize(SPILL_PARTITIONS);
+  left_spills_.clear();
+  left_spills_.resize(SPILL_PARTITIONS);
+  num_spilled_ = 0;
+  probing_spilled_ = false;
+  spill_partition_ = 0;
+  partition_loaded_ = false;
+}
+
+void HashJoinExecutor::Consume(const TupleBatch &batch) {
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  auto keys = EvaluateKeys(plan_->right_key_expressions_, batch, right_schema);
+  for (size_t row = 0; row < batch.Size(); row++) {
+    // A right row with a null key matches nothing, and is not returned by an inner or left join
+    if (!JoinHashTable::HasNullKey(keys, row)) {
+      Insert(&keys, row, batch.GetTuple(row, right_schema));
+    }
+  }
+}
+
+void HashJoinExecutor::FinishInput() {
+  // The partitions share nothing, so their directories are built by as many threads as there are workers
+  std::atomic<size_t> next_partition{0};
+  auto work = [&]() {
+    for (size_t i = next_partition++; i < SPILL_PARTITIONS; i = next_partition++) {
+      if (right_spills_[i] == nullptr) {
+        tables_[i].Build();
       }
-      if (ht_.find(key) == ht_.end()) {
-        // left join return null
-        std::vector<Value> values;
-        for (uint32_t i = 0; i < left_count; i++) {
-          values.push_back(produce_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), i));
-        }
-        for (uint32_t i = 0; i < right_count; i++) {
-          values.push_back(
-              ValueFactory::GetNullValueByType(plan_->GetRightPlan()->OutputSchema().GetColumn(i).GetType()));
-        }
-        output_.emplace_back(values, &GetOutputSchema());
-      } else {
-        for (auto &it : ht_[key]) {
-          std::vector<Value> values;
-          for (uint32_t j = 0; j < left_count; j++) {
-            values.push_back(produce_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), j));
-          }
-          for (uint32_t j = 0; j < right_count; j++) {
-            values.push_back(it.GetValue(&plan_->GetRightPlan()->OutputSchema(), j));
-          }
-          output_.emplace_back(values, &GetOutputSchema());
+    }
+  };
+  size_t rows = 0;
+  for (const auto &table : tables_) {
+    rows += table.GetNumRows();
+  }
+  auto num_workers = rows < PARALLEL_BUILD_ROWS ? 1 : std::min(hash_join_workers.load(), SPILL_PARTITIONS);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_workers; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (runtime_filter_ != nullptr) {
+    runtime_filter_->Build();
+    filter_target_->AddRuntimeFilter(std::move(runtime_filter_));
+  }
+}
+
+void HashJoinExecutor::Insert(std::vector<std::vector<Value>> *keys, size_t row, const Tuple &tuple) {
+  auto hash = JoinHashTable::HashKey(*keys, row);
+  // The keys of spilled rows go into the filter too, their left rows are joined later
+  if (runtime_filter_ != nullptr) {
+    runtime_filter_->AddKey(hash, *keys, row);
+  }
+  auto partition = PartitionOf(hash);
+  auto bytes = tables_[partition].RowBytes(tuple.GetLength());
+  // Room is made by spilling the largest partition held in memory, which may be the one of this tuple
+  while (right_spills_[partition] == nullptr && !exec_ctx_->ReserveMemory(bytes)) {
+    size_t largest = partition;
+    for (size_t i = 0; i < SPILL_PARTITIONS; i++) {
+      if (right_spills_[i] == nullptr && partition_bytes_[i] > partition_bytes_[largest]) {
+        largest = i;
+      }
+    }
+    SpillPartition(largest);
+  }
+  if (right_spills_[partition] != nullptr) {
+    right_spills_[partition]->Append(tuple);
+    return;
+  }
+  reserved_bytes_ += bytes;
+  partition_bytes_[partition] += bytes;
+  tables_[partition].Append(hash, keys, row, tuple);
+}
+
+void HashJoinExecutor::SpillPartition(size_t partition) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  right_spills_[partition] = std::make_unique<TmpTupleFile>(bpm);
+  left_spills_[partition] = std::make_unique<TmpTupleFile>(bpm);
+  num_spilled_++;
+  auto &table = tables_[partition];
+  for (uint32_t row = 0; row < table.GetNumRows(); row++) {
+    right_spills_[partition]->Append(table.GetTuple(row).Materialize());
+  }
+  table.Clear();
+  exec_ctx_->ReleaseMemory(partition_bytes_[partition]);
+  reserved_bytes_ -= partition_bytes_[partition];
+  partition_bytes_[partition] = 0;
+}
+
+void HashJoinExecutor::ReleaseTable() {
+  for (auto &table : tables_) {
+    table.Clear();
+  }
+  exec_ctx_->ReleaseMemory(reserved_bytes_);
+  reserved_bytes_ = 0;
+  partition_bytes_.fill(0);
+}
+
+auto HashJoinExecutor::SpillLeftRow(hash_t hash, const TupleBatch &batch, size_t row) -> bool {
+  if (num_spilled_ == 0 || probing_spilled_) {
+    return false;
+  }
+  auto &spill = left_spills_[PartitionOf(hash)];
+  if (spill == nullptr) {
+    return false;
+  }
+  spill->Append(batch.GetTuple(row, plan_->GetLeftPlan()->OutputSchema()));
+  return true;
+}
+
+auto HashJoinExecutor::NextSpilledLeftBatch(TupleBatch *batch) -> bool {
+  if (!probing_spilled_) {
+    // The partitions held in memory are done with, their memory goes to the spilled ones
+    probing_spilled_ = true;
+    ReleaseTable();
+  }
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  for (; spill_partition_ < SPILL_PARTITIONS; spill_partition_++) {
+    if (left_spills_[spill_partition_] == nullptr) {
+      continue;
+    }
+    auto &table = tables_[spill_partition_];
+    if (!partition_loaded_) {
+      TmpTupleFile::Cursor cursor;
+      TupleBatch right;
+      while (ReadSpilled(right_spills_[spill_partition_].get(), &cursor, right_schema, &right)) {
+        auto keys = EvaluateKeys(plan_->right_key_expressions_, right, right_schema);
+        for (size_t row = 0; row < right.Size(); row++) {
+          table.Append(JoinHashTable::HashKey(keys, row), &keys, row, right.GetTuple(row, right_schema));
         }
       }
+      table.Build();
+      partition_loaded_ = true;
+      left_cursor_ = TmpTupleFile::Cursor{};
+    }
+    if (ReadSpilled(left_spills_[spill_partition_].get(), &left_cursor_, plan_->GetLeftPlan()->OutputSchema(),
+                    batch)) {
+      return true;
+    }
+    table.Clear();
+    partition_loaded_ = false;
+  }
+  return false;
+}
+
+auto HashJoinExecutor::ReadSpilled(TmpTupleFile *file, TmpTupleFile::Cursor *cursor, const Schema &schema,
+                                   TupleBatch *batch) -> bool {
+  batch->Reset(schema);
+  Tuple tuple;
+  while (!batch->IsFull() && file->Next(cursor, &tuple)) {
+    batch->Append(tuple, schema, RID{});
+  }
+  return !batch->IsEmpty();
+}
+
+void HashJoinExecutor::LookupBatch(const TupleBatch &batch, std::vector<size_t> *partitions,
+                                   std::vector<uint32_t> *heads) {
+  auto keys = EvaluateKeys(plan_->left_key_expressions_, batch, plan_->GetLeftPlan()->OutputSchema());
+  std::vector<hash_t> hashes(batch.Size());
+  for (size_t row = 0; row < batch.Size(); row++) {
+    hashes[row] = JoinHashTable::HashKey(keys, row);
+  }
+  partitions->resize(batch.Size());
+  heads->resize(batch.Size());
+  for (size_t row = 0; row < batch.Size(); row++) {
+    (*partitions)[row] = PartitionOf(hashes[row]);
+    if (row + JoinHashTable::PREFETCH_DISTANCE < batch.Size()) {
+      auto ahead = hashes[row + JoinHashTable::PREFETCH_DISTANCE];
+      tables_[PartitionOf(ahead)].Prefetch(ahead);
     }
-  } else if (plan_->GetJoinType() == JoinType::INNER) {
-    while (left_child_->Next(&produce_tuple, &produce_rid)) {
-      key.keys_.clear();
-      for (auto &it : left_expr) {
-        key.keys_.emplace_back(it->Evaluate(&produce_tuple, plan_->GetLeftPlan()->OutputSchema()));
+    if (SpillLeftRow(hashes[row], batch, row)) {
+      (*heads)[row] = SPILLED_ROW;
+      continue;
+    }
+    (*heads)[row] = tables_[(*partitions)[row]].Find(hashes[row], keys, row);
+  }
+}
+
+void HashJoinExecutor::Probe(const TupleBatch &batch, const std::function<void(TupleBatch *)> &emit) {
+  std::vector<size_t> partitions;
+  std::vector<uint32_t> heads;
+  LookupBatch(batch, &partitions, &heads);
+  TupleBatch joined;
+  joined.Reset(GetOutputSchema());
+  auto append = [&](size_t row, const TupleView *right_tuple) {
+    AppendJoined(&joined, batch, row, right_tuple);
+    if (joined.IsFull()) {
+      emit(&joined);
+      joined.Reset(GetOutputSchema());
+    }
+  };
+  for (size_t row = 0; row < batch.Size(); row++) {
+    if (heads[row] == SPILLED_ROW) {
+      continue;
+    }
+    if (heads[row] != JoinHashTable::NO_ROW) {
+      const auto &table = tables_[partitions[row]];
+      for (auto match = heads[row]; match != JoinHashTable::NO_ROW; match = table.NextMatch(match)) {
+        auto right_tuple = table.GetTuple(match);
+        append(row, &right_tuple);
       }
-      if (ht_.find(key) != ht_.end()) {
-        for (const auto &tuple : ht_[key]) {
-          std::vector<Value> values;
-          for (uint32_t j = 0; j < left_count; j++) {
-            values.push_back(produce_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), j));
-          }
-          for (uint32_t j = 0; j < right_count; j++) {
-            values.push_back(tuple.GetValue(&plan_->GetRightPlan()->OutputSchema(), j));
-          }
-          output_.emplace_back(values, &GetOutputSchema());
-        }
+    } else if (plan_->GetJoinType() == JoinType::LEFT) {
+      // left join return null
+      append(row, nullptr);
+    }
+  }
+  if (!joined.IsEmpty()) {
+    emit(&joined);
+  }
+}
+void HashJoinExecutor::FinishProbe(const std::function<void(TupleBatch *)> &emit) {
+  TupleBatch batch;
+  while (NextSpilledLeftBatch(&batch)) {
+    Probe(batch, emit);
+  }
+}
+
+auto HashJoinExecutor::EvaluateKeys(const std::vector<AbstractExpressionRef> &exprs, const TupleBatch &batch,
+                                    const Schema &schema) -> std::vector<std::vector<Value>> {
+  std::vector<std::vector<Value>> keys;
+  keys.reserve(exprs.size());
+  for (const auto &expr : exprs) {
+    keys.push_back(expr->EvaluateBatch(batch, schema));
+  }
+  return keys;
+}
+
+auto HashJoinExecutor::JoinValues(const TupleBatch &left, size_t row, const TupleView *right_tuple) const
+    -> std::vector<Value> {
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  for (uint32_t i = 0; i < left.GetColumnCount(); i++) {
+    values.push_back(left.GetColumn(i)[row]);
+  }
+  for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+    values.push_back(right_tuple != nullptr ? right_tuple->CopyValue(&right_schema, i)
+                                            : ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType()));
+  }
+  return values;
+}
+
+void HashJoinExecutor::AppendJoined(TupleBatch *joined, const TupleBatch &left, size_t row,
+                                    const TupleView *right_tuple) const {
+  joined->Append(JoinValues(left, row, right_tuple), RID{});
+}
+
+template <typename Emit>
+auto HashJoinExecutor::ProbeRows(size_t limit, Emit &&emit) -> size_t {
+  size_t emitted = 0;
+  while (emitted < limit) {
+    if (match_row_ != JoinHashTable::NO_ROW) {
+      auto right_tuple = match_table_->GetTuple(match_row_);
+      match_row_ = match_table_->NextMatch(match_row_);
+      emit(left_batch_, left_row_ - 1, &right_tuple);
+      emitted++;
+      continue;
+    }
+    if (left_done_) {
+      break;
+    }
+    if (left_row_ == left_batch_.Size()) {
+      // The left batch is emptied when the child runs out, so that is remembered rather than checked again
+      bool pulled = !probing_spilled_ && left_child_->NextBatch(&left_batch_);
+      if (!pulled && !NextSpilledLeftBatch(&left_batch_)) {
+        left_done_ = true;
+        break;
       }
+      LookupBatch(left_batch_, &left_partitions_, &left_heads_);
+      left_row_ = 0;
+      continue;
+    }
+    auto head = left_heads_[left_row_++];
+    if (head == SPILLED_ROW) {
+      continue;
+    }
+    if (head != JoinHashTable::NO_ROW) {
+      match_table_ = &tables_[left_partitions_[left_row_ - 1]];
+      match_row_ = head;
+    } else if (plan_->GetJoinType() == JoinType::LEFT) {
+      // left join return null
+      emit(left_batch_, left_row_ - 1, nullptr);
+      emitted++;
     }
   }
-  iterator_ = output_.begin();
+  return emitted;
 }
 
 auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (iterator_ == output_.end()) {
-    return false;
-  }
-  *tuple = *iterator_;
-  iterator_++;
-  return true;
+  return ProbeRows(1, [&](const TupleBatch &left, size_t row, const TupleView *right_tuple) {
+           *tuple = Tuple(JoinValues(left, row, right_tuple), &GetOutputSchema());
+         }) == 1;
+}
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(GetOutputSchema());
+  return ProbeRows(TupleBatch::CAPACITY, [&](const TupleBatch &left, size_t row, const TupleView *right_tuple) {
+           AppendJoined(batch, left, row, right_tuple);
+         }) > 0;
 }
 
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
+#include "type/type.h"
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
@@ -21,28 +22,92 @@ void IndexScanExecutor::Init() {
   index_oid_t index_id = plan_->GetIndexOid();
   index_info_ = exec_ctx_->GetCatalog()->GetIndex(index_id);
   table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
+  read_guard_ = TableReadGuard(table_info_->table_.get());
+  if (index_info_->index_type_ == IndexType::HashTableIndex) {
+    // The optimizer only hands a hash index lookups of the full key, so both bounds hold that key
+    const auto &key = plan_->GetLowerBound();
+    BUSTUB_ENSURE(key.has_value() && key->key_.size() == index_info_->key_schema_.GetColumnCount(),
+                  "hash index scan without a full key");
+    rids_.clear();
+    cursor_ = 0;
+    index_info_->index_->ScanKey(Tuple(key->key_, &index_info_->key_schema_), &rids_, exec_ctx_->GetTransaction());
+    return;
+  }
   tree_ = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get());
-  iterator_ = new IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>(tree_->GetBeginIterator());
+  all_visible_pages_.clear();
+  const auto &lower = plan_->GetLowerBound();
+  const auto &upper = plan_->GetUpperBound();
+  iterator_ = std::make_unique<BPlusTreeIndexIteratorForTwoIntegerColumn>(tree_->GetRangeIterator(
+      MakeBoundKey(lower, true), lower == std::nullopt || lower->inclusive_, MakeBoundKey(upper, false),
+      upper == std::nullopt || upper->inclusive_, plan_->GetDirection() == IndexScanDirection::BACKWARD));
+}
+
+auto IndexScanExecutor::MakeBoundKey(const std::optional<IndexScanBound> &bound, bool is_lower) const
+    -> std::optional<IntegerKeyType> {
+  if (bound == std::nullopt) {
+    return std::nullopt;
+  }
+  // Pad so that the key sorts before every key sharing the prefix when the prefix itself is to be included from below
+  // or excluded from above, and after all of them otherwise
+  const auto &key_schema = index_info_->key_schema_;
+  bool pad_min = is_lower == bound->inclusive_;
+  std::vector<Value> values = bound->key_;
+  for (uint32_t i = values.size(); i < key_schema.GetColumnCount(); i++) {
+    auto type_id = key_schema.GetColumn(i).GetType();
+    values.push_back(pad_min ? Type::GetMinValue(type_id) : Type::GetMaxValue(type_id));
+  }
+  IntegerKeyType key;
+  key.SetFromKey(Tuple(values, &key_schema));
+  return key;
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  TupleMeta meta;
+  if (index_info_->index_type_ == IndexType::HashTableIndex) {
+    while (cursor_ < rids_.size()) {
+      *rid = rids_[cursor_++];
+      auto [meta, heap_tuple] = table_info_->table_->GetTuple(*rid);
+      if (!meta.is_deleted_) {
+        *tuple = std::move(heap_tuple);
+        return true;
+      }
+    }
+    return false;
+  }
   while (!iterator_->IsEnd()) {
-    *rid = iterator_->operator*().second;
-    meta = table_info_->table_->GetTupleMeta(*rid);
-    if (meta.is_deleted_) {
-      ++(*iterator_);
+    const auto &[key, value] = **iterator_;
+    *rid = value;
+    if (plan_->IsIndexOnly()) {
+      // The heap is only consulted for pages that may hold deleted tuples, which is looked up once per page
+      auto [visible, inserted] = all_visible_pages_.try_emplace(rid->GetPageId(), false);
+      if (inserted) {
+        visible->second = table_info_->table_->IsPageAllVisible(rid->GetPageId());
+      }
+      if (visible->second || !table_info_->table_->GetTupleMeta(*rid).is_deleted_) {
+        *tuple = KeyToTuple(key);
+        ++(*iterator_);
+        return true;
+      }
     } else {
-      break;
+      auto [meta, heap_tuple] = table_info_->table_->GetTuple(*rid);
+      if (!meta.is_deleted_) {
+        *tuple = std::move(heap_tuple);
+        ++(*iterator_);
+        return true;
+      }
     }
+    ++(*iterator_);
   }
-  if (iterator_->IsEnd()) {
-    delete iterator_;
-    return false;
+  return false;
+}
+
+auto IndexScanExecutor::KeyToTuple(const IntegerKeyType &key) const -> Tuple {
+  auto *key_schema = &index_info_->key_schema_;
+  std::vector<Value> values;
+  values.reserve(key_schema->GetColumnCount());
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    values.push_back(key.ToValue(key_schema, i));
   }
-  *tuple = table_info_->table_->GetTuple(*rid).second;
-  ++(*iterator_);
-  return true;
+  return {values, &GetOutputSchema()};
 }
 
 }  // namespace bustub
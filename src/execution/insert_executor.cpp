@@ -30,8 +30,11 @@ void InsertExecutor::Init() {
   if (!(exec_ctx_->GetTransaction()->IsTableIntentionExclusiveLocked(table_id_) ||
         exec_ctx_->GetTransaction()->IsTableExclusiveLocked(table_id_) ||
         exec_ctx_->GetTransaction()->IsTableSharedIntentionExclusiveLocked(table_id_))) {
-    if (!exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), LockManager::LockMode::INTENTION_EXCLUSIVE,
-                                                table_id_)) {
+    // A shared-locked table only upgrades to SIX, not to IX
+    auto mode = exec_ctx_->GetTransaction()->IsTableSharedLocked(table_id_)
+                    ? LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE
+                    : LockManager::LockMode::INTENTION_EXCLUSIVE;
+    if (!exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), mode, table_id_)) {
       throw ExecutionException("can not get lock");
     }
   }
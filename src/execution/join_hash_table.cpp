@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.cpp
+//
+// Identification: src/execution/join_hash_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/join_hash_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+/** Tuples start at multiples of this in the arena, so their fixed-size values are aligned */
+constexpr size_t ARENA_ALIGNMENT = 8;
+
+/** Spread the bits of a hash, HashUtil hashes of small integers differ in their low bits only */
+auto MixHash(hash_t hash) -> hash_t {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // namespace
+
+auto JoinHashTable::HashKey(const std::vector<std::vector<Value>> &keys, size_t row) -> hash_t {
+  hash_t hash = 0;
+  for (const auto &column : keys) {
+    if (!column[row].IsNull()) {
+      hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&column[row]));
+    }
+  }
+  return MixHash(hash);
+}
+
+auto JoinHashTable::HasNullKey(const std::vector<std::vector<Value>> &keys, size_t row) -> bool {
+  return std::any_of(keys.begin(), keys.end(),
+                     [row](const std::vector<Value> &column) { return column[row].IsNull(); });
+}
+
+void JoinHashTable::Append(hash_t hash, std::vector<std::vector<Value>> *keys, size_t row, const Tuple &tuple) {
+  BUSTUB_ASSERT(hashes_.size() < NO_ROW, "too many rows for a join hash table");
+  hashes_.push_back(hash);
+  next_.push_back(NO_ROW);
+  for (auto &column : *keys) {
+    keys_.push_back(std::move(column[row]));
+  }
+  // Rows start aligned, the padding before a row is part of no tuple
+  auto start = (arena_.size() + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  arena_.resize(start + tuple.GetLength());
+  memcpy(arena_.data() + start, tuple.GetData(), tuple.GetLength());
+  offsets_.push_back(start);
+  lengths_.push_back(tuple.GetLength());
+}
+
+void JoinHashTable::Build() {
+  size_t num_slots = 16;
+  while (num_slots < 2 * hashes_.size()) {
+    num_slots *= 2;
+  }
+  slots_.assign(num_slots, Slot{0, NO_ROW});
+  mask_ = num_slots - 1;
+  // Inserted back to front, each row going to the head of its chain, so chains keep the order rows were appended in
+  auto num_rows = static_cast<uint32_t>(hashes_.size());
+  for (uint32_t i = 0; i < num_rows; i++) {
+    uint32_t row = num_rows - 1 - i;
+    if (row >= PREFETCH_DISTANCE) {
+      Prefetch(hashes_[row - PREFETCH_DISTANCE]);
+    }
+    InsertIntoDirectory(row);
+  }
+}
+
+void JoinHashTable::InsertIntoDirectory(uint32_t row) {
+  auto hash = hashes_[row];
+  for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+    auto &slot = slots_[i];
+    if (slot.head_ == NO_ROW) {
+      slot.hash_ = hash;
+      slot.head_ = row;
+      next_[row] = NO_ROW;
+      return;
+    }
+    if (slot.hash_ == hash && RowKeysEqual(slot.head_, row)) {
+      next_[row] = slot.head_;
+      slot.head_ = row;
+      return;
+    }
+  }
+}
+
+void JoinHashTable::Clear() {
+  hashes_ = {};
+  next_ = {};
+  offsets_ = {};
+  lengths_ = {};
+  keys_ = {};
+  arena_ = {};
+  slots_ = {};
+  mask_ = 0;
+}
+
+auto JoinHashTable::Find(hash_t hash, const std::vector<std::vector<Value>> &keys, size_t row) const -> uint32_t {
+  if (slots_.empty()) {
+    return NO_ROW;
+  }
+  for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+    const auto &slot = slots_[i];
+    if (slot.head_ == NO_ROW) {
+      return NO_ROW;
+    }
+    if (slot.hash_ == hash && KeyEquals(slot.head_, keys, row)) {
+      return slot.head_;
+    }
+  }
+}
+
+void JoinHashTable::FindBatch(const std::vector<hash_t> &hashes, const std::vector<std::vector<Value>> &keys,
+                              std::vector<uint32_t> *heads) const {
+  heads->resize(hashes.size());
+  for (size_t row = 0; row < hashes.size(); row++) {
+    if (row + PREFETCH_DISTANCE < hashes.size()) {
+      Prefetch(hashes[row + PREFETCH_DISTANCE]);
+    }
+    (*heads)[row] = Find(hashes[row], keys, row);
+  }
+}
+
+auto JoinHashTable::RowKeysEqual(uint32_t left, uint32_t right) const -> bool {
+  for (size_t i = 0; i < num_keys_; i++) {
+    if (keys_[left * num_keys_ + i].CompareEquals(keys_[right * num_keys_ + i]) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto JoinHashTable::KeyEquals(uint32_t row, const std::vector<std::vector<Value>> &keys, size_t key_row) const
+    -> bool {
+  for (size_t i = 0; i < num_keys_; i++) {
+    if (keys_[row * num_keys_ + i].CompareEquals(keys[i][key_row]) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
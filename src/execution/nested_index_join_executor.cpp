@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/nested_index_join_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -21,10 +22,84 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
     // Note for 2023 Spring: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
+  plan_ = plan;
+  child_executor_ = std::move(child_executor);
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  inner_table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetInnerTableOid());
+  read_guard_ = TableReadGuard(inner_table_info_->table_.get());
+  output_.clear();
+  output_idx_ = 0;
+  child_exhausted_ = false;
+}
+
+void NestIndexJoinExecutor::ProbeNextBatch() {
+  output_.clear();
+  output_idx_ = 0;
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto &inner_schema = plan_->InnerTableSchema();
+
+  std::vector<Tuple> outer_tuples;
+  std::vector<Tuple> keys;
+  std::vector<bool> null_keys;
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples.size() < BATCH_SIZE && child_executor_->Next(&outer_tuple, &outer_rid)) {
+    Value key = plan_->KeyPredicate()->Evaluate(&outer_tuple, outer_schema);
+    keys.emplace_back(std::vector<Value>{key}, &index_info_->key_schema_);
+    null_keys.push_back(key.IsNull());
+    outer_tuples.push_back(outer_tuple);
+  }
+  if (outer_tuples.size() < BATCH_SIZE) {
+    child_exhausted_ = true;
+  }
+
+  std::vector<std::vector<RID>> inner_rids;
+  index_info_->index_->ScanKeys(keys, &inner_rids, exec_ctx_->GetTransaction());
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  for (size_t i = 0; i < outer_tuples.size(); i++) {
+    bool matched = false;
+    for (const auto &inner_rid : inner_rids[i]) {
+      auto [meta, inner_tuple] = inner_table_info_->table_->GetTuple(inner_rid);
+      // NULL never equals anything, even though the index comparator treats it as equal
+      if (null_keys[i] || meta.is_deleted_) {
+        continue;
+      }
+      std::vector<Value> values;
+      for (uint32_t j = 0; j < outer_schema.GetColumnCount(); j++) {
+        values.push_back(outer_tuples[i].GetValue(&outer_schema, j));
+      }
+      for (uint32_t j = 0; j < inner_schema.GetColumnCount(); j++) {
+        values.push_back(inner_tuple.GetValue(&inner_schema, j));
+      }
+      output_.emplace_back(values, &GetOutputSchema());
+      matched = true;
+    }
+    if (!matched && plan_->GetJoinType() == JoinType::LEFT) {
+      std::vector<Value> values;
+      for (uint32_t j = 0; j < outer_schema.GetColumnCount(); j++) {
+        values.push_back(outer_tuples[i].GetValue(&outer_schema, j));
+      }
+      for (uint32_t j = 0; j < inner_schema.GetColumnCount(); j++) {
+        values.push_back(ValueFactory::GetNullValueByType(inner_schema.GetColumn(j).GetType()));
+      }
+      output_.emplace_back(values, &GetOutputSchema());
+    }
+  }
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (output_idx_ == output_.size()) {
+    if (child_exhausted_) {
+      return false;
+    }
+    ProbeNextBatch();
+  }
+  *tuple = output_[output_idx_++];
+  return true;
+}
 
 }  // namespace bustub
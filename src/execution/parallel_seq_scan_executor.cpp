@@ -0,0 +1,257 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_seq_scan_executor.cpp
+//
+// Identification: src/execution/parallel_seq_scan_executor.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
+
+namespace bustub {
+
+ParallelSeqScanExecutor::ParallelSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+ParallelSeqScanExecutor::~ParallelSeqScanExecutor() { StopWorkers(); }
+
+auto ParallelSeqScanExecutor::CanRun(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) -> bool {
+  if (exec_ctx->IsDelete() || parallel_scan_workers.load() <= 1) {
+    return false;
+  }
+  auto *table_info = exec_ctx->GetCatalog()->GetTable(plan->GetTableOid());
+  return table_info != Catalog::NULL_TABLE_INFO && table_info->table_->GetNumPages() >= MIN_PAGES;
+}
+
+void ParallelSeqScanExecutor::Init() {
+  StopWorkers();
+
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = plan_->GetTableOid();
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(oid);
+  // The table is locked as a serial scan locks it, the rows are locked by Next() before the workers read them
+  if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+      !(txn->IsTableExclusiveLocked(oid) || txn->IsTableIntentionExclusiveLocked(oid) ||
+        txn->IsTableSharedIntentionExclusiveLocked(oid) || txn->IsTableSharedLocked(oid) ||
+        txn->IsTableIntentionSharedLocked(oid))) {
+    if (!exec_ctx_->GetLockManager()->LockTable(txn, LockManager::LockMode::INTENTION_SHARED, oid)) {
+      throw ExecutionException("can not get lock");
+    }
+  }
+  lock_rows_ = txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
+               !(txn->IsTableSharedLocked(oid) || txn->IsTableSharedIntentionExclusiveLocked(oid) ||
+                 txn->IsTableExclusiveLocked(oid));
+
+  columnar_ = table_info_->table_->GetFormat() == TableFormat::PAX;
+  filter_ = ScanFilter(plan_->filter_predicate_, table_info_->table_.get());
+
+  read_guard_ = TableReadGuard(table_info_->table_.get());
+  auto page_ids = table_info_->table_->GetPageIds();
+  morsels_.clear();
+  for (size_t i = 0; i < page_ids.size(); i += MORSEL_SIZE) {
+    auto stop = i + MORSEL_SIZE < page_ids.size() ? page_ids[i + MORSEL_SIZE] : INVALID_PAGE_ID;
+    morsels_.push_back({page_ids[i], stop, {}, {}});
+  }
+
+  batch_.clear();
+  batch_pos_ = 0;
+  results_.clear();
+  results_.resize(morsels_.size());
+  next_morsel_ = 0;
+  locked_morsel_ = lock_rows_ ? 0 : morsels_.size();
+  gather_morsel_ = 0;
+  stop_ = false;
+  error_ = nullptr;
+  runtime_filters_.clear();
+  num_workers_ = std::min(parallel_scan_workers.load(), morsels_.size());
+  for (size_t i = 0; i < num_workers_; i++) {
+    workers_.emplace_back([this] { RunWorker(); });
+  }
+}
+
+auto ParallelSeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (batch_pos_ == batch_.size()) {
+    LockMorsels();
+    std::unique_lock guard(latch_);
+    if (gather_morsel_ == morsels_.size()) {
+      return false;
+    }
+    cv_.wait(guard, [&] { return results_[gather_morsel_].has_value() || error_ != nullptr; });
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+    batch_ = std::move(*results_[gather_morsel_]);
+    results_[gather_morsel_].reset();
+    batch_pos_ = 0;
+    gather_morsel_++;
+    guard.unlock();
+    UnlockMorsel(morsels_[gather_morsel_ - 1], batch_);
+    // The window of morsels the workers may scan ahead has moved
+    cv_.notify_all();
+  }
+  *tuple = std::move(batch_[batch_pos_].first);
+  *rid = batch_[batch_pos_].second;
+  batch_pos_++;
+  return true;
+}
+
+void ParallelSeqScanExecutor::LockMorsels() {
+  // Only this thread moves locked_morsel_ and gather_morsel_, the latch publishes them to the workers
+  auto window = LOOKAHEAD * num_workers_;
+  while (locked_morsel_ < morsels_.size() && locked_morsel_ < gather_morsel_ + window) {
+    LockMorsel(&morsels_[locked_morsel_]);
+    {
+      std::scoped_lock guard(latch_);
+      locked_morsel_++;
+    }
+    cv_.notify_all();
+  }
+}
+
+void ParallelSeqScanExecutor::LockMorsel(Morsel *morsel) {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = plan_->GetTableOid();
+  auto iterator = table_info_->table_->MakeRangeIterator(morsel->first_page_id_, morsel->stop_page_id_);
+  auto zone_page_id = INVALID_PAGE_ID;
+  while (!iterator.IsEnd()) {
+    // A serial scan does not lock the rows of pages the zone map rules out either
+    if (iterator.GetRID().GetPageId() != zone_page_id) {
+      zone_page_id = iterator.GetRID().GetPageId();
+      if (!filter_.MayMatchPage(zone_page_id)) {
+        iterator.SkipPage();
+        continue;
+      }
+    }
+    auto rid = iterator.GetRID();
+    if (!txn->IsRowExclusiveLocked(oid, rid) && !txn->IsRowSharedLocked(oid, rid)) {
+      if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::SHARED, oid, rid)) {
+        throw ExecutionException("can not get lock");
+      }
+      morsel->locked_rids_.push_back(rid);
+    }
+    morsel->rids_.insert(rid);
+    ++iterator;
+  }
+}
+
+void ParallelSeqScanExecutor::UnlockMorsel(const Morsel &morsel, const std::vector<std::pair<Tuple, RID>> &rows) {
+  if (morsel.locked_rids_.empty()) {
+    return;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = plan_->GetTableOid();
+  std::unordered_set<RID> returned;
+  for (const auto &row : rows) {
+    returned.insert(row.second);
+  }
+  // Rows that are not returned are never read, read committed lets go of returned rows as well
+  for (const auto &rid : morsel.locked_rids_) {
+    bool emit_row = returned.count(rid) != 0;
+    if (!emit_row || txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+      exec_ctx_->GetLockManager()->UnlockRow(txn, oid, rid, !emit_row);
+    }
+  }
+}
+
+void ParallelSeqScanExecutor::AddRuntimeFilter(std::shared_ptr<const RuntimeFilter> filter) {
+  std::scoped_lock guard(latch_);
+  runtime_filters_.push_back(std::move(filter));
+}
+
+void ParallelSeqScanExecutor::RunWorker() {
+  auto window = LOOKAHEAD * num_workers_;
+  while (true) {
+    size_t idx;
+    std::vector<std::shared_ptr<const RuntimeFilter>> runtime_filters;
+    {
+      std::unique_lock guard(latch_);
+      // Workers stay a bounded number of morsels ahead of Next(), so a slow consumer does not buffer the whole table
+      cv_.wait(guard, [&] {
+        return stop_ || next_morsel_ == morsels_.size() ||
+               (next_morsel_ < locked_morsel_ && next_morsel_ < gather_morsel_ + window);
+      });
+      if (stop_ || next_morsel_ == morsels_.size()) {
+        return;
+      }
+      idx = next_morsel_++;
+      runtime_filters = runtime_filters_;
+    }
+
+    std::vector<std::pair<Tuple, RID>> rows;
+    try {
+      ScanMorsel(morsels_[idx], runtime_filters, &rows);
+    } catch (...) {
+      std::scoped_lock guard(latch_);
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+      stop_ = true;
+      cv_.notify_all();
+      return;
+    }
+
+    {
+      std::scoped_lock guard(latch_);
+      results_[idx] = std::move(rows);
+    }
+    cv_.notify_all();
+  }
+}
+
+void ParallelSeqScanExecutor::ScanMorsel(const Morsel &morsel,
+                                         const std::vector<std::shared_ptr<const RuntimeFilter>> &runtime_filters,
+                                         std::vector<std::pair<Tuple, RID>> *rows) const {
+  auto *zone_map = table_info_->table_->GetZoneMap();
+  auto iterator = table_info_->table_->MakeRangeIterator(morsel.first_page_id_, morsel.stop_page_id_);
+  auto zone_page_id = INVALID_PAGE_ID;
+  while (!iterator.IsEnd()) {
+    if (iterator.GetRID().GetPageId() != zone_page_id) {
+      zone_page_id = iterator.GetRID().GetPageId();
+      if (!filter_.MayMatchPage(zone_page_id) ||
+          std::any_of(runtime_filters.begin(), runtime_filters.end(),
+                      [&](const auto &filter) { return !filter->MayMatchPage(zone_map, zone_page_id); })) {
+        iterator.SkipPage();
+        continue;
+      }
+    }
+    // Rows added after the morsel was locked are left out, a serial scan that is past them misses them as well
+    if (lock_rows_ && morsel.rids_.count(iterator.GetRID()) == 0) {
+      ++iterator;
+      continue;
+    }
+    auto [meta, view] = columnar_ ? iterator.GetTupleColumns(filter_.GetColumns()) : iterator.GetTupleView();
+    if (!meta.is_deleted_ && filter_.Matches(view, table_info_->schema_)) {
+      // Only the columns of the filter were gathered from a PAX page
+      auto tuple = columnar_ ? iterator.GetTuple().second : Tuple();
+      auto row = columnar_ ? TupleView(tuple) : view;
+      if (std::all_of(runtime_filters.begin(), runtime_filters.end(),
+                      [&](const auto &filter) { return filter->MayMatch(row, table_info_->schema_); })) {
+        rows->emplace_back(columnar_ ? std::move(tuple) : view.Materialize(), iterator.GetRID());
+      }
+    }
+    ++iterator;
+  }
+  iterator.ReleasePage();
+}
+
+void ParallelSeqScanExecutor::StopWorkers() {
+  {
+    std::scoped_lock guard(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+}  // namespace bustub
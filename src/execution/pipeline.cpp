@@ -0,0 +1,373 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline.cpp
+//
+// Identification: src/execution/pipeline.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/pipeline.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/aggregation_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+
+namespace bustub {
+
+void FilterOperator::Execute(TupleBatch *batch, const std::function<void(TupleBatch *)> &emit) {
+  batch->Select(plan_->GetPredicate()->EvaluateBatch(*batch, plan_->GetChildPlan()->OutputSchema()));
+  if (!batch->IsEmpty()) {
+    emit(batch);
+  }
+}
+
+void ProjectionOperator::Execute(TupleBatch *batch, const std::function<void(TupleBatch *)> &emit) {
+  TupleBatch projected;
+  projected.Reset(plan_->OutputSchema());
+  const auto &exprs = plan_->GetExpressions();
+  for (uint32_t i = 0; i < exprs.size(); i++) {
+    projected.SetColumn(i, exprs[i]->EvaluateBatch(*batch, plan_->GetChildPlan()->OutputSchema()));
+  }
+  projected.SetRIDs(batch->GetRIDs());
+  emit(&projected);
+}
+
+void ResultSink::Consume(const TupleBatch &batch) {
+  if (result_set_ == nullptr) {
+    return;
+  }
+  for (size_t row = 0; row < batch.Size(); row++) {
+    result_set_->push_back(batch.GetTuple(row, schema_));
+  }
+}
+
+void Pipeline::Run() {
+  sink_->BeginInput();
+  auto consume = [this](const TupleBatch &output) { sink_->Consume(output); };
+  bool thread_safe = std::all_of(operators_.begin(), operators_.end(),
+                                 [](const std::unique_ptr<PipelineOperator> &op) { return op->IsThreadSafe(); });
+  if (num_workers_ > 1 && thread_safe) {
+    RunParallel(num_workers_);
+  } else {
+    TupleBatch batch;
+    while (source_->NextBatch(&batch)) {
+      Push(0, &batch, consume);
+    }
+  }
+  // What an operator held back still flows through the operators above it
+  for (size_t i = 0; i < operators_.size(); i++) {
+    operators_[i]->Finish([&](TupleBatch *output) { Push(i + 1, output, consume); });
+  }
+  sink_->FinishInput();
+}
+
+void Pipeline::Push(size_t op_idx, TupleBatch *batch, const std::function<void(const TupleBatch &)> &consume) {
+  if (op_idx == operators_.size()) {
+    consume(*batch);
+    return;
+  }
+  operators_[op_idx]->Execute(batch, [&](TupleBatch *output) { Push(op_idx + 1, output, consume); });
+}
+
+void Pipeline::RunParallel(size_t num_workers) {
+  std::mutex latch;
+  std::condition_variable cv;
+  bool exhausted = false;
+  std::exception_ptr error;
+  size_t next_morsel = 0;
+  // The output of the morsels that are done but not yet handed to the sink, and the next morsel to hand over
+  std::map<size_t, std::vector<TupleBatch>> done;
+  size_t next_to_sink = 0;
+  // How many morsels the workers may run ahead of the sink, which bounds the output held back
+  const size_t window = 2 * num_workers;
+
+  auto work = [&]() {
+    while (true) {
+      TupleBatch batch;
+      size_t morsel;
+      {
+        std::unique_lock lock(latch);
+        cv.wait(lock, [&]() { return next_morsel - next_to_sink < window || exhausted || error != nullptr; });
+        if (exhausted || error != nullptr) {
+          return;
+        }
+        try {
+          exhausted = !source_->NextBatch(&batch);
+        } catch (...) {
+          error = std::current_exception();
+        }
+        if (exhausted || error != nullptr) {
+          cv.notify_all();
+          return;
+        }
+        morsel = next_morsel++;
+      }
+      std::vector<TupleBatch> output;
+      std::exception_ptr failure;
+      try {
+        Push(0, &batch, [&](const TupleBatch &out) { output.push_back(out); });
+      } catch (...) {
+        failure = std::current_exception();
+      }
+      std::unique_lock lock(latch);
+      if (failure != nullptr) {
+        error = error != nullptr ? error : failure;
+        cv.notify_all();
+        return;
+      }
+      done.emplace(morsel, std::move(output));
+      // The worker that finishes the next morsel hands it over, with the ones after it that are done already
+      try {
+        while (error == nullptr && !done.empty() && done.begin()->first == next_to_sink) {
+          for (const auto &out : done.begin()->second) {
+            sink_->Consume(out);
+          }
+          done.erase(done.begin());
+          next_to_sink++;
+        }
+      } catch (...) {
+        error = error != nullptr ? error : std::current_exception();
+      }
+      cv.notify_all();
+    }
+  };
+
+  // The calling thread is one of the workers
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_workers; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+PipelineGraph::PipelineGraph(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan,
+                             std::vector<Tuple> *result_set)
+    : exec_ctx_(exec_ctx), result_sink_(plan->OutputSchema(), result_set) {
+  AddPipeline(plan, &result_sink_);
+  concurrent_ = pipeline_workers.load() > 1 && pipelines_.size() > 1 && !exec_ctx_->IsDelete() && IsReadOnly(plan);
+}
+
+auto PipelineGraph::AddPipeline(const AbstractPlanNodeRef &plan, PipelineBreaker *sink) -> Pipeline * {
+  auto pipeline = std::make_unique<Pipeline>(sink);
+  Build(plan, pipeline.get());
+  pipelines_.push_back(std::move(pipeline));
+  return pipelines_.back().get();
+}
+
+void PipelineGraph::Build(const AbstractPlanNodeRef &plan, Pipeline *pipeline) {
+  switch (plan->GetType()) {
+    case PlanType::Filter: {
+      const auto *filter_plan = dynamic_cast<const FilterPlanNode *>(plan.get());
+      Build(filter_plan->GetChildPlan(), pipeline);
+      pipeline->AddOperator(std::make_unique<FilterOperator>(filter_plan));
+      return;
+    }
+    case PlanType::Projection: {
+      const auto *projection_plan = dynamic_cast<const ProjectionPlanNode *>(plan.get());
+      Build(projection_plan->GetChildPlan(), pipeline);
+      pipeline->AddOperator(std::make_unique<ProjectionOperator>(projection_plan));
+      return;
+    }
+    case PlanType::HashJoin: {
+      const auto *join_plan = dynamic_cast<const HashJoinPlanNode *>(plan.get());
+      auto join = std::make_unique<HashJoinExecutor>(exec_ctx_, join_plan, nullptr, nullptr);
+      // The hash table is built by a pipeline of its own, which finishes before the left side is probed
+      pipeline->AddDependency(AddPipeline(join_plan->GetRightPlan(), join.get()));
+      Build(join_plan->GetLeftPlan(), pipeline);
+      // A scan of the left side is its source, the join passes it the filter over its right keys
+      if (join_plan->GetLeftPlan()->GetType() == PlanType::SeqScan) {
+        join->SetRuntimeFilterTarget(dynamic_cast<RuntimeFilterTarget *>(sources_.back()));
+      }
+      pipeline->AddOperator(std::make_unique<HashJoinProbeOperator>(join.get()));
+      // Morsels of the left side are probed on several threads
+      pipeline->SetNumWorkers(hash_join_workers.load());
+      executors_.push_back(std::move(join));
+      return;
+    }
+    case PlanType::Aggregation: {
+      const auto *aggregation_plan = dynamic_cast<const AggregationPlanNode *>(plan.get());
+      auto aggregation = std::make_unique<AggregationExecutor>(exec_ctx_, aggregation_plan, nullptr);
+      pipeline->AddDependency(AddPipeline(aggregation_plan->GetChildPlan(), aggregation.get()));
+      pipeline->SetSource(aggregation.get());
+      executors_.push_back(std::move(aggregation));
+      return;
+    }
+    case PlanType::Sort: {
+      const auto *sort_plan = dynamic_cast<const SortPlanNode *>(plan.get());
+      auto sort = std::make_unique<SortExecutor>(exec_ctx_, sort_plan, nullptr);
+      pipeline->AddDependency(AddPipeline(sort_plan->GetChildPlan(), sort.get()));
+      pipeline->SetSource(sort.get());
+      executors_.push_back(std::move(sort));
+      return;
+    }
+    default: {
+      // The executor of the whole subtree is pulled from
+      auto executor = ExecutorFactory::CreateExecutor(exec_ctx_, plan);
+      pipeline->SetSource(executor.get());
+      sources_.push_back(executor.get());
+      executors_.push_back(std::move(executor));
+      return;
+    }
+  }
+}
+
+auto PipelineGraph::IsReadOnly(const AbstractPlanNodeRef &plan) -> bool {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      scanned_tables_.push_back(dynamic_cast<const SeqScanPlanNode *>(plan.get())->GetTableOid());
+      return true;
+    case PlanType::MockScan:
+    case PlanType::Values:
+      return true;
+    case PlanType::Filter:
+    case PlanType::Projection:
+    case PlanType::Aggregation:
+    case PlanType::Sort:
+    case PlanType::TopN:
+    case PlanType::Limit:
+    case PlanType::HashJoin:
+    case PlanType::NestedLoopJoin:
+      return std::all_of(plan->GetChildren().begin(), plan->GetChildren().end(),
+                         [this](const AbstractPlanNodeRef &child) { return IsReadOnly(child); });
+    default:
+      // Writes and index lookups take their own locks
+      return false;
+  }
+}
+
+void PipelineGraph::Init() {
+  auto *txn = exec_ctx_->GetTransaction();
+  if (concurrent_ && txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
+    // A table lock covering the rows of a table spares its scans the row locks, which are only ever taken on one
+    // thread at a time. Tables are shared-locked to that end only if asked for, the lock is held until commit.
+    std::vector<table_oid_t> uncovered;
+    for (auto oid : scanned_tables_) {
+      if (!(txn->IsTableSharedLocked(oid) || txn->IsTableExclusiveLocked(oid) ||
+            txn->IsTableSharedIntentionExclusiveLocked(oid)) &&
+          std::find(uncovered.begin(), uncovered.end(), oid) == uncovered.end()) {
+        uncovered.push_back(oid);
+      }
+    }
+    if (!uncovered.empty() &&
+        !(pipeline_table_locks.load() && txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ)) {
+      concurrent_ = false;
+      uncovered.clear();
+    }
+    for (auto oid : uncovered) {
+      auto mode = txn->IsTableIntentionExclusiveLocked(oid) ? LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE
+                                                            : LockManager::LockMode::SHARED;
+      if (!exec_ctx_->GetLockManager()->LockTable(txn, mode, oid)) {
+        throw ExecutionException("can not get lock");
+      }
+    }
+  }
+  for (auto *source : sources_) {
+    source->Init();
+  }
+}
+
+void PipelineGraph::Run() {
+  if (!concurrent_) {
+    for (auto &pipeline : pipelines_) {
+      pipeline->Run();
+    }
+    return;
+  }
+  RunConcurrently(std::min(pipeline_workers.load(), pipelines_.size()));
+}
+
+void PipelineGraph::RunConcurrently(size_t num_workers) {
+  std::unordered_map<const Pipeline *, size_t> index;
+  for (size_t i = 0; i < pipelines_.size(); i++) {
+    index[pipelines_[i].get()] = i;
+  }
+  std::vector<size_t> waiting_on(pipelines_.size());
+  std::vector<std::vector<size_t>> dependents(pipelines_.size());
+  std::deque<size_t> ready;
+  for (size_t i = 0; i < pipelines_.size(); i++) {
+    waiting_on[i] = pipelines_[i]->GetDependencies().size();
+    for (const auto *dependency : pipelines_[i]->GetDependencies()) {
+      dependents[index[dependency]].push_back(i);
+    }
+    if (waiting_on[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  std::mutex latch;
+  std::condition_variable cv;
+  size_t finished = 0;
+  std::exception_ptr error;
+  auto work = [&]() {
+    std::unique_lock lock(latch);
+    while (true) {
+      cv.wait(lock, [&]() { return !ready.empty() || finished == pipelines_.size() || error != nullptr; });
+      // No more pipelines are started once one failed
+      if (finished == pipelines_.size() || error != nullptr) {
+        return;
+      }
+      auto i = ready.front();
+      ready.pop_front();
+      lock.unlock();
+      std::exception_ptr failure;
+      try {
+        pipelines_[i]->Run();
+      } catch (...) {
+        failure = std::current_exception();
+      }
+      lock.lock();
+      if (failure != nullptr) {
+        error = error != nullptr ? error : failure;
+      } else {
+        finished++;
+        for (auto dependent : dependents[i]) {
+          if (--waiting_on[dependent] == 0) {
+            ready.push_back(dependent);
+          }
+        }
+      }
+      cv.notify_all();
+    }
+  };
+
+  // The calling thread is one of the workers
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_workers; i++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace bustub
@@ -33,4 +33,18 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+
+  batch->Reset(GetOutputSchema());
+  const auto &exprs = plan_->GetExpressions();
+  for (uint32_t i = 0; i < exprs.size(); i++) {
+    batch->SetColumn(i, exprs[i]->EvaluateBatch(child_batch_, child_executor_->GetOutputSchema()));
+  }
+  batch->SetRIDs(child_batch_.GetRIDs());
+  return true;
+}
 }  // namespace bustub
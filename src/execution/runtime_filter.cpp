@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// runtime_filter.cpp
+//
+// Identification: src/execution/runtime_filter.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/runtime_filter.h"
+
+#include <utility>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/join_hash_table.h"
+
+namespace bustub {
+
+RuntimeFilter::RuntimeFilter(std::vector<AbstractExpressionRef> probe_keys)
+    : probe_keys_(std::move(probe_keys)),
+      ranged_(probe_keys_.size(), false),
+      min_(probe_keys_.size()),
+      max_(probe_keys_.size()) {}
+
+void RuntimeFilter::AddKey(hash_t hash, const std::vector<std::vector<Value>> &keys, size_t row) {
+  hashes_.push_back(hash);
+  for (size_t i = 0; i < keys.size(); i++) {
+    const auto &value = keys[i][row];
+    // The range of strings is not kept, a probe value of another type would be cast to compare with them
+    if (value.GetTypeId() == TypeId::VARCHAR) {
+      continue;
+    }
+    if (!has_keys_) {
+      ranged_[i] = true;
+      min_[i] = value;
+      max_[i] = value;
+      continue;
+    }
+    if (value.CompareLessThan(min_[i]) == CmpBool::CmpTrue) {
+      min_[i] = value;
+    }
+    if (value.CompareGreaterThan(max_[i]) == CmpBool::CmpTrue) {
+      max_[i] = value;
+    }
+  }
+  has_keys_ = true;
+}
+
+void RuntimeFilter::Build() {
+  size_t num_words = 1;
+  while (num_words * 64 < hashes_.size() * BITS_PER_KEY) {
+    num_words *= 2;
+  }
+  words_.assign(num_words, 0);
+  word_mask_ = num_words - 1;
+  for (auto hash : hashes_) {
+    words_[(hash >> 32) & word_mask_] |= HashBits(hash);
+  }
+  hashes_ = {};
+}
+
+auto RuntimeFilter::MayMatch(const TupleView &view, const Schema &schema) const -> bool {
+  if (!has_keys_) {
+    return false;
+  }
+  std::vector<std::vector<Value>> key(probe_keys_.size());
+  for (size_t i = 0; i < probe_keys_.size(); i++) {
+    auto value = probe_keys_[i]->EvaluateView(view, schema);
+    // A null key equals nothing
+    if (value.IsNull()) {
+      return false;
+    }
+    if (ranged_[i] && value.GetTypeId() != TypeId::VARCHAR && value.CheckComparable(min_[i]) &&
+        (value.CompareLessThan(min_[i]) == CmpBool::CmpTrue || value.CompareGreaterThan(max_[i]) == CmpBool::CmpTrue)) {
+      return false;
+    }
+    key[i].push_back(std::move(value));
+  }
+  auto hash = JoinHashTable::HashKey(key, 0);
+  auto bits = HashBits(hash);
+  return (words_[(hash >> 32) & word_mask_] & bits) == bits;
+}
+
+auto RuntimeFilter::MayMatchPage(ZoneMap *zone_map, page_id_t page_id) const -> bool {
+  if (zone_map == nullptr) {
+    return true;
+  }
+  std::optional<PageZone> zone;
+  for (size_t i = 0; i < probe_keys_.size(); i++) {
+    const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(probe_keys_[i].get());
+    if (!ranged_[i] || column_expr == nullptr || !zone_map->IsTracked(column_expr->GetColIdx())) {
+      continue;
+    }
+    if (!zone.has_value()) {
+      zone = zone_map->GetZone(page_id);
+      if (!zone.has_value()) {
+        return true;
+      }
+    }
+    const auto &column = zone->columns_[column_expr->GetColIdx()];
+    // A page with nothing but nulls in the key has no row to match
+    if (column.num_values_ == 0) {
+      return false;
+    }
+    if (!column.min_.CheckComparable(min_[i])) {
+      continue;
+    }
+    if (column.max_.CompareLessThan(min_[i]) == CmpBool::CmpTrue ||
+        column.min_.CompareGreaterThan(max_[i]) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -10,12 +10,161 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 
 namespace bustub {
 
+namespace {
+
+/** Collect the columns of the scanned table an expression reads, in column order. */
+void CollectColumns(const AbstractExpressionRef &expr, std::vector<uint32_t> *column_ids) {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    auto col_idx = column_value_expr->GetColIdx();
+    auto it = std::lower_bound(column_ids->begin(), column_ids->end(), col_idx);
+    if (it == column_ids->end() || *it != col_idx) {
+      column_ids->insert(it, col_idx);
+    }
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumns(child, column_ids);
+  }
+}
+
+/** @return whether `column op constant` can hold for a value of the range of a column. */
+auto MayCompare(const ColumnZone &column, ComparisonType comp_type, const Value &constant) -> bool {
+  // Comparisons with null are never true
+  if (column.num_values_ == 0 || constant.IsNull()) {
+    return false;
+  }
+  // Strings would be cast to the column type, such comparisons are left to the filter
+  if (constant.GetTypeId() != column.min_.GetTypeId() &&
+      (constant.GetTypeId() == TypeId::VARCHAR || !column.min_.CheckComparable(constant))) {
+    return true;
+  }
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return column.min_.CompareLessThanEquals(constant) == CmpBool::CmpTrue &&
+             column.max_.CompareGreaterThanEquals(constant) == CmpBool::CmpTrue;
+    case ComparisonType::NotEqual:
+      return column.min_.CompareNotEquals(constant) == CmpBool::CmpTrue ||
+             column.max_.CompareNotEquals(constant) == CmpBool::CmpTrue;
+    case ComparisonType::LessThan:
+      return column.min_.CompareLessThan(constant) == CmpBool::CmpTrue;
+    case ComparisonType::LessThanOrEqual:
+      return column.min_.CompareLessThanEquals(constant) == CmpBool::CmpTrue;
+    case ComparisonType::GreaterThan:
+      return column.max_.CompareGreaterThan(constant) == CmpBool::CmpTrue;
+    case ComparisonType::GreaterThanOrEqual:
+      return column.max_.CompareGreaterThanEquals(constant) == CmpBool::CmpTrue;
+  }
+  return true;
+}
+
+/** @return `constant op column` written as `column op' constant`. */
+auto Flip(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+/**
+ * Check a predicate against the zone of a page. Only comparisons of a tracked column with a constant and their
+ * conjunctions and disjunctions are looked at, anything else may match.
+ * @return false if no tuple of the page can satisfy the predicate
+ */
+auto MayMatch(const AbstractExpressionRef &expr, const PageZone &zone, const ZoneMap &zone_map) -> bool {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get()); logic_expr != nullptr) {
+    auto left = MayMatch(logic_expr->GetChildAt(0), zone, zone_map);
+    if (logic_expr->logic_type_ == LogicType::And) {
+      return left && MayMatch(logic_expr->GetChildAt(1), zone, zone_map);
+    }
+    return left || MayMatch(logic_expr->GetChildAt(1), zone, zone_map);
+  }
+  const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (comp_expr == nullptr) {
+    return true;
+  }
+  auto comp_type = comp_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(0).get());
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(comp_expr->GetChildAt(1).get());
+  if (column_expr == nullptr || constant_expr == nullptr) {
+    column_expr = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(1).get());
+    constant_expr = dynamic_cast<const ConstantValueExpression *>(comp_expr->GetChildAt(0).get());
+    comp_type = Flip(comp_type);
+  }
+  if (column_expr == nullptr || constant_expr == nullptr || !zone_map.IsTracked(column_expr->GetColIdx())) {
+    return true;
+  }
+  return MayCompare(zone.columns_[column_expr->GetColIdx()], comp_type, constant_expr->val_);
+}
+
+/** Replace the string constants of an expression that a dictionary holds by their encoded values. */
+auto EncodeConstants(const AbstractExpressionRef &expr, const Dictionary &dictionary) -> AbstractExpressionRef {
+  if (const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr.get()); constant_expr != nullptr) {
+    const auto &value = constant_expr->val_;
+    if (value.GetTypeId() != TypeId::VARCHAR || value.IsNull()) {
+      return expr;
+    }
+    const auto *entry = dictionary.Find(value.GetData(), value.GetLength());
+    return entry != nullptr ? std::make_shared<ConstantValueExpression>(Value(TypeId::VARCHAR, entry)) : expr;
+  }
+  std::vector<AbstractExpressionRef> children;
+  children.reserve(expr->GetChildren().size());
+  for (const auto &child : expr->GetChildren()) {
+    children.push_back(EncodeConstants(child, dictionary));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+}  // namespace
+
+ScanFilter::ScanFilter(const AbstractExpressionRef &predicate, TableHeap *table) : predicate_(predicate) {
+  if (predicate_ == nullptr) {
+    return;
+  }
+  CollectColumns(predicate_, &columns_);
+  // Strings of a dictionary-encoded table are compared with the constants of the filter by code
+  if (const auto *dictionary = table->GetDictionary(); dictionary != nullptr) {
+    predicate_ = EncodeConstants(predicate_, *dictionary);
+  }
+  zone_map_ = table->GetZoneMap();
+}
+
+auto ScanFilter::MayMatchPage(page_id_t page_id) const -> bool {
+  if (zone_map_ == nullptr) {
+    return true;
+  }
+  auto zone = zone_map_->GetZone(page_id);
+  return !zone.has_value() || MayMatch(predicate_, *zone, *zone_map_);
+}
+
+auto ScanFilter::Matches(const TupleView &view, const Schema &schema) const -> bool {
+  if (predicate_ == nullptr) {
+    return true;
+  }
+  auto value = predicate_->EvaluateView(view, schema);
+  return !value.IsNull() && value.GetAs<bool>();
+}
+
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {
   plan_ = plan;
 }
@@ -27,9 +176,11 @@ void SeqScanExecutor::Init() {
   if (exec_ctx_->IsDelete() && !(exec_ctx_->GetTransaction()->IsTableIntentionExclusiveLocked(tid) ||
                                  exec_ctx_->GetTransaction()->IsTableExclusiveLocked(tid) ||
                                  exec_ctx_->GetTransaction()->IsTableSharedIntentionExclusiveLocked(tid))) {
-    // if is_delete op
-    if (!exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), LockManager::LockMode::INTENTION_EXCLUSIVE,
-                                                tid)) {
+    // if is_delete op; a shared-locked table only upgrades to SIX, not to IX
+    auto mode = exec_ctx_->GetTransaction()->IsTableSharedLocked(tid)
+                    ? LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE
+                    : LockManager::LockMode::INTENTION_EXCLUSIVE;
+    if (!exec_ctx_->GetLockManager()->LockTable(exec_ctx_->GetTransaction(), mode, tid)) {
       throw ExecutionException("can not get lock");
     }
   } else {
@@ -45,64 +196,95 @@ void SeqScanExecutor::Init() {
       }
     }
   }
+  rows_covered_ = !exec_ctx_->IsDelete() && (exec_ctx_->GetTransaction()->IsTableSharedLocked(tid) ||
+                                              exec_ctx_->GetTransaction()->IsTableSharedIntentionExclusiveLocked(tid) ||
+                                              exec_ctx_->GetTransaction()->IsTableExclusiveLocked(tid));
+  read_guard_ = TableReadGuard(table_info_->table_.get());
   iterator_ = std::make_unique<TableIterator>(table_info_->table_->MakeEagerIterator());
+  // A PAX table is filtered a column at a time, only returned rows are read whole
+  columnar_ = table_info_->table_->GetFormat() == TableFormat::PAX;
+  filter_ = ScanFilter(plan_->filter_predicate_, table_info_->table_.get());
+  runtime_filters_.clear();
+  num_runtime_filtered_ = 0;
+  zone_page_id_ = INVALID_PAGE_ID;
 }
 
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  std::pair<TupleMeta, Tuple> tup;
-  while (!iterator_->IsEnd()) {
-    if (exec_ctx_->IsDelete() &&
-        !exec_ctx_->GetTransaction()->IsRowExclusiveLocked(plan_->GetTableOid(), iterator_->GetRID())) {
-      if (!exec_ctx_->GetLockManager()->LockRow(exec_ctx_->GetTransaction(), LockManager::LockMode::EXCLUSIVE,
-                                                plan_->GetTableOid(), iterator_->GetRID())) {
+template <typename Emit>
+auto SeqScanExecutor::ScanRows(size_t limit, Emit &&emit) -> size_t {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto oid = plan_->GetTableOid();
+  size_t emitted = 0;
+  while (emitted < limit && !iterator_->IsEnd()) {
+    // Pages are skipped whole when the zone map rules out the filter
+    if (iterator_->GetRID().GetPageId() != zone_page_id_) {
+      zone_page_id_ = iterator_->GetRID().GetPageId();
+      auto *zone_map = table_info_->table_->GetZoneMap();
+      if (!filter_.MayMatchPage(zone_page_id_) ||
+          std::any_of(runtime_filters_.begin(), runtime_filters_.end(),
+                      [&](const auto &filter) { return !filter->MayMatchPage(zone_map, zone_page_id_); })) {
+        iterator_->SkipPage();
+        continue;
+      }
+    }
+    bool locked_here = false;
+    // The page latch is dropped before waiting for a row lock, the holder of the lock may need the page
+    if (exec_ctx_->IsDelete() && !txn->IsRowExclusiveLocked(oid, iterator_->GetRID())) {
+      iterator_->ReleasePage();
+      if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, iterator_->GetRID())) {
         throw ExecutionException("can not get lock");
       }
-    } else if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
-      if (!exec_ctx_->GetTransaction()->IsRowExclusiveLocked(plan_->GetTableOid(), iterator_->GetRID()) &&
-          !exec_ctx_->GetTransaction()->IsRowSharedLocked(plan_->GetTableOid(), iterator_->GetRID())) {
-        if (!exec_ctx_->GetLockManager()->LockRow(exec_ctx_->GetTransaction(), LockManager::LockMode::SHARED,
-                                                  plan_->GetTableOid(), iterator_->GetRID())) {
+      locked_here = true;
+    } else if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED && !rows_covered_) {
+      if (!txn->IsRowExclusiveLocked(oid, iterator_->GetRID()) && !txn->IsRowSharedLocked(oid, iterator_->GetRID())) {
+        iterator_->ReleasePage();
+        if (!exec_ctx_->GetLockManager()->LockRow(txn, LockManager::LockMode::SHARED, oid, iterator_->GetRID())) {
           throw ExecutionException("can not get lock");
         }
+        locked_here = true;
       }
     }
-    tup = iterator_->GetTuple();
-    if (tup.first.is_deleted_) {
-      if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED &&
-          !exec_ctx_->IsDelete()) {
-        exec_ctx_->GetLockManager()->UnlockRow(exec_ctx_->GetTransaction(), plan_->GetTableOid(), iterator_->GetRID(),
-                                               true);
-      }
-    } else {
-      if (plan_->filter_predicate_) {
-        const Value &value = plan_->filter_predicate_->Evaluate(&tup.second, table_info_->schema_);
-        if (value.GetAs<bool>()) {
-          *tuple = tup.second;
-          *rid = iterator_->GetRID();
-        }
-      } else {
-        *tuple = tup.second;
-        *rid = iterator_->GetRID();
-      }
-      if (exec_ctx_->GetTransaction()->GetIsolationLevel() == IsolationLevel::READ_COMMITTED &&
-          !exec_ctx_->IsDelete()) {
-        exec_ctx_->GetLockManager()->UnlockRow(exec_ctx_->GetTransaction(), plan_->GetTableOid(), iterator_->GetRID(),
-                                               false);
-      }
-      break;
+    // Deleted and filtered out rows are skipped without copying them out of the page
+    auto [meta, view] = columnar_ ? iterator_->GetTupleColumns(filter_.GetColumns()) : iterator_->GetTupleView();
+    bool emit_row = !meta.is_deleted_ && filter_.Matches(view, table_info_->schema_);
+    // Only the columns of the filter were gathered from a PAX page
+    if (emit_row && columnar_) {
+      view = iterator_->GetTupleView().second;
+    }
+    // Rows without a match on the build side of the join above are dropped before they are copied out
+    if (emit_row && !std::all_of(runtime_filters_.begin(), runtime_filters_.end(), [&](const auto &filter) {
+          return filter->MayMatch(view, table_info_->schema_);
+        })) {
+      emit_row = false;
+      num_runtime_filtered_++;
+    }
+    if (emit_row) {
+      emit(view, iterator_->GetRID());
+      emitted++;
+    }
+    // Rows that are not returned are never read, read committed lets go of returned rows as well
+    if (locked_here && !exec_ctx_->IsDelete() &&
+        (!emit_row || txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED)) {
+      exec_ctx_->GetLockManager()->UnlockRow(txn, oid, iterator_->GetRID(), !emit_row);
     }
     ++(*iterator_);
   }
-  if (iterator_->IsEnd()) {
-    return false;
-  }
-  //  if (exec_ctx_->GetTransaction()->GetIsolationLevel() == IsolationLevel::READ_COMMITTED && !exec_ctx_->IsDelete())
-  //  {
-  //    exec_ctx_->GetLockManager()->UnlockRow(exec_ctx_->GetTransaction(), plan_->GetTableOid(), iterator_->GetRID(),
-  //                                           false);
-  //  }
-  ++(*iterator_);
-  return true;
+  // The parent may write to this table, so the page is not kept latched between calls
+  iterator_->ReleasePage();
+  return emitted;
+}
+
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  return ScanRows(1, [&](const TupleView &view, RID row_rid) {
+           *tuple = view.Materialize();
+           *rid = row_rid;
+         }) == 1;
+}
+
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(GetOutputSchema());
+  ScanRows(TupleBatch::CAPACITY,
+           [&](const TupleView &view, RID row_rid) { batch->Append(view, table_info_->schema_, row_rid); });
+  return !batch->IsEmpty();
 }
 
 }  // namespace bustub
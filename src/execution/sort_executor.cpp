@@ -7,16 +7,30 @@ SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 void SortExecutor::Init() {
   child_executor_->Init();
-  Tuple produce_tuple;
-  RID produce_rid;
-  while (child_executor_->Next(&produce_tuple, &produce_rid)) {
-    out_puts_.push_back(produce_tuple);
+  BeginInput();
+  TupleBatch batch;
+  while (child_executor_->NextBatch(&batch)) {
+    Consume(batch);
   }
-  auto comp = [this](const Tuple &left_tuple, const Tuple &right_tuple) {
+  FinishInput();
+}
+
+void SortExecutor::BeginInput() { out_puts_.clear(); }
+
+void SortExecutor::Consume(const TupleBatch &batch) {
+  const auto &child_schema = plan_->GetChildPlan()->OutputSchema();
+  for (size_t row = 0; row < batch.Size(); row++) {
+    out_puts_.push_back(batch.GetTuple(row, child_schema));
+  }
+}
+
+void SortExecutor::FinishInput() {
+  const auto &child_schema = plan_->GetChildPlan()->OutputSchema();
+  auto comp = [this, &child_schema](const Tuple &left_tuple, const Tuple &right_tuple) {
     bool flag = false;
     for (auto &it : plan_->order_bys_) {
-      const Value left_value = it.second->Evaluate(&left_tuple, child_executor_->GetOutputSchema());
-      const Value right_value = it.second->Evaluate(&right_tuple, child_executor_->GetOutputSchema());
+      const Value left_value = it.second->Evaluate(&left_tuple, child_schema);
+      const Value right_value = it.second->Evaluate(&right_tuple, child_schema);
       bool is_equal = left_value.CompareEquals(right_value) == CmpBool::CmpTrue;
       if (!is_equal) {
         bool is_less_than = left_value.CompareLessThan(right_value) == CmpBool::CmpTrue;
@@ -35,7 +49,6 @@ void SortExecutor::Init() {
   };
   std::sort(out_puts_.begin(), out_puts_.end(), comp);
   it_ = out_puts_.begin();
-  //  throw NotImplementedException("SortExecutor is not implemented");
 }
 
 auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
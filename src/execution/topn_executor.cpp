@@ -32,6 +32,8 @@ void TopNExecutor::Init() {
     return flag;
   };
   std::priority_queue<Tuple, std::vector<Tuple>, decltype(comp)> pq(comp);
+  // a join initializes its inner child once per outer tuple
+  out_puts_.clear();
   while (child_executor_->Next(&produce_tuple, &produce_rid)) {
     if (pq.size() < this->plan_->n_) {
       pq.push(produce_tuple);
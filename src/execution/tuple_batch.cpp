@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(const Schema &schema) {
+  columns_.resize(schema.GetColumnCount());
+  for (auto &column : columns_) {
+    column.clear();
+    column.reserve(CAPACITY);
+  }
+  rids_.clear();
+  rids_.reserve(CAPACITY);
+}
+
+void TupleBatch::Append(const Tuple &tuple, const Schema &schema, RID rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(&schema, i));
+  }
+  rids_.push_back(rid);
+}
+
+void TupleBatch::Append(const TupleView &view, const Schema &schema, RID rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(view.CopyValue(&schema, i));
+  }
+  rids_.push_back(rid);
+}
+
+void TupleBatch::Append(std::vector<Value> values, RID rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(std::move(values[i]));
+  }
+  rids_.push_back(rid);
+}
+
+void TupleBatch::Select(const std::vector<Value> &predicate) {
+  size_t kept = 0;
+  for (size_t row = 0; row < rids_.size(); row++) {
+    if (predicate[row].IsNull() || !predicate[row].GetAs<bool>()) {
+      continue;
+    }
+    if (kept != row) {
+      for (auto &column : columns_) {
+        column[kept] = std::move(column[row]);
+      }
+      rids_[kept] = rids_[row];
+    }
+    kept++;
+  }
+  for (auto &column : columns_) {
+    column.resize(kept, Value());
+  }
+  rids_.resize(kept);
+}
+
+auto TupleBatch::GetTuple(size_t row, const Schema &schema) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  return {values, &schema};
+}
+
+}  // namespace bustub
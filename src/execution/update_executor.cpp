@@ -9,7 +9,10 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "execution/executors/update_executor.h"
 
@@ -31,44 +34,65 @@ void UpdateExecutor::Init() {
 }
 
 auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
-  Tuple update_tuple;
-  RID update_rid;
+  Tuple child_tuple;
+  RID child_rid;
   int count = 0;
   if (child_executor_ == nullptr) {
     return false;
   }
-  while (child_executor_->Next(&update_tuple, &update_rid)) {
-    // delete
-    TupleMeta meta = table_info_->table_->GetTupleMeta(update_rid);
-    Tuple old_tuple = table_info_->table_->GetTuple(update_rid).second;
-    meta.is_deleted_ = true;
-    table_info_->table_->UpdateTupleMeta(meta, update_rid);
-    // update content
+  // Drain the child first, an index scan below must not observe the entries this update reinserts
+  std::vector<std::pair<Tuple, RID>> targets;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    targets.emplace_back(child_tuple, child_rid);
+  }
+  const auto &schema = table_info_->schema_;
+  auto txn = exec_ctx_->GetTransaction();
+  for (auto &[update_tuple, update_rid] : targets) {
+    // Keep the old version by value, the overflow pages it points to are freed once it is replaced
+    auto stored_tuple = table_info_->table_->GetTuple(update_rid).second;
+    std::vector<Value> old_values;
+    old_values.reserve(schema.GetColumnCount());
+    for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+      old_values.push_back(stored_tuple.GetValue(&schema, i));
+    }
+    Tuple old_tuple(old_values, &schema);
     std::vector<Value> values;
     for (auto &it : plan_->target_expressions_) {
-      Value value = it->Evaluate(&update_tuple, table_info_->schema_);
+      Value value = it->Evaluate(&update_tuple, schema);
       values.push_back(value);
     }
-    Tuple u_tuple(values, &table_info_->schema_);
-    meta.is_deleted_ = false;
-    // update tableHeap
-    std::optional<RID> insert_rid = table_info_->table_->InsertTuple(meta, u_tuple);
-    exec_ctx_->GetTransaction()->AppendTableWriteRecord(
-        TableWriteRecord(table_id_, insert_rid.value(), table_info_->table_.get()));
-    // update index
+    Tuple u_tuple(values, &schema);
+
+    // The tuple keeps its RID, so only indexes over changed columns need new entries
+    table_info_->table_->UpdateTuple(u_tuple, update_rid);
+    TableWriteRecord table_record(table_id_, update_rid, table_info_->table_.get(), WType::UPDATE);
+    table_record.old_tuple_ = old_tuple;
+    txn->AppendTableWriteRecord(table_record);
     for (auto &index_info_tmp : index_list_) {
-      if (index_info_tmp != nullptr) {
-        index_info_tmp->index_->DeleteEntry(update_tuple.KeyFromTuple(table_info_->schema_, index_info_tmp->key_schema_,
-                                                                      index_info_tmp->index_->GetKeyAttrs()),
-                                            update_rid, exec_ctx_->GetTransaction());
-        index_info_tmp->index_->InsertEntry(u_tuple.KeyFromTuple(table_info_->schema_, index_info_tmp->key_schema_,
-                                                                 index_info_tmp->index_->GetKeyAttrs()),
-                                            insert_rid.value(), exec_ctx_->GetTransaction());
-        auto index_record = IndexWriteRecord(insert_rid.value(), table_id_, WType::UPDATE, u_tuple,
-                                             index_info_tmp->index_oid_, exec_ctx_->GetCatalog());
-        index_record.old_tuple_ = old_tuple;
-        exec_ctx_->GetTransaction()->AppendIndexWriteRecord(index_record);
+      if (index_info_tmp == nullptr) {
+        continue;
+      }
+      const auto &key_attrs = index_info_tmp->index_->GetKeyAttrs();
+      auto key_changed = std::any_of(key_attrs.begin(), key_attrs.end(), [&](uint32_t attr) {
+        const auto &old_value = old_values[attr];
+        const auto &new_value = values[attr];
+        if (old_value.IsNull() || new_value.IsNull()) {
+          return old_value.IsNull() != new_value.IsNull();
+        }
+        return old_value.CompareEquals(new_value) != CmpBool::CmpTrue;
+      });
+      if (!key_changed) {
+        continue;
       }
+      index_info_tmp->index_->DeleteEntry(old_tuple.KeyFromTuple(schema, index_info_tmp->key_schema_, key_attrs),
+                                          update_rid, txn);
+      index_info_tmp->index_->InsertEntry(u_tuple.KeyFromTuple(schema, index_info_tmp->key_schema_, key_attrs),
+                                          update_rid, txn);
+      auto index_record =
+          IndexWriteRecord(update_rid, table_id_, WType::UPDATE, u_tuple, index_info_tmp->index_oid_,
+                           exec_ctx_->GetCatalog());
+      index_record.old_tuple_ = old_tuple;
+      txn->AppendIndexWriteRecord(index_record);
     }
     count++;
   }
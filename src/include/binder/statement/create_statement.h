@@ -12,6 +12,7 @@
 
 #include "binder/bound_statement.h"
 #include "catalog/column.h"
+#include "storage/table/table_heap.h"
 
 namespace duckdb_libpgquery {
 struct PGCreateStmt;
@@ -21,10 +22,13 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns, TableFormat format = TableFormat::ROW,
+                           TableEncoding encoding = TableEncoding::PLAIN);
 
   std::string table_;
   std::vector<Column> columns_;
+  TableFormat format_;
+  TableEncoding encoding_;
 
   auto ToString() const -> std::string override;
 };
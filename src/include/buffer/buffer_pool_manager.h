@@ -138,6 +138,14 @@ class BufferPoolManager {
    */
   auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
 
+  /**
+   * @brief Bring a page into the buffer pool ahead of its use without keeping it pinned, so that a scan finds the
+   * page resident when it gets there. This is only a hint: a page already in the pool is left alone.
+   *
+   * @param page_id id of page to prefetch
+   */
+  void PrefetchPage(page_id_t page_id);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,6 +28,27 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** Number of threads a sequential scan of a large table runs on, 1 to always scan serially. */
+extern std::atomic<size_t> parallel_scan_workers;
+
+/** Number of threads the pipelines of a read-only query run on, 1 to run them one after another. */
+extern std::atomic<size_t> pipeline_workers;
+
+/**
+ * True if a read-only query under repeatable read may shared-lock the tables it scans until commit, so that its
+ * pipelines run concurrently. Otherwise only queries whose tables need no row locks run their pipelines concurrently.
+ */
+extern std::atomic<bool> pipeline_table_locks;
+
+/** Number of threads a hash join builds its partitions and probes its left side on, 1 to join serially. */
+extern std::atomic<size_t> hash_join_workers;
+
+/** True if inner hash joins pass a filter over their build keys down to the scan of their probe side. */
+extern std::atomic<bool> enable_runtime_filters;
+
+/** Bytes of memory the hash tables of a query may hold before they spill to temporary pages. */
+extern std::atomic<size_t> query_memory_budget;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "common/macros.h"
+#include "type/dictionary.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -87,6 +88,10 @@ class HashUtil {
         return Hash<double>(&raw);
       }
       case TypeId::VARCHAR: {
+        // The hash of a dictionary-encoded string was taken when it entered the dictionary
+        if (val->GetDictionaryEntry() != nullptr) {
+          return val->GetDictionaryEntry()->hash_;
+        }
         auto raw = val->GetData();
         auto len = val->GetLength();
         return HashBytes(raw, len);
@@ -66,15 +66,18 @@ using index_oid_t = uint32_t;
 class TableWriteRecord {
  public:
   // NOLINTNEXTLINE
-  TableWriteRecord(table_oid_t tid, RID rid, TableHeap *table_heap) : tid_(tid), rid_(rid), table_heap_(table_heap) {}
+  TableWriteRecord(table_oid_t tid, RID rid, TableHeap *table_heap, WType wtype = WType::INSERT)
+      : tid_(tid), rid_(rid), table_heap_(table_heap), wtype_(wtype) {}
 
   table_oid_t tid_;
   RID rid_;
   TableHeap *table_heap_;
 
-  // Recording write type might be useful if you want to implement in-place update for leaderboard
-  // optimization. You don't need it for the basic implementation.
+  // Commit completes the deletes of the transaction, which lets vacuum reclaim their tuples.
   WType wtype_;
+
+  // An update replaces the tuple in place, abort writes this version back.
+  Tuple old_tuple_{};
 };
 
 /**
@@ -183,6 +186,7 @@ class Transaction {
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
     page_set_ = std::make_shared<std::deque<bustub::Page *>>();
     deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
+    insert_page_set_ = std::make_shared<std::unordered_map<TableHeap *, page_id_t>>();
   }
 
   ~Transaction() = default;
@@ -238,6 +242,11 @@ class Transaction {
    */
   inline void AddIntoDeletedPageSet(page_id_t page_id) { deleted_page_set_->insert(page_id); }
 
+  /** @return the page each table heap reserved for the inserts of this transaction */
+  inline auto GetInsertPageSet() -> std::shared_ptr<std::unordered_map<TableHeap *, page_id_t>> {
+    return insert_page_set_;
+  }
+
   /** @return the set of rows under a shared lock */
   inline auto GetSharedRowLockSet() -> std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> {
     return s_row_lock_set_;
@@ -346,6 +355,8 @@ class Transaction {
   std::shared_ptr<std::deque<Page *>> page_set_;
   /** Concurrent index: the page IDs that were deleted during index operation.*/
   std::shared_ptr<std::unordered_set<page_id_t>> deleted_page_set_;
+  /** TableHeap: the page each table heap reserved for the inserts of this transaction. */
+  std::shared_ptr<std::unordered_map<TableHeap *, page_id_t>> insert_page_set_;
 
   /** LockManager: the set of table locks held by this transaction. */
   std::shared_ptr<std::unordered_set<table_oid_t>> s_table_lock_set_;
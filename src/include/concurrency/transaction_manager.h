@@ -98,6 +98,12 @@ class TransactionManager {
   void ResumeTransactions();
 
  private:
+  /**
+   * Hands the insert pages the given transaction reserved back to their table heaps.
+   * @param txn the transaction whose insert pages should be released
+   */
+  void ReleaseInsertPages(Transaction *txn);
+
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -29,7 +34,18 @@ namespace bustub {
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table dynamically grows once full.
+ * table dynamically grows once half of its slots are taken.
+ *
+ * Growing is incremental. A resize only allocates the new, larger table and
+ * keeps the old one next to it. From then on every operation moves a few
+ * slots of the old table into the new one, lookups and removes check both
+ * tables, and inserts go to the new table. The old table is dropped once all
+ * of its slots are moved. No operation ever rehashes the whole table.
+ *
+ * Slots are claimed and released with atomic operations on the block pages,
+ * so inserts, removes, lookups and migration all run under the shared table
+ * latch. Only switching tables takes it exclusively. Inserts of keys hashing to
+ * the same stripe are serialized, so a pair is never put in twice.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -73,33 +89,79 @@ class LinearProbeHashTable {
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. The
+   * entries are moved over incrementally by the following operations.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return current size of the hash table, in slots
    */
   auto GetSize() -> size_t;
 
+  /**
+   * @return whether entries of an earlier, smaller table are still being moved
+   */
+  auto IsResizing() -> bool;
+
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
+  /** Number of slots of the old table an operation moves while a resize is in progress. */
+  static constexpr size_t MIGRATE_SLOTS_PER_OP = 16;
+  /** Number of latches inserts are spread over by the hash of their key. */
+  static constexpr size_t INSERT_LATCH_STRIPES = 64;
+
+  auto GetHeaderPage(page_id_t header_page_id) -> HashTableHeaderPage *;
   auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
-  void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
+
+  /** Allocate a header page and enough block pages for num_slots slots. */
+  auto CreateTable(size_t num_slots) -> page_id_t;
+  void DeleteBlockPages(page_id_t header_page_id);
+
+  /**
+   * Walk the probe sequence of a key in one table, from its home slot to the first never-occupied slot.
+   * @param on_match called with the block page and offset of every readable slot holding the key, sets its last
+   * argument if it wrote to the block, returns true to stop
+   * @return the first never-occupied slot, or std::nullopt if the walk stopped early or went around the whole table
+   */
+  auto Probe(page_id_t header_page_id, const KeyType &key,
+             const std::function<bool(HASH_TABLE_BLOCK_TYPE *, slot_offset_t, bool *)> &on_match)
+      -> std::optional<size_t>;
+  auto ProbeGetValue(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result) -> bool;
+  /** @return the slot the pair was put in, or std::nullopt if the table is full */
+  auto ProbeInsert(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> std::optional<size_t>;
+  auto ProbeRemove(page_id_t header_page_id, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Move the next few slots of the old table into the new one, if no other thread is at it. Needs the shared latch.
+   * @return true if the old table is empty and can be dropped
+   */
+  auto MigrateSome(size_t num_slots) -> bool;
+  /** Drop the old table once it has been emptied. Takes the exclusive latch. */
+  void DropOldTable();
+  /** Move everything left in the old table and drop it. Needs the exclusive latch. */
+  void FinishMigrationLatched();
 
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts, removes and migration, writer only switches tables
   ReaderWriterLatch table_latch_;
 
+  // The table being emptied into the one at header_page_id_, INVALID_PAGE_ID if not resizing
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // The next slot of the old table to move, guarded by migrate_latch_
+  size_t migrate_cursor_{0};
+  std::mutex migrate_latch_;
+  // Serialize the duplicate check and the insert of keys in the same stripe
+  std::array<std::mutex, INSERT_LATCH_STRIPES> insert_latches_;
+
+  // Slots taken in the current table, including tombstones
+  std::atomic<size_t> num_occupied_{0};
+
   // Hash function
   HashFunction<KeyType> hash_fn_;
 };
@@ -21,6 +21,7 @@
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/executors/init_check_executor.h"
+#include "execution/pipeline.h"
 #include "execution/plans/abstract_plan.h"
 #include "storage/table/tuple.h"
 
@@ -55,15 +56,15 @@ class ExecutionEngine {
                ExecutorContext *exec_ctx) -> bool {
     BUSTUB_ASSERT((txn == exec_ctx->GetTransaction()), "Broken Invariant");
 
-    // Construct the executor for the abstract plan node
-    auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
+    // Split the plan into pipelines, constructing the executors they pull from
+    PipelineGraph pipelines(exec_ctx, plan, result_set);
 
-    // Initialize the executor
+    // Initialize the executors and run the pipelines
     auto executor_succeeded = true;
 
     try {
-      executor->Init();
-      PollExecutor(executor.get(), plan, result_set);
+      pipelines.Init();
+      pipelines.Run();
       PerformChecks(exec_ctx);
     } catch (const ExecutionException &ex) {
       executor_succeeded = false;
@@ -86,23 +87,6 @@ class ExecutionEngine {
   }
 
  private:
-  /**
-   * Poll the executor until exhausted, or exception escapes.
-   * @param executor The root executor
-   * @param plan The plan to execute
-   * @param result_set The tuple result set
-   */
-  static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
-                           std::vector<Tuple> *result_set) {
-    RID rid{};
-    Tuple tuple{};
-    while (executor->Next(&tuple, &rid)) {
-      if (result_set != nullptr) {
-        result_set->push_back(tuple);
-      }
-    }
-  }
-
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] TransactionManager *txn_mgr_;
   [[maybe_unused]] Catalog *catalog_;
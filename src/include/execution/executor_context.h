@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <unordered_set>
@@ -19,6 +20,7 @@
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/config.h"
 #include "concurrency/transaction.h"
 #include "execution/check_options.h"
 #include "execution/executors/abstract_executor.h"
@@ -46,7 +48,8 @@ class ExecutorContext {
         bpm_{bpm},
         txn_mgr_(txn_mgr),
         lock_mgr_(lock_mgr),
-        is_delete_(is_delete) {
+        is_delete_(is_delete),
+        memory_budget_(query_memory_budget.load()) {
     nlj_check_exec_set_ = std::deque<std::pair<AbstractExecutor *, AbstractExecutor *>>(
         std::deque<std::pair<AbstractExecutor *, AbstractExecutor *>>{});
     check_options_ = std::make_shared<CheckOptions>();
@@ -93,6 +96,27 @@ class ExecutorContext {
 
   auto IsDelete() const -> bool { return is_delete_; }
 
+  /**
+   * Reserve memory from the budget of the query, which is shared by all its executors.
+   * @param bytes the number of bytes
+   * @return false, reserving nothing, if the reservation would exceed the budget
+   */
+  auto ReserveMemory(size_t bytes) -> bool {
+    auto used = memory_used_.load();
+    do {
+      if (used + bytes > memory_budget_) {
+        return false;
+      }
+    } while (!memory_used_.compare_exchange_weak(used, used + bytes));
+    return true;
+  }
+
+  /** Give back memory reserved with ReserveMemory(). */
+  void ReleaseMemory(size_t bytes) { memory_used_ -= bytes; }
+
+  /** @return the number of bytes reserved from the budget of the query */
+  auto GetMemoryUsed() const -> size_t { return memory_used_.load(); }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -109,6 +133,9 @@ class ExecutorContext {
   /** The set of check options associated with this executor context */
   std::shared_ptr<CheckOptions> check_options_;
   bool is_delete_;
+  /** The memory budget of the query, in bytes, and how much of it is reserved */
+  size_t memory_budget_;
+  std::atomic<size_t> memory_used_{0};
 };
 
 }  // namespace bustub
@@ -22,6 +22,7 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/pipeline_breaker.h"
 #include "execution/plans/aggregation_plan.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
@@ -176,13 +177,14 @@ class SimpleAggregationHashTable {
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
  */
-class AggregationExecutor : public AbstractExecutor {
+class AggregationExecutor : public AbstractExecutor, public PipelineBreaker {
  public:
   /**
    * Construct a new AggregationExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The insert plan to be executed
-   * @param child_executor The child executor from which inserted tuples are pulled (may be `nullptr`)
+   * @param child_executor The child executor from which inserted tuples are pulled (`nullptr` when a pipeline pushes
+   * the input in through the PipelineBreaker interface instead)
    */
   AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                       std::unique_ptr<AbstractExecutor> &&child);
@@ -190,6 +192,15 @@ class AggregationExecutor : public AbstractExecutor {
   /** Initialize the aggregation */
   void Init() override;
 
+  /** Empty the aggregation hash table */
+  void BeginInput() override;
+
+  /** Combine a batch of child rows into the aggregation hash table */
+  void Consume(const TupleBatch &batch) override;
+
+  /** Add the row of an aggregation without group-bys over no input, and start returning the groups */
+  void FinishInput() override;
+
   /**
    * Yield the next tuple from the insert.
    * @param[out] tuple The next tuple produced by the aggregation
@@ -198,6 +209,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of groups from the aggregation.
+   * @param[out] batch The next tuples produced by the aggregation
+   * @return `true` if at least one tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -209,7 +227,7 @@ class AggregationExecutor : public AbstractExecutor {
   auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
     std::vector<Value> keys;
     for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+      keys.emplace_back(expr->Evaluate(tuple, plan_->GetChildPlan()->OutputSchema()));
     }
     return {keys};
   }
@@ -218,7 +236,7 @@ class AggregationExecutor : public AbstractExecutor {
   auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
     std::vector<Value> vals;
     for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+      vals.emplace_back(expr->Evaluate(tuple, plan_->GetChildPlan()->OutputSchema()));
     }
     return {vals};
   }
@@ -12,74 +12,94 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/join_hash_table.h"
+#include "execution/pipeline_breaker.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/runtime_filter.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
 namespace bustub {
-struct HashJoinKey {
-  std::vector<Value> keys_;
-  /**
-   * Compares two aggregate keys for equality.
-   * @param other the other aggregate key to be compared with
-   * @return `true` if both aggregate keys have equivalent group-by expressions, `false` otherwise
-   */
-  auto operator==(const HashJoinKey &other) const -> bool {
-    for (uint32_t i = 0; i < other.keys_.size(); i++) {
-      if (keys_[i].CompareEquals(other.keys_[i]) != CmpBool::CmpTrue) {
-        return false;
-      }
-    }
-    return true;
-  }
-};
-struct HashJoinValue {
-  std::vector<Tuple> values_;
-};
-}  // namespace bustub
-namespace std {
-
-/** Implements std::hash on AggregateKey */
-template <>
-struct hash<bustub::HashJoinKey> {
-  auto operator()(const bustub::HashJoinKey &agg_key) const -> std::size_t {
-    size_t curr_hash = 0;
-    for (const auto &key : agg_key.keys_) {
-      if (!key.IsNull()) {
-        curr_hash = bustub::HashUtil::CombineHashes(curr_hash, bustub::HashUtil::HashValue(&key));
-      }
-    }
-    return curr_hash;
-  }
-};
-
-}  // namespace std
-namespace bustub {
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hash JOIN on two tables.
+ *
+ * The right side is built into one JoinHashTable per partition, the partition of a key being the top bits of its
+ * hash. The left side is looked up a batch at a time, prefetching the slots of the rows ahead. The directories of the
+ * partitions are built on up to `hash_join_workers` threads, one partition per thread at a time; run in a pipeline,
+ * the left side is probed by that many threads too, each taking morsels of left batches.
+ *
+ * An inner join whose left side is a scan passes a RuntimeFilter over its right keys down to the scan once the hash
+ * table is built, so left rows that cannot match are dropped as they are read.
+ *
+ * The hash table of the right side is held within the memory budget of the query. When it would exceed the budget,
+ * the join turns into a hybrid hash join: the keys are split into SPILL_PARTITIONS partitions by hash, and the largest
+ * partitions are spilled to temporary pages until the rest fits. Left rows of a spilled partition are spilled as well
+ * instead of being probed, and the spilled partitions are joined one at a time once the left side is exhausted. A
+ * spilled partition is loaded whole, even if it alone exceeds the budget.
  */
-class HashJoinExecutor : public AbstractExecutor {
+class HashJoinExecutor : public AbstractExecutor, public PipelineBreaker {
  public:
+  /** Number of partitions the keys are split into, which are spilled as a whole */
+  static constexpr size_t PARTITION_BITS = 4;
+  static constexpr size_t SPILL_PARTITIONS = 1 << PARTITION_BITS;
+
+  /** Number of right rows below which the partitions are built on the calling thread only */
+  static constexpr size_t PARALLEL_BUILD_ROWS = 16384;
+
   /**
    * Construct a new HashJoinExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The HashJoin join plan to be executed
    * @param left_child The child executor that produces tuples for the left side of join
    * @param right_child The child executor that produces tuples for the right side of join
+   *
+   * Run in a pipeline, both children are `nullptr`: the right side is pushed in through the PipelineBreaker interface
+   * and the left side is joined a batch at a time with Probe().
    */
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
 
+  /** Give back the memory of the hash table */
+  ~HashJoinExecutor() override;
+
   /** Initialize the join */
   void Init() override;
 
+  /** Empty the hash table and drop the spilled partitions */
+  void BeginInput() override;
+
+  /** Add a batch of right side rows to the hash table */
+  void Consume(const TupleBatch &batch) override;
+
+  /** Build the directories of the partitions held in memory, in parallel */
+  void FinishInput() override;
+
+  /**
+   * Join a batch of left side rows with the hash table, spilling the rows of spilled partitions.
+   * @param batch the left side rows
+   * @param emit called with every batch of joined rows, at most TupleBatch::CAPACITY rows each
+   */
+  void Probe(const TupleBatch &batch, const std::function<void(TupleBatch *)> &emit);
+
+  /**
+   * Join the spilled partitions, once every left batch was passed to Probe().
+   * @param emit called with every batch of joined rows, at most TupleBatch::CAPACITY rows each
+   */
+  void FinishProbe(const std::function<void(TupleBatch *)> &emit);
+
+  /** Set the scan of the left side the runtime filter is passed to, nullptr for none. */
+  void SetRuntimeFilterTarget(RuntimeFilterTarget *target) { filter_target_ = target; }
+
+  /** @return the number of partitions spilled to temporary pages */
+  auto GetNumSpilledPartitions() const -> size_t { return num_spilled_; }
+
   /**
    * Yield the next tuple from the join.
    * @param[out] tuple The next tuple produced by the join.
@@ -88,6 +108,13 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The next tuples produced by the join
+   * @return `true` if at least one tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -96,9 +123,94 @@ class HashJoinExecutor : public AbstractExecutor {
   const HashJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_child_;
   std::unique_ptr<AbstractExecutor> right_child_;
-  std::unordered_map<HashJoinKey, std::vector<Tuple>> ht_{};
-  std::vector<Tuple> output_;
-  std::vector<Tuple>::iterator iterator_;
+  /** The head of the matches of a left row of a spilled partition, which is spilled rather than probed */
+  static constexpr uint32_t SPILLED_ROW = JoinHashTable::NO_ROW - 1;
+
+  /** @return the values of the key expressions of a side of the join for every row of a batch, one column each */
+  static auto EvaluateKeys(const std::vector<AbstractExpressionRef> &exprs, const TupleBatch &batch,
+                           const Schema &schema) -> std::vector<std::vector<Value>>;
+
+  /**
+   * Look up the rows of a left batch, spilling the rows of spilled partitions.
+   * @param batch the left rows
+   * @param[out] partitions per row, the partition of its key
+   * @param[out] heads per row, the first matching right row in the table of its partition, JoinHashTable::NO_ROW if
+   * there is none and SPILLED_ROW if the row was spilled
+   */
+  void LookupBatch(const TupleBatch &batch, std::vector<size_t> *partitions, std::vector<uint32_t> *heads);
+
+  /** @return the values of a row of the left side joined with a right tuple, or with nulls if right_tuple is nullptr */
+  auto JoinValues(const TupleBatch &left, size_t row, const TupleView *right_tuple) const -> std::vector<Value>;
+
+  /** Append a row of the left side joined with a right tuple, or with nulls if right_tuple is nullptr. */
+  void AppendJoined(TupleBatch *joined, const TupleBatch &left, size_t row, const TupleView *right_tuple) const;
+
+  /**
+   * Probe the hash table with the left side until a number of joined rows is produced or the left side is exhausted,
+   * pulling left batches as needed. Resumes where the last call stopped, within the matches of a key too.
+   * @param limit the most joined rows to produce
+   * @param emit called with the left batch, the row in it and the right tuple (nullptr for nulls) of every joined row
+   * @return the number of joined rows produced
+   */
+  template <typename Emit>
+  auto ProbeRows(size_t limit, Emit &&emit) -> size_t;
+
+  /** @return the partition of a key hash */
+  static auto PartitionOf(hash_t hash) -> size_t { return hash >> (sizeof(hash_t) * 8 - PARTITION_BITS); }
+
+  /**
+   * Add a right row to the hash table, or to the spill of its partition, spilling partitions to stay in budget.
+   * @param keys the key values of the batch of the row, the values of the row are moved out
+   * @param row the row within the batch
+   * @param tuple the tuple of the row
+   */
+  void Insert(std::vector<std::vector<Value>> *keys, size_t row, const Tuple &tuple);
+
+  /** Move a partition of the hash table to temporary pages. */
+  void SpillPartition(size_t partition);
+
+  /** Empty the hash table and give back its memory. */
+  void ReleaseTable();
+
+  /** @return whether a left row has to be spilled rather than probed, spilling it if so */
+  auto SpillLeftRow(hash_t hash, const TupleBatch &batch, size_t row) -> bool;
+
+  /** @return the next batch of left rows of the spilled partitions, loading the hash table of their partition */
+  auto NextSpilledLeftBatch(TupleBatch *batch) -> bool;
+
+  /** Read up to a batch of tuples from a spill file. @return false if there were none left */
+  static auto ReadSpilled(TmpTupleFile *file, TmpTupleFile::Cursor *cursor, const Schema &schema, TupleBatch *batch)
+      -> bool;
+
+  /** The scan of the left side, and the filter over the right keys built for it */
+  RuntimeFilterTarget *filter_target_{nullptr};
+  std::shared_ptr<RuntimeFilter> runtime_filter_;
+  /** The hash table of each partition, empty for the spilled ones */
+  std::vector<JoinHashTable> tables_;
+  /** Memory reserved for the tuples in the hash table, in total and per partition */
+  size_t reserved_bytes_{0};
+  std::array<size_t, SPILL_PARTITIONS> partition_bytes_{};
+  /** The right and left rows of each spilled partition, nullptr for the partitions held in memory */
+  std::vector<std::unique_ptr<TmpTupleFile>> right_spills_;
+  std::vector<std::unique_ptr<TmpTupleFile>> left_spills_;
+  size_t num_spilled_{0};
+  /** Whether the left side was exhausted and the spilled partitions are being joined */
+  bool probing_spilled_{false};
+  /** The spilled partition being joined, whether its hash table is loaded and how far its left rows were read */
+  size_t spill_partition_{0};
+  bool partition_loaded_{false};
+  TmpTupleFile::Cursor left_cursor_;
+  /** The left batch being probed, and the partition and first matching right row of each of its rows */
+  TupleBatch left_batch_;
+  std::vector<size_t> left_partitions_;
+  std::vector<uint32_t> left_heads_;
+  /** The next row of left_batch_ to look up */
+  size_t left_row_{0};
+  /** Whether the left child is exhausted */
+  bool left_done_{false};
+  /** The table of the right rows matching the row before left_row_, and the next of them to join with it */
+  const JoinHashTable *match_table_{nullptr};
+  uint32_t match_row_{JoinHashTable::NO_ROW};
 };
 
 }  // namespace bustub
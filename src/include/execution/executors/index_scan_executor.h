@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "common/rid.h"
@@ -42,11 +45,24 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Build the index key for a scan bound, the key columns not covered by the bound are padded with min/max values. */
+  auto MakeBoundKey(const std::optional<IndexScanBound> &bound, bool is_lower) const -> std::optional<IntegerKeyType>;
+
+  /** Build an output tuple of an index-only scan from the key columns. */
+  auto KeyToTuple(const IntegerKeyType &key) const -> Tuple;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   IndexInfo *index_info_;
   TableInfo *table_info_;
+  /** Keeps the heap pages the index points to allocated, the scan may not hold a table lock */
+  TableReadGuard read_guard_;
   BPlusTreeIndexForTwoIntegerColumn *tree_;
-  IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType> *iterator_;
+  std::unique_ptr<BPlusTreeIndexIteratorForTwoIntegerColumn> iterator_;
+  /** Matches of a hash index lookup, which are all collected up front. */
+  std::vector<RID> rids_;
+  size_t cursor_{0};
+  /** Whether the heap pages an index-only scan came across hold no deleted tuples, checked once per page */
+  std::unordered_map<page_id_t, bool> all_visible_pages_;
 };
 }  // namespace bustub
@@ -48,7 +48,22 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Pull the next batch of outer tuples, probe the index for all of them at once, and buffer the joined tuples. */
+  void ProbeNextBatch();
+
+  /** Number of outer tuples whose keys are probed together. */
+  static constexpr size_t BATCH_SIZE = 128;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  IndexInfo *index_info_;
+  TableInfo *inner_table_info_;
+  /** Keeps the inner heap pages the index points to allocated, the join may not hold a table lock */
+  TableReadGuard read_guard_;
+  /** Joined tuples of the current batch, and the next one to be emitted */
+  std::vector<Tuple> output_;
+  size_t output_idx_{0};
+  bool child_exhausted_{false};
 };
 }  // namespace bustub
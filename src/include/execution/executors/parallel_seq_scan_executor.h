@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_seq_scan_executor.h
+//
+// Identification: src/include/execution/executors/parallel_seq_scan_executor.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/runtime_filter.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * ParallelSeqScanExecutor scans a large table on several worker threads. The pages of the table are split into
+ * morsels of MORSEL_SIZE pages, which the workers take in page order; every worker reads and filters its morsel on its
+ * own and hands the rows it kept back to Next(). Next() returns the morsels in page order, so the rows come out in
+ * the order a serial scan returns them.
+ *
+ * The workers take no locks, the lock bookkeeping of a transaction is not thread safe. Unless the transaction holds a
+ * lock covering the whole table, the thread calling Next() shared-locks the rows of a morsel before a worker may take
+ * it, and a worker only reads the rows that were locked. The locks are let go of as a serial scan does once the
+ * morsel is gathered: rows that are not returned at once, returned rows as well under read committed. The scan is
+ * only used for plain reads, scans feeding a delete or an update lock the rows they return exclusively and stay
+ * serial.
+ *
+ * A runtime filter added while the workers run applies to the morsels taken after it was added.
+ */
+class ParallelSeqScanExecutor : public AbstractExecutor, public RuntimeFilterTarget {
+ public:
+  /** Number of pages a worker scans at a time */
+  static constexpr size_t MORSEL_SIZE = 16;
+  /** Tables with fewer pages are scanned serially, the workers would not pay for themselves */
+  static constexpr size_t MIN_PAGES = 4 * MORSEL_SIZE;
+  /** Number of morsels per worker that may be scanned ahead of the one Next() is returning */
+  static constexpr size_t LOOKAHEAD = 2;
+
+  /**
+   * Construct a new ParallelSeqScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The sequential scan plan to be executed
+   */
+  ParallelSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+
+  /** Stop the workers of the scan */
+  ~ParallelSeqScanExecutor() override;
+
+  /** @return whether a scan should run in parallel: it only reads, workers are enabled and the table is large */
+  static auto CanRun(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) -> bool;
+
+  /** Initialize the scan and start its workers */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the scan.
+   * @param[out] tuple The next tuple produced by the scan
+   * @param[out] rid The next tuple RID produced by the scan
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the sequential scan */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+  void AddRuntimeFilter(std::shared_ptr<const RuntimeFilter> filter) override;
+
+ private:
+  /** Pages from first_page_id_ up to, but not including, stop_page_id_ */
+  struct Morsel {
+    page_id_t first_page_id_;
+    page_id_t stop_page_id_;
+    /** If the scan locks rows, the rows that were shared-locked before the morsel was handed out */
+    std::unordered_set<RID> rids_;
+    /** The rows of rids_ whose lock this scan took, and lets go of once the morsel is gathered */
+    std::vector<RID> locked_rids_;
+  };
+
+  /** Body of a worker, it scans morsels until there are none left or the scan is stopped. */
+  void RunWorker();
+
+  /** Scan one morsel into the rows it keeps, dropping the rows runtime filters rule out. */
+  void ScanMorsel(const Morsel &morsel, const std::vector<std::shared_ptr<const RuntimeFilter>> &runtime_filters,
+                  std::vector<std::pair<Tuple, RID>> *rows) const;
+
+  /** Lock the rows of the morsels the workers may take next, up to the window ahead of the one being gathered. */
+  void LockMorsels();
+
+  /** Shared-lock the rows of a morsel that the transaction has no lock on yet. */
+  void LockMorsel(Morsel *morsel);
+
+  /** Let go of the locks of a gathered morsel that a serial scan would not hold on to. */
+  void UnlockMorsel(const Morsel &morsel, const std::vector<std::pair<Tuple, RID>> &rows);
+
+  /** Stop the workers and wait for them to exit. */
+  void StopWorkers();
+
+  /** The sequential scan plan node to be executed */
+  const SeqScanPlanNode *plan_;
+  TableInfo *table_info_{nullptr};
+  /** Keeps the pages of the morsels allocated from the moment their ids are collected */
+  TableReadGuard read_guard_;
+  /** Whether the table stores its pages column by column */
+  bool columnar_{false};
+  ScanFilter filter_;
+  /** Whether rows are locked before they are read, false if the table lock covers them or nothing is locked */
+  bool lock_rows_{false};
+  std::vector<Morsel> morsels_;
+  size_t num_workers_{0};
+  std::vector<std::thread> workers_;
+
+  /** Rows of the morsel Next() is returning */
+  std::vector<std::pair<Tuple, RID>> batch_;
+  size_t batch_pos_{0};
+
+  std::mutex latch_;
+  std::condition_variable cv_;
+  /** Rows kept from every morsel, set once the morsel has been scanned */
+  std::vector<std::optional<std::vector<std::pair<Tuple, RID>>>> results_; /* protected by latch_ */
+  /** The next morsel a worker takes */
+  size_t next_morsel_{0}; /* protected by latch_ */
+  /** The morsels before this one have their rows locked and may be taken */
+  size_t locked_morsel_{0}; /* protected by latch_ */
+  /** The morsel Next() is waiting for */
+  size_t gather_morsel_{0}; /* protected by latch_ */
+  bool stop_{false};        /* protected by latch_ */
+  /** The filters of the joins this scan is the probe side of, a worker copies them as it takes a morsel */
+  std::vector<std::shared_ptr<const RuntimeFilter>> runtime_filters_; /* protected by latch_ */
+  /** The first error a worker ran into, rethrown by Next() */
+  std::exception_ptr error_; /* protected by latch_ */
+};
+
+}  // namespace bustub
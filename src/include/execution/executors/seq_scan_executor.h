@@ -17,14 +17,47 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/runtime_filter.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
+/**
+ * The filter of a sequential scan, prepared for the table it reads. It is not changed once built, so the workers of a
+ * parallel scan share it.
+ */
+class ScanFilter {
+ public:
+  ScanFilter() = default;
+
+  /**
+   * @param predicate the filter predicate of the scan, nullptr if every row passes
+   * @param table the scanned table
+   */
+  ScanFilter(const AbstractExpressionRef &predicate, TableHeap *table);
+
+  /** @return false if the zone map of the table rules out every tuple of the page */
+  auto MayMatchPage(page_id_t page_id) const -> bool;
+
+  /** @return whether a tuple passes the filter */
+  auto Matches(const TupleView &view, const Schema &schema) const -> bool;
+
+  /** @return the columns the predicate reads, in column order */
+  auto GetColumns() const -> const std::vector<uint32_t> & { return columns_; }
+
+ private:
+  /** The predicate, with its string constants encoded if the table is dictionary-encoded */
+  AbstractExpressionRef predicate_;
+  std::vector<uint32_t> columns_;
+  /** The value ranges of the pages of the table, nullptr if there is no predicate to check them against */
+  ZoneMap *zone_map_{nullptr};
+};
+
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
  */
-class SeqScanExecutor : public AbstractExecutor {
+class SeqScanExecutor : public AbstractExecutor, public RuntimeFilterTarget {
  public:
   /**
    * Construct a new SeqScanExecutor instance.
@@ -44,13 +77,47 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan, decoded column by column.
+   * @param[out] batch The next tuples produced by the scan
+   * @return `true` if at least one tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
+  void AddRuntimeFilter(std::shared_ptr<const RuntimeFilter> filter) override {
+    runtime_filters_.push_back(std::move(filter));
+  }
+
+  /** @return the number of rows the runtime filters dropped since the scan was initialized */
+  auto GetNumRuntimeFiltered() const -> size_t { return num_runtime_filtered_; }
+
  private:
+  /**
+   * Move the scan over up to limit returned rows, locking them as the isolation level asks.
+   * @param emit called with every returned row while it is latched in its page
+   * @return the number of rows returned
+   */
+  template <typename Emit>
+  auto ScanRows(size_t limit, Emit &&emit) -> size_t;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   std::unique_ptr<TableIterator> iterator_;
   TableInfo *table_info_;
+  /** Keeps the overflow pages of returned tuples allocated after the iterator has reached its end */
+  TableReadGuard read_guard_;
+  /** Whether the table stores its pages column by column */
+  bool columnar_{false};
+  /** Whether a lock of the transaction on the whole table already covers reading its rows */
+  bool rows_covered_{false};
+  ScanFilter filter_;
+  /** The filters of the joins this scan is the probe side of, and the rows they dropped */
+  std::vector<std::shared_ptr<const RuntimeFilter>> runtime_filters_;
+  size_t num_runtime_filtered_{0};
+  /** The last page checked against the zone map */
+  page_id_t zone_page_id_{INVALID_PAGE_ID};
 };
 }  // namespace bustub
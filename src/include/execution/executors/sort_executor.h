@@ -17,6 +17,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/pipeline_breaker.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
 #include "storage/table/tuple.h"
@@ -26,18 +27,28 @@ namespace bustub {
 /**
  * The SortExecutor executor executes a sort.
  */
-class SortExecutor : public AbstractExecutor {
+class SortExecutor : public AbstractExecutor, public PipelineBreaker {
  public:
   /**
    * Construct a new SortExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The sort plan to be executed
+   * @param child_executor The child executor, `nullptr` when a pipeline pushes the input in instead
    */
   SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
 
   /** Initialize the sort */
   void Init() override;
 
+  /** Drop the rows collected so far */
+  void BeginInput() override;
+
+  /** Collect a batch of child rows */
+  void Consume(const TupleBatch &batch) override;
+
+  /** Sort the collected rows and start returning them */
+  void FinishInput() override;
+
   /**
    * Yield the next tuple from the sort.
    * @param[out] tuple The next tuple produced by the sort
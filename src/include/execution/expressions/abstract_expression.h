@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 
@@ -65,6 +66,37 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Returns the value obtained by evaluating a tuple in place, e.g. while it still sits in a latched page.
+   * The result may borrow VARCHAR data from the view, so it must not outlive the view. The default copies the tuple
+   * out, expressions that show up in scan predicates evaluate the view directly.
+   * @param view The viewed tuple
+   * @param schema The schema of the viewed tuple
+   */
+  virtual auto EvaluateView(const TupleView &view, const Schema &schema) const -> Value {
+    auto tuple = view.Materialize();
+    return Evaluate(&tuple, schema);
+  }
+
+  /**
+   * Returns the values obtained by evaluating every row of a batch, one per row. The default evaluates the rows one
+   * at a time, the expressions that show up in filters and projections work on whole columns.
+   * @param batch The rows
+   * @param schema The schema of the rows
+   */
+  virtual auto EvaluateBatch(const TupleBatch &batch, const Schema &schema) const -> std::vector<Value> {
+    std::vector<Value> values;
+    values.reserve(batch.Size());
+    for (size_t row = 0; row < batch.Size(); row++) {
+      auto tuple = batch.GetTuple(row, schema);
+      values.push_back(Evaluate(&tuple, schema));
+    }
+    return values;
+  }
+
+  /** @return the column of the batch the expression reads as is, nullptr if it computes its values */
+  virtual auto GetBatchColumn(const TupleBatch &batch) const -> const std::vector<Value> * { return nullptr; }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
@@ -84,6 +116,20 @@ class AbstractExpression {
   /** The children of this expression. Note that the order of appearance of children may matter. */
   std::vector<AbstractExpressionRef> children_;
 
+ protected:
+  /**
+   * Evaluate a child on a batch. A column of the batch is read in place, other children are evaluated into buffer.
+   * @return the values of the child, one per row
+   */
+  auto EvaluateChildBatch(uint32_t child_idx, const TupleBatch &batch, const Schema &schema,
+                          std::vector<Value> *buffer) const -> const std::vector<Value> & {
+    if (const auto *column = GetChildAt(child_idx)->GetBatchColumn(batch); column != nullptr) {
+      return *column;
+    }
+    *buffer = GetChildAt(child_idx)->EvaluateBatch(batch, schema);
+    return *buffer;
+  }
+
  private:
   /** The return type of this expression. */
   TypeId ret_type_;
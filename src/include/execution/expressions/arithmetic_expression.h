@@ -65,6 +65,31 @@ class ArithmeticExpression : public AbstractExpression {
     return ValueFactory::GetIntegerValue(*res);
   }
 
+  auto EvaluateView(const TupleView &view, const Schema &schema) const -> Value override {
+    Value lhs = GetChildAt(0)->EvaluateView(view, schema);
+    Value rhs = GetChildAt(1)->EvaluateView(view, schema);
+    auto res = PerformComputation(lhs, rhs);
+    if (res == std::nullopt) {
+      return ValueFactory::GetNullValueByType(TypeId::INTEGER);
+    }
+    return ValueFactory::GetIntegerValue(*res);
+  }
+
+  auto EvaluateBatch(const TupleBatch &batch, const Schema &schema) const -> std::vector<Value> override {
+    std::vector<Value> lhs_buffer;
+    std::vector<Value> rhs_buffer;
+    const auto &lhs = EvaluateChildBatch(0, batch, schema, &lhs_buffer);
+    const auto &rhs = EvaluateChildBatch(1, batch, schema, &rhs_buffer);
+    std::vector<Value> values;
+    values.reserve(batch.Size());
+    for (size_t row = 0; row < batch.Size(); row++) {
+      auto res = PerformComputation(lhs[row], rhs[row]);
+      values.push_back(res == std::nullopt ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                           : ValueFactory::GetIntegerValue(*res));
+    }
+    return values;
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), compute_type_, *GetChildAt(1));
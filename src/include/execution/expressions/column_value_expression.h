@@ -45,6 +45,18 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(&right_schema, col_idx_);
   }
 
+  auto EvaluateView(const TupleView &view, const Schema &schema) const -> Value override {
+    return view.GetValue(&schema, col_idx_);
+  }
+
+  auto EvaluateBatch(const TupleBatch &batch, const Schema &schema) const -> std::vector<Value> override {
+    return batch.GetColumn(col_idx_);
+  }
+
+  auto GetBatchColumn(const TupleBatch &batch) const -> const std::vector<Value> * override {
+    return &batch.GetColumn(col_idx_);
+  }
+
   auto GetTupleIdx() const -> uint32_t { return tuple_idx_; }
   auto GetColIdx() const -> uint32_t { return col_idx_; }
 
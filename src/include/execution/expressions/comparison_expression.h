@@ -49,6 +49,25 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  auto EvaluateView(const TupleView &view, const Schema &schema) const -> Value override {
+    Value lhs = GetChildAt(0)->EvaluateView(view, schema);
+    Value rhs = GetChildAt(1)->EvaluateView(view, schema);
+    return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
+  }
+
+  auto EvaluateBatch(const TupleBatch &batch, const Schema &schema) const -> std::vector<Value> override {
+    std::vector<Value> lhs_buffer;
+    std::vector<Value> rhs_buffer;
+    const auto &lhs = EvaluateChildBatch(0, batch, schema, &lhs_buffer);
+    const auto &rhs = EvaluateChildBatch(1, batch, schema, &rhs_buffer);
+    std::vector<Value> values;
+    values.reserve(batch.Size());
+    for (size_t row = 0; row < batch.Size(); row++) {
+      values.push_back(ValueFactory::GetBooleanValue(PerformComparison(lhs[row], rhs[row])));
+    }
+    return values;
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), comp_type_, *GetChildAt(1));
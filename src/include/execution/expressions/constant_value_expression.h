@@ -34,6 +34,12 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  auto EvaluateView(const TupleView &view, const Schema &schema) const -> Value override { return val_; }
+
+  auto EvaluateBatch(const TupleBatch &batch, const Schema &schema) const -> std::vector<Value> override {
+    return std::vector<Value>(batch.Size(), val_);
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
@@ -73,6 +73,23 @@ class StringExpression : public AbstractExpression {
     return ValueFactory::GetVarcharValue(Compute(str));
   }
 
+  auto EvaluateView(const TupleView &view, const Schema &schema) const -> Value override {
+    Value val = GetChildAt(0)->EvaluateView(view, schema);
+    auto str = val.GetAs<char *>();
+    return ValueFactory::GetVarcharValue(Compute(str));
+  }
+
+  auto EvaluateBatch(const TupleBatch &batch, const Schema &schema) const -> std::vector<Value> override {
+    std::vector<Value> buffer;
+    const auto &args = EvaluateChildBatch(0, batch, schema, &buffer);
+    std::vector<Value> values;
+    values.reserve(batch.Size());
+    for (const auto &val : args) {
+      values.push_back(ValueFactory::GetVarcharValue(Compute(val.GetAs<char *>())));
+    }
+    return values;
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override { return fmt::format("{}({})", expr_type_, *GetChildAt(0)); }
 
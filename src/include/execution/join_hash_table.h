@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.h
+//
+// Identification: src/include/execution/join_hash_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * JoinHashTable is the hash table a hash join builds over its build side. It is laid out flat so that a lookup touches
+ * few cache lines and a build row costs no allocation of its own:
+ *
+ * - the rows are numbered in the order they were appended; their tuples are copied back to back into one arena,
+ *   their key values and precomputed hashes are kept in arrays indexed by row;
+ * - the directory is an open addressing table with linear probing, one slot per distinct key holding its hash and the
+ *   first row with that key;
+ * - the rows with the same key are chained through an array of next row indices, in the order they were appended.
+ *
+ * Rows are appended first and the directory is built once all are in, sized for them up front. Both the build and
+ * batched lookups prefetch the slots they are about to touch.
+ *
+ * Keys are compared with CompareEquals(), so a key with a null value matches nothing; such rows need not be added.
+ */
+class JoinHashTable {
+ public:
+  /** The row index that stands for no row, the end of a chain or a key that is not in the table */
+  static constexpr uint32_t NO_ROW = UINT32_MAX;
+
+  /** How many rows ahead the slot of a row is prefetched */
+  static constexpr size_t PREFETCH_DISTANCE = 8;
+
+  /** @param num_keys the number of values a key is made of */
+  explicit JoinHashTable(size_t num_keys) : num_keys_(num_keys) {}
+
+  /**
+   * @return the hash of the key of a row, with its bits mixed well enough to be split into a partition and a slot
+   * @param keys the key values, one column per key expression
+   * @param row the row
+   */
+  static auto HashKey(const std::vector<std::vector<Value>> &keys, size_t row) -> hash_t;
+
+  /** @return whether the key of a row has a null value, and so matches nothing */
+  static auto HasNullKey(const std::vector<std::vector<Value>> &keys, size_t row) -> bool;
+
+  /**
+   * Add a row. The row is not found until Build() is called.
+   * @param hash the hash of its key, from HashKey()
+   * @param keys the key values, one column per key expression, the values of the row are moved out
+   * @param row the row within the key columns
+   * @param tuple the tuple of the row, which must not refer to a dictionary or overflow pages
+   */
+  void Append(hash_t hash, std::vector<std::vector<Value>> *keys, size_t row, const Tuple &tuple);
+
+  /** Build the directory over all the rows appended so far. */
+  void Build();
+
+  /** Drop every row and give back the memory of the table. */
+  void Clear();
+
+  /** Bring the slot a hash starts probing at into the cache. */
+  inline void Prefetch(hash_t hash) const {
+    if (!slots_.empty()) {
+      __builtin_prefetch(&slots_[hash & mask_]);
+    }
+  }
+
+  /**
+   * @return the first row with a key, NO_ROW if there is none
+   * @param hash the hash of the key, from HashKey()
+   * @param keys the key values, one column per key expression
+   * @param row the row of the key within the key columns
+   */
+  auto Find(hash_t hash, const std::vector<std::vector<Value>> &keys, size_t row) const -> uint32_t;
+
+  /**
+   * Look up the keys of a batch of rows, prefetching the slots ahead of the lookups.
+   * @param hashes the hashes of the keys, one per row
+   * @param keys the key values, one column per key expression
+   * @param[out] heads the first row with the key of each row, NO_ROW for keys not in the table
+   */
+  void FindBatch(const std::vector<hash_t> &hashes, const std::vector<std::vector<Value>> &keys,
+                 std::vector<uint32_t> *heads) const;
+
+  /** @return the row after a row in the chain of its key, NO_ROW at the end of the chain */
+  inline auto NextMatch(uint32_t row) const -> uint32_t { return next_[row]; }
+
+  /** @return the tuple of a row, which stays valid until rows are appended or the table is cleared */
+  inline auto GetTuple(uint32_t row) const -> TupleView {
+    return TupleView(arena_.data() + offsets_[row], lengths_[row], RID{});
+  }
+
+  /** @return the hash of the key of a row */
+  inline auto GetHash(uint32_t row) const -> hash_t { return hashes_[row]; }
+
+  /** @return the number of rows appended */
+  inline auto GetNumRows() const -> size_t { return hashes_.size(); }
+
+  /** @return an estimate of the memory a row with a tuple of the given length takes */
+  auto RowBytes(uint32_t length) const -> size_t {
+    // A row takes up to two slots, the directory being at most half full
+    return length + sizeof(hash_t) + 2 * sizeof(uint32_t) + sizeof(size_t) + num_keys_ * sizeof(Value) +
+           2 * sizeof(Slot);
+  }
+
+ private:
+  struct Slot {
+    hash_t hash_;
+    uint32_t head_;
+  };
+
+  /** @return whether the keys of two rows of the table are equal */
+  auto RowKeysEqual(uint32_t left, uint32_t right) const -> bool;
+
+  /** @return whether the key of a row of the table equals the key of a row of the key columns */
+  auto KeyEquals(uint32_t row, const std::vector<std::vector<Value>> &keys, size_t key_row) const -> bool;
+
+  /** Put a row at the head of the chain of its key, taking a slot if the key is new. */
+  void InsertIntoDirectory(uint32_t row);
+
+  size_t num_keys_;
+  /** Per row: the hash of its key, the next row with its key, and where in the arena its tuple is */
+  std::vector<hash_t> hashes_;
+  std::vector<uint32_t> next_;
+  std::vector<size_t> offsets_;
+  std::vector<uint32_t> lengths_;
+  /** The key values of the rows, num_keys_ per row */
+  std::vector<Value> keys_;
+  /** The serialized tuples of the rows */
+  std::vector<char> arena_;
+  /** The directory, a power of two slots, empty ones having head_ NO_ROW */
+  std::vector<Slot> slots_;
+  size_t mask_{0};
+};
+
+}  // namespace bustub
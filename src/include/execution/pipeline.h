@@ -0,0 +1,224 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline.h
+//
+// Identification: src/include/execution/pipeline.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution/pipeline_breaker.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * PipelineOperator is a streaming step of a pipeline. It is pushed one batch at a time and hands on the batches it
+ * makes of it right away, without holding on to any input.
+ */
+class PipelineOperator {
+ public:
+  virtual ~PipelineOperator() = default;
+
+  /**
+   * Process a batch.
+   * @param batch the input rows, the operator may change them in place
+   * @param emit called with every batch the operator makes of the input
+   */
+  virtual void Execute(TupleBatch *batch, const std::function<void(TupleBatch *)> &emit) = 0;
+
+  /**
+   * Hand on what the operator held back, once the source of the pipeline is exhausted.
+   * @param emit called with every batch the operator still has
+   */
+  virtual void Finish(const std::function<void(TupleBatch *)> &emit) {}
+
+  /** @return whether batches may be pushed through the operator from several threads at once */
+  virtual auto IsThreadSafe() const -> bool { return true; }
+};
+
+/** FilterOperator keeps the rows of a batch its predicate is true for. */
+class FilterOperator : public PipelineOperator {
+ public:
+  explicit FilterOperator(const FilterPlanNode *plan) : plan_(plan) {}
+
+  void Execute(TupleBatch *batch, const std::function<void(TupleBatch *)> &emit) override;
+
+ private:
+  const FilterPlanNode *plan_;
+};
+
+/** ProjectionOperator computes the columns of its expressions over a batch. */
+class ProjectionOperator : public PipelineOperator {
+ public:
+  explicit ProjectionOperator(const ProjectionPlanNode *plan) : plan_(plan) {}
+
+  void Execute(TupleBatch *batch, const std::function<void(TupleBatch *)> &emit) override;
+
+ private:
+  const ProjectionPlanNode *plan_;
+};
+
+/**
+ * HashJoinProbeOperator joins a batch of left side rows with the hash table of a join. The rows of spilled partitions
+ * are joined when the pipeline finishes. Probing only reads the hash table, unless left rows are spilled.
+ */
+class HashJoinProbeOperator : public PipelineOperator {
+ public:
+  explicit HashJoinProbeOperator(HashJoinExecutor *join) : join_(join) {}
+
+  void Execute(TupleBatch *batch, const std::function<void(TupleBatch *)> &emit) override {
+    join_->Probe(*batch, emit);
+  }
+
+  void Finish(const std::function<void(TupleBatch *)> &emit) override { join_->FinishProbe(emit); }
+
+  auto IsThreadSafe() const -> bool override { return join_->GetNumSpilledPartitions() == 0; }
+
+ private:
+  HashJoinExecutor *join_;
+};
+
+/** ResultSink collects the rows that reach the end of the query into the result set. */
+class ResultSink : public PipelineBreaker {
+ public:
+  /**
+   * @param schema the output schema of the query
+   * @param result_set where the rows are collected, `nullptr` to drop them
+   */
+  ResultSink(const Schema &schema, std::vector<Tuple> *result_set) : schema_(schema), result_set_(result_set) {}
+
+  void BeginInput() override {}
+
+  void Consume(const TupleBatch &batch) override;
+
+  void FinishInput() override {}
+
+ private:
+  const Schema &schema_;
+  std::vector<Tuple> *result_set_;
+};
+
+/**
+ * A Pipeline is a run of a plan that needs no materialization: a source executor, the streaming operators above it
+ * and the pipeline breaker they end in. Running it is one tight loop that pulls a batch from the source and pushes it
+ * through every operator into the sink, so a batch is worked on while it is still in the cache.
+ *
+ * A pipeline may be given several workers, e.g. to probe a hash join. Each worker then pulls the next batch, a morsel,
+ * from the source in turn and pushes it through the operators on its own thread; what the operators make of the
+ * morsels is handed to the sink in the order the morsels were pulled, so the sink sees the rows of a serial run.
+ */
+class Pipeline {
+ public:
+  /** @param sink the pipeline breaker the pipeline ends in */
+  explicit Pipeline(PipelineBreaker *sink) : sink_(sink) {}
+
+  /** Set the executor batches are pulled from, it must be initialized before the pipeline runs. */
+  void SetSource(AbstractExecutor *source) { source_ = source; }
+
+  /** Add an operator on top of the ones added so far. */
+  void AddOperator(std::unique_ptr<PipelineOperator> op) { operators_.push_back(std::move(op)); }
+
+  /** Set the number of threads the operators run on, if they are all thread safe when the pipeline runs. */
+  void SetNumWorkers(size_t num_workers) { num_workers_ = num_workers; }
+
+  /** Add a pipeline that has to finish before this one may start, e.g. the build of a hash join it probes. */
+  void AddDependency(Pipeline *pipeline) { dependencies_.push_back(pipeline); }
+
+  /** @return the pipelines that have to finish before this one may start */
+  auto GetDependencies() const -> const std::vector<Pipeline *> & { return dependencies_; }
+
+  /** Push all the rows of the source into the sink. */
+  void Run();
+
+ private:
+  /** Push a batch through the operators from the given one on, handing what comes out of the last one to consume. */
+  void Push(size_t op_idx, TupleBatch *batch, const std::function<void(const TupleBatch &)> &consume);
+
+  /** Push the batches of the source through the operators on several threads. */
+  void RunParallel(size_t num_workers);
+
+  AbstractExecutor *source_{nullptr};
+  std::vector<std::unique_ptr<PipelineOperator>> operators_;
+  PipelineBreaker *sink_;
+  std::vector<Pipeline *> dependencies_;
+  size_t num_workers_{1};
+};
+
+/**
+ * PipelineGraph executes a plan as pipelines. The plan is split at its pipeline breakers: a hash join builds its
+ * table from a pipeline of its own and is probed in the pipeline of its left side, an aggregation and a sort end the
+ * pipeline of their child and start the one of their parent. Filters and projections are operators in the pipeline
+ * they are in. Any other plan node is pulled from as before, its executor being the source of a pipeline.
+ *
+ * The pipelines are tasks that may run once the ones they depend on are done. The pipelines of a query that only
+ * reads run on up to `pipeline_workers` threads at once if its scans take no row locks, which the transaction could
+ * not keep track of from several threads: under read uncommitted, or when the transaction holds a lock covering each
+ * scanned table. With `pipeline_table_locks` set, a query under repeatable read shared-locks the tables it scans to
+ * get there. Any other query runs its pipelines one after another on the calling thread, its scans locking rows.
+ */
+class PipelineGraph {
+ public:
+  /**
+   * Split a plan into pipelines.
+   * @param exec_ctx the executor context of the query
+   * @param plan the plan of the query
+   * @param result_set where the rows of the query are collected, may be `nullptr`
+   */
+  PipelineGraph(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan, std::vector<Tuple> *result_set);
+
+  /**
+   * Decide whether the pipelines run concurrently, taking the table locks that needs if `pipeline_table_locks` allows
+   * it, and initialize the source executors.
+   */
+  void Init();
+
+  /** Run every pipeline, rethrowing the first exception any of them threw. */
+  void Run();
+
+  /** @return the pipelines, each after the ones it depends on */
+  auto GetPipelines() const -> const std::vector<std::unique_ptr<Pipeline>> & { return pipelines_; }
+
+  /** @return whether the pipelines run on several threads */
+  auto IsConcurrent() const -> bool { return concurrent_; }
+
+ private:
+  /** Build the pipeline that computes a plan and ends in a sink, after the pipelines it depends on. */
+  auto AddPipeline(const AbstractPlanNodeRef &plan, PipelineBreaker *sink) -> Pipeline *;
+
+  /** Add the nodes of a plan to a pipeline, starting new pipelines at the breakers. */
+  void Build(const AbstractPlanNodeRef &plan, Pipeline *pipeline);
+
+  /** @return whether a plan only reads, collecting the tables it scans */
+  auto IsReadOnly(const AbstractPlanNodeRef &plan) -> bool;
+
+  void RunConcurrently(size_t num_workers);
+
+  ExecutorContext *exec_ctx_;
+  ResultSink result_sink_;
+  std::vector<std::unique_ptr<AbstractExecutor>> executors_;
+  /** The executors pipelines pull from, they are initialized by Init() */
+  std::vector<AbstractExecutor *> sources_;
+  std::vector<std::unique_ptr<Pipeline>> pipelines_;
+  std::vector<table_oid_t> scanned_tables_;
+  bool concurrent_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_breaker.h
+//
+// Identification: src/include/execution/pipeline_breaker.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * PipelineBreaker is the input side of an operator that has to see all of its input before producing output, e.g. an
+ * aggregation, a sort or the build side of a hash join. Pulled from by its parent, such an executor reads its child
+ * through this interface in Init(); run in a pipeline, the pipeline that ends at it pushes the batches in instead.
+ */
+class PipelineBreaker {
+ public:
+  virtual ~PipelineBreaker() = default;
+
+  /** Drop any input consumed so far. */
+  virtual void BeginInput() = 0;
+
+  /**
+   * Consume a batch of input.
+   * @param batch the input rows, in the output schema of the child plan
+   */
+  virtual void Consume(const TupleBatch &batch) = 0;
+
+  /** All input has been consumed, the output can be produced. */
+  virtual void FinishInput() = 0;
+};
+
+}  // namespace bustub
@@ -12,14 +12,31 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "fmt/ranges.h"
+#include "type/value.h"
 
 namespace bustub {
+
+/** IndexScanDirection is the order in which an index scan walks the leaf chain. */
+enum class IndexScanDirection : uint8_t { FORWARD, BACKWARD };
+
+/**
+ * IndexScanBound is one end of a range index scan. `key_` holds values for a prefix of the index key columns, the
+ * remaining key columns are unconstrained.
+ */
+struct IndexScanBound {
+  std::vector<Value> key_;
+  bool inclusive_;
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  */
@@ -28,26 +45,86 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /**
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
-   * @param table_oid the identifier of table to be scanned
+   * @param index_oid the identifier of the index to be scanned
+   * @param lower the smallest key to be scanned, std::nullopt to start from the smallest key of the index
+   * @param upper the largest key to be scanned, std::nullopt to stop at the largest key of the index
+   * @param direction whether the keys are produced in ascending or descending order
+   * @param index_only whether the output tuples are built from the index keys alone, in which case `output` holds
+   * exactly the key columns
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::optional<IndexScanBound> lower = std::nullopt,
+                    std::optional<IndexScanBound> upper = std::nullopt,
+                    IndexScanDirection direction = IndexScanDirection::FORWARD, bool index_only = false)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        lower_(std::move(lower)),
+        upper_(std::move(upper)),
+        direction_(direction),
+        index_only_(index_only) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return the lower bound of the scan */
+  auto GetLowerBound() const -> const std::optional<IndexScanBound> & { return lower_; }
+
+  /** @return the upper bound of the scan */
+  auto GetUpperBound() const -> const std::optional<IndexScanBound> & { return upper_; }
+
+  /** @return the direction of the scan */
+  auto GetDirection() const -> IndexScanDirection { return direction_; }
+
+  /** @return whether the scan is answered from the index keys without reading the table tuples */
+  auto IsIndexOnly() const -> bool { return index_only_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The key range of the scan, an empty bound leaves that side of the range open */
+  std::optional<IndexScanBound> lower_;
+  std::optional<IndexScanBound> upper_;
+
+  /** The order in which the keys are produced */
+  IndexScanDirection direction_;
+
+  /** Whether the output tuples are built from the index keys */
+  bool index_only_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string extra;
+    if (lower_ != std::nullopt || upper_ != std::nullopt) {
+      extra += fmt::format(", range={}{}, {}{}", lower_ == std::nullopt || lower_->inclusive_ ? "[" : "(",
+                           BoundToString(lower_, "-inf"), BoundToString(upper_, "+inf"),
+                           upper_ == std::nullopt || upper_->inclusive_ ? "]" : ")");
+    }
+    if (direction_ == IndexScanDirection::BACKWARD) {
+      extra += ", direction=backward";
+    }
+    if (index_only_) {
+      extra += ", index_only=true";
+    }
+    return fmt::format("IndexScan {{ index_oid={}{} }}", index_oid_, extra);
+  }
+
+ private:
+  static auto BoundToString(const std::optional<IndexScanBound> &bound, const char *unbounded) -> std::string {
+    if (bound == std::nullopt) {
+      return unbounded;
+    }
+    std::vector<std::string> values;
+    values.reserve(bound->key_.size());
+    for (const auto &value : bound->key_) {
+      values.push_back(value.ToString());
+    }
+    if (values.size() == 1) {
+      return values[0];
+    }
+    return fmt::format("({})", fmt::join(values, ", "));
   }
 };
 
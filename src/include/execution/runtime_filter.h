@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// runtime_filter.h
+//
+// Identification: src/include/execution/runtime_filter.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/util/hash_util.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * RuntimeFilter is what the build side of an inner hash join knows about its keys, handed to the scan of the probe
+ * side so that rows without a match are dropped as they are read instead of being looked up in the hash table.
+ *
+ * It is a Bloom filter over the hashes of the build keys, with the range of each key that is not a string. A probe
+ * row passes if its key may be in the filter: it has no null value, each value lies in its range and the bits of its
+ * hash are set. Ranges of keys that are plain columns also rule out whole pages by their zone map.
+ *
+ * Keys are added while the build side is read, the filter is built once they are all in and is not changed after
+ * that, so the workers of a parallel scan share it.
+ */
+class RuntimeFilter {
+ public:
+  /** Number of bits of a key set in the filter, all in the same 64 bit word */
+  static constexpr size_t NUM_HASH_BITS = 3;
+  /** Bits of the filter per build key */
+  static constexpr size_t BITS_PER_KEY = 12;
+
+  /** @param probe_keys the key expressions of the join, evaluated against the rows of the probe side */
+  explicit RuntimeFilter(std::vector<AbstractExpressionRef> probe_keys);
+
+  /**
+   * Add the key of a build row.
+   * @param hash the hash of the key, from JoinHashTable::HashKey()
+   * @param keys the key values, one column per key expression
+   * @param row the row within the key columns
+   */
+  void AddKey(hash_t hash, const std::vector<std::vector<Value>> &keys, size_t row);
+
+  /** Build the Bloom filter over the keys added. */
+  void Build();
+
+  /** @return false if no build key equals the key of a probe row */
+  auto MayMatch(const TupleView &view, const Schema &schema) const -> bool;
+
+  /** @return false if the zone of a page rules out every key of the probe rows on it */
+  auto MayMatchPage(ZoneMap *zone_map, page_id_t page_id) const -> bool;
+
+ private:
+  /** @return the bits of a hash in the word it falls into */
+  static inline auto HashBits(hash_t hash) -> uint64_t {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < NUM_HASH_BITS; i++) {
+      bits |= uint64_t{1} << ((hash >> (6 * i)) & 63);
+    }
+    return bits;
+  }
+
+  std::vector<AbstractExpressionRef> probe_keys_;
+  /** The hashes of the keys added, dropped once the filter is built */
+  std::vector<hash_t> hashes_;
+  /** The Bloom filter, a power of two words */
+  std::vector<uint64_t> words_;
+  size_t word_mask_{0};
+  /** Per key, whether its range is kept, and the smallest and largest value added */
+  std::vector<bool> ranged_;
+  std::vector<Value> min_;
+  std::vector<Value> max_;
+  /** Whether a key was added, there is nothing to match otherwise */
+  bool has_keys_{false};
+};
+
+/**
+ * RuntimeFilterTarget is implemented by the scans a hash join can push the runtime filter of its build side into.
+ */
+class RuntimeFilterTarget {
+ public:
+  virtual ~RuntimeFilterTarget() = default;
+
+  /** Drop the rows a filter rules out from now on. The filters are forgotten when the scan is initialized again. */
+  virtual void AddRuntimeFilter(std::shared_ptr<const RuntimeFilter> filter) = 0;
+};
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch holds a batch of rows column by column, one vector of values per column of the schema the rows follow.
+ * Executors pass batches to each other through AbstractExecutor::NextBatch(), so an operator works on a whole column
+ * at a time instead of making a virtual call and a tuple copy per row.
+ *
+ * The values own their data, a batch stays valid after the executor that produced it moves on.
+ */
+class TupleBatch {
+ public:
+  /** Number of rows a producer puts in a batch before handing it over */
+  static constexpr size_t CAPACITY = 2048;
+
+  TupleBatch() = default;
+
+  /**
+   * Empty the batch and shape it for rows of a schema.
+   * @param schema the schema of the rows the batch will hold
+   */
+  void Reset(const Schema &schema);
+
+  /** @return the number of rows in the batch */
+  inline auto Size() const -> size_t { return rids_.size(); }
+
+  /** @return whether the batch holds no rows */
+  inline auto IsEmpty() const -> bool { return rids_.empty(); }
+
+  /** @return whether the batch holds CAPACITY rows or more */
+  inline auto IsFull() const -> bool { return rids_.size() >= CAPACITY; }
+
+  /** @return the number of columns of the rows */
+  inline auto GetColumnCount() const -> uint32_t { return static_cast<uint32_t>(columns_.size()); }
+
+  /** @return the values of a column, one per row */
+  inline auto GetColumn(uint32_t col_idx) const -> const std::vector<Value> & { return columns_[col_idx]; }
+
+  /** @return the RID of a row */
+  inline auto GetRID(size_t row) const -> RID { return rids_[row]; }
+
+  /**
+   * Append a row, split into its columns.
+   * @param tuple the row
+   * @param schema the schema of the row, the one the batch was reset to
+   * @param rid the RID of the row
+   */
+  void Append(const Tuple &tuple, const Schema &schema, RID rid);
+
+  /**
+   * Append a row read in place, copying its values out of the viewed buffer.
+   * @param view the row
+   * @param schema the schema of the row, the one the batch was reset to
+   * @param rid the RID of the row
+   */
+  void Append(const TupleView &view, const Schema &schema, RID rid);
+
+  /**
+   * Append a row given as one value per column.
+   * @param values the values of the row
+   * @param rid the RID of the row
+   */
+  void Append(std::vector<Value> values, RID rid);
+
+  /**
+   * Replace the values of a column. Used by producers that compute a whole column at once, every column of the
+   * batch must end up with one value per RID given to SetRIDs().
+   * @param col_idx the column
+   * @param values the values of the column, one per row
+   */
+  inline void SetColumn(uint32_t col_idx, std::vector<Value> values) { columns_[col_idx] = std::move(values); }
+
+  /** Replace the RIDs of the rows, and with them the number of rows of the batch. */
+  inline void SetRIDs(std::vector<RID> rids) { rids_ = std::move(rids); }
+
+  /** @return the RIDs of the rows */
+  inline auto GetRIDs() const -> const std::vector<RID> & { return rids_; }
+
+  /**
+   * Keep only the rows a predicate is true for, in their order.
+   * @param predicate one boolean value per row, a null value drops the row
+   */
+  void Select(const std::vector<Value> &predicate);
+
+  /**
+   * @return a row of the batch as a tuple
+   * @param row the row
+   * @param schema the schema of the row, the one the batch was reset to
+   */
+  auto GetTuple(size_t row, const Schema &schema) const -> Tuple;
+
+ private:
+  std::vector<std::vector<Value>> columns_;
+  std::vector<RID> rids_;
+};
+
+}  // namespace bustub
@@ -83,6 +83,18 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize filter + seq scan as a range-bounded index scan. Equality terms on the leading index columns
+   * form a key prefix, and range terms on the next column bound the scan. The filter is kept to evaluate the rest.
+   */
+  auto OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief optimize an index scan below a projection or aggregation as an index-only scan when every column referenced
+   * above the scan is part of the index key, so the output tuples are built from the keys without reading the table.
+   */
+  auto OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /** @brief check if the index can be matched */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
@@ -93,14 +105,24 @@ class Optimizer {
   auto OptimizeSortLimitAsTopN(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
   /**
-   * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. BusTub
-   * doesn't support statistics for now, so it's the only way for you to get the table size :(
+   * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. Mock
+   * tables are sized by their name suffix, real tables by the entry count of one of their B+ tree indexes, if that
+   * index has fresh cached statistics.
    *
    * @param table_name
    * @return std::optional<size_t>
    */
   auto EstimatedCardinality(const std::string &table_name) -> std::optional<size_t>;
 
+  /**
+   * @brief estimate the pages a full scan of an index touches: one descent plus every leaf. Sparse trees left behind
+   * by deletes cost more than packed ones with the same entries. A hash index only ever probes a single bucket.
+   *
+   * @param index_oid
+   * @return std::optional<size_t>, nullopt if the index has no fresh cached statistics
+   */
+  auto EstimatedIndexScanCost(index_oid_t index_oid) -> std::optional<size_t>;
+
   /** Catalog will be used during the planning process. USERS SHOULD ENSURE IT OUTLIVES
    * OPTIMIZER, otherwise it's a dangling reference.
    */
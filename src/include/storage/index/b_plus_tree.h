@@ -11,6 +11,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <deque>
 #include <iostream>
 #include <optional>
@@ -61,6 +62,31 @@ class Context {
   ~Context();
 };
 
+/**
+ * Structural statistics of a B+ tree, collected by BPlusTree::CollectStats.
+ * Fill factors are relative to the number of entries a page holds before it splits.
+ */
+struct BPlusTreeStats {
+  static constexpr size_t FILL_BUCKETS = 10;
+
+  // number of levels, 0 for an empty tree
+  int height_{0};
+  size_t num_internal_pages_{0};
+  size_t num_leaf_pages_{0};
+  size_t num_entries_{0};
+  double avg_leaf_fill_{0};
+  double avg_internal_fill_{0};
+  // leaf_fill_histogram_[i] counts the leaves that are between i and i + 1 tenths full
+  std::array<size_t, FILL_BUCKETS> leaf_fill_histogram_{};
+  // leaves below the minimum size, which Remove normally merges away
+  size_t num_underfull_leaves_{0};
+  // neighbouring leaves whose page ids are not consecutive, each one is a seek for a range scan on disk
+  size_t num_leaf_discontinuities_{0};
+
+  /** @return the share of leaf space that a bulk loaded tree would not waste, between 0 and 1 */
+  auto Fragmentation() const -> double { return num_leaf_pages_ == 0 ? 0 : 1 - avg_leaf_fill_; }
+};
+
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
 // Main class providing the API for the Interactive B+ Tree.
@@ -96,6 +122,10 @@ class BPlusTree {
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
+  // Return the values associated with a batch of keys sorted in ascending order, results[i] belongs to keys[i]
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *txn = nullptr);
+
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
@@ -110,6 +140,17 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Backward index iterator, starting from the largest key or from the last key <= key
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+
+  // Walk the whole tree and report its shape, page fill and fragmentation
+  auto CollectStats() -> BPlusTreeStats;
+
+  // Replace the tree with a bulk loaded copy holding the same entries in packed, consecutive pages
+  void Rebuild();
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -146,6 +187,8 @@ class BPlusTree {
   void PrintTree(page_id_t page_id, const BPlusTreePage *page);
   // return the leaf page of key
   auto GetKeyAt(const KeyType &key, const KeyComparator &comparator, Context &ctx) -> page_id_t;
+  // Read latch the leaf holding key, or the leftmost (rightmost) leaf without a key. nullopt if the tree is empty.
+  auto FindLeafRead(const std::optional<KeyType> &key, bool rightmost = false) -> std::optional<ReadPageGuard>;
   /**
    * @brief Convert A B+ tree into a Printable B+ tree
    *
@@ -162,6 +205,8 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  // pages a rebuild unlinked while an open iterator still pinned them, guarded by the header page latch
+  std::vector<page_id_t> retired_pages_;
 };
 
 /**
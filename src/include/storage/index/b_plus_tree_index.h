@@ -11,8 +11,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -35,17 +38,56 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Sorts the keys and looks them up with one pass over the leaf chain, see BPlusTree::GetValues */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  auto GetReverseBeginIterator() -> INDEXITERATOR_TYPE;
+
+  auto GetReverseBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
+
+  /**
+   * Iterator over the keys between lower and upper, a missing bound leaves that side of the range open.
+   * A reverse iterator starts from the upper bound and walks the leaf prev-links down to the lower bound.
+   */
+  auto GetRangeIterator(const std::optional<KeyType> &lower, bool lower_inclusive, const std::optional<KeyType> &upper,
+                        bool upper_inclusive, bool reverse = false) -> INDEXITERATOR_TYPE;
+
+  /** Walk the tree now and refresh the cached statistics */
+  auto CollectStats() -> BPlusTreeStats;
+
+  /**
+   * Statistics for the cost model. Never walks the tree: the copy CollectStats() cached is returned until the number
+   * of inserts and deletes since it was collected exceeds STATS_STALE_RATIO of the entries it saw, std::nullopt after
+   * that or if none was collected. SHOW index_stats and REINDEX collect them again.
+   */
+  auto GetCachedStats() -> std::optional<BPlusTreeStats>;
+
+  /** @return true if Remove has left the leaves too sparse, see REBUILD_FILL_THRESHOLD */
+  auto NeedsRebuild() -> bool;
+
+  /** Rebuild the tree by bulk loading its entries into packed pages, and collect its statistics again */
+  void Rebuild();
+
+  static constexpr double STATS_STALE_RATIO = 0.1;
+  // a tree filled by sequential inserts sits around half full, only rebuild trees that are clearly worse
+  static constexpr double REBUILD_FILL_THRESHOLD = 0.4;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
   // container
   std::shared_ptr<BPlusTree<KeyType, ValueType, KeyComparator>> container_;
+  // inserts and deletes since stats_ was collected
+  std::atomic<size_t> modifications_{0};
+  std::mutex stats_mutex_;
+  std::optional<BPlusTreeStats> stats_;
 };
 
 /** We only support index table with one integer key for now in BusTub. Hardcode everything here. */
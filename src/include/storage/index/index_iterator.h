@@ -13,36 +13,85 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * The iterator copies the entries of one leaf at a time into a local buffer and releases the leaf latch right away,
+ * so a slow consumer never blocks writers. Only a pin is kept on the copied leaf, which keeps the page (and its
+ * version) in memory even if a merge frees it.
+ *
+ * Moving on to the sibling re-latches the copied leaf: if its version is unchanged the sibling link is still valid and
+ * the sibling is try-latched while the leaf is held. Otherwise, or if the sibling is busy, the iterator descends the
+ * tree again from the last key it returned.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
-  IndexIterator(BufferPoolManager *bpm, const B_PLUS_TREE_LEAF_PAGE_TYPE *page, int index, BasicPageGuard page_guard);
+  /**
+   * Start at entry `index` of a read latched leaf. An index past either end of the leaf starts at the neighbouring
+   * leaf in the iteration direction.
+   */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                const KeyComparator &comparator, ReadPageGuard leaf_guard, int index, bool reverse = false);
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
+  // step to the next entry, walking the prev-links instead when this is a backward iterator
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { return (itr).page_ == page_ && (itr).index_ == index_; }
+  /**
+   * Stop the iteration once the current key passes stop_key in the iteration direction.
+   * Checked immediately, so an iterator that already sits past the stop key becomes End().
+   */
+  void SetStopKey(const KeyType &stop_key, bool inclusive, const KeyComparator &comparator);
+
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return itr.page_id_ == page_id_ && itr.index_ == index_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { return !((itr).page_ == page_ && (itr).index_ == index_); }
-  BasicPageGuard page_guard_;
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
-  const B_PLUS_TREE_LEAF_PAGE_TYPE *page_{nullptr};
-  int index_{INVALID_PAGE_ID};
+  // copy the latched leaf into the buffer, keep a pin on it, release the latch and prefetch the sibling
+  void Load(ReadPageGuard leaf_guard);
+  // move to the first entry of the neighbouring leaf in the iteration direction
+  void NextLeaf();
+  // descend the tree again and continue right after (or before, backwards) the given key
+  void Reseek(const KeyType &last_key);
+  void SetEnd();
+  // turn into End() if the current key is past the stop key
+  void CheckStopKey();
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
   BufferPoolManager *bpm_{nullptr};
+  bool reverse_{false};
+  // the copied leaf, pinned but not latched
+  BasicPageGuard pin_;
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint32_t version_{0};
+  std::vector<MappingType> buffer_;
+  int index_{-1};
+  std::optional<KeyType> stop_key_{std::nullopt};
+  bool stop_inclusive_{true};
+  std::optional<KeyComparator> comparator_{std::nullopt};
 };
 
 }  // namespace bustub
@@ -71,11 +71,14 @@ class HashTableBlockPage {
   auto Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool;
 
   /**
-   * Removes a key and value at index.
+   * Removes a key and value at index. The slot stays occupied as a tombstone.
+   * The remove is thread safe: of several threads removing the same index,
+   * exactly one sees the pair go away.
    *
    * @param bucket_ind ind to remove the value
+   * @return true if this call removed the pair, false if the index was not readable
    */
-  void Remove(slot_offset_t bucket_ind);
+  auto Remove(slot_offset_t bucket_ind) -> bool;
 
   /**
    * Returns whether or not an index is occupied (key/value pair or tombstone)
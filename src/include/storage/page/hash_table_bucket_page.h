@@ -30,8 +30,13 @@ namespace bustub {
  *  ----------------------------------------------------------------
  *
  *  Here '+' means concatenation.
- *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  The above format omits the space required for the occupied_,
+ *  readable_ and fingerprints_ arrays. More information is in
+ *  storage/page/hash_table_page_defs.h.
+ *
+ *  Every slot keeps a one byte fingerprint of its key's hash. Probes compare
+ *  the fingerprints of a whole group of slots at once and only call the key
+ *  comparator on the slots whose fingerprint matches.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -40,12 +45,21 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * Derive the fingerprint of a key from its hash. The high bits are used, the directory indexes by the low ones.
+   *
+   * @param hash the hash of the key
+   * @return the fingerprint to store and probe with
+   */
+  static auto Fingerprint(uint32_t hash) -> uint8_t { return static_cast<uint8_t>(hash >> 24); }
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
+   * @param fingerprint the fingerprint of the key
    * @return true if at least one key matched
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result, uint8_t fingerprint) const -> bool;
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -53,16 +67,18 @@ class HashTableBucketPage {
    *
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint the fingerprint of the key
    * @return true if inserted, false if duplicate KV pair or bucket is full
    */
-  auto Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) -> bool;
 
   /**
    * Removes a key and value.
    *
+   * @param fingerprint the fingerprint of the key
    * @return true if removed, false if not found
    */
-  auto Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) -> bool;
 
   /**
    * Gets the key at an index in the bucket.
@@ -80,6 +96,14 @@ class HashTableBucketPage {
    */
   auto ValueAt(uint32_t bucket_idx) const -> ValueType;
 
+  /**
+   * Gets the fingerprint at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the fingerprint at
+   * @return fingerprint at index bucket_idx of the bucket
+   */
+  auto FingerprintAt(uint32_t bucket_idx) const -> uint8_t;
+
   /**
    * Remove the KV pair at bucket_idx
    */
@@ -120,17 +144,17 @@ class HashTableBucketPage {
   /**
    * @return the number of readable elements, i.e. current size
    */
-  auto NumReadable() -> uint32_t;
+  auto NumReadable() const -> uint32_t;
 
   /**
    * @return whether the bucket is full
    */
-  auto IsFull() -> bool;
+  auto IsFull() const -> bool;
 
   /**
    * @return whether the bucket is empty
    */
-  auto IsEmpty() -> bool;
+  auto IsEmpty() const -> bool;
 
   /**
    * Prints the bucket's occupancy information
@@ -138,10 +162,24 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /** Number of slots whose fingerprints are compared at once. */
+  static constexpr uint32_t PROBE_GROUP_SIZE = 16;
+
+  /**
+   * Find the readable slots in [group_start, group_start + PROBE_GROUP_SIZE) whose fingerprint matches.
+   *
+   * @param group_start first slot of the group, a multiple of PROBE_GROUP_SIZE
+   * @param fingerprint the fingerprint to look for
+   * @return a mask with bit i set if slot group_start + i is a candidate
+   */
+  auto MatchFingerprints(uint32_t group_start, uint8_t fingerprint) const -> uint32_t;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // One byte of the hash of the key in each slot.
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_page.h
+//
+// Identification: src/include/storage/page/overflow_page.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "common/config.h"
+
+namespace bustub {
+
+static constexpr uint64_t OVERFLOW_PAGE_HEADER_SIZE = 8;
+static constexpr uint64_t OVERFLOW_PAGE_CAPACITY = BUSTUB_PAGE_SIZE - OVERFLOW_PAGE_HEADER_SIZE;
+
+/**
+ * An overflow page holds one piece of a varlen value that was moved out of its tuple. The pieces of a value form a
+ * chain in value order, the tuple only keeps the id of the first page.
+ *
+ * Header format (size in bytes):
+ *  ----------------------------------------------
+ *  | NextPageId (4) | Size (4) | ... DATA ... |
+ *  ----------------------------------------------
+ */
+class OverflowPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  OverflowPage() = delete;
+  OverflowPage(const OverflowPage &other) = delete;
+
+  /**
+   * Fill the page with a piece of a value.
+   * @param next_page_id the page holding the next piece, INVALID_PAGE_ID for the last one
+   * @param data the piece
+   * @param size the size of the piece, at most OVERFLOW_PAGE_CAPACITY
+   */
+  void Init(page_id_t next_page_id, const char *data, uint32_t size) {
+    next_page_id_ = next_page_id;
+    size_ = size;
+    memcpy(data_, data, size);
+  }
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+  auto GetSize() const -> uint32_t { return size_; }
+
+  auto GetData() const -> const char * { return data_; }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t size_;
+  char data_[0];
+};
+
+static_assert(sizeof(OverflowPage) == OVERFLOW_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 #include <optional>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/rid.h"
@@ -27,7 +29,7 @@
 
 namespace bustub {
 
-static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
+static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 12;
 
 /**
  * Slotted page format:
@@ -38,15 +40,31 @@ static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
  *                                free space pointer
  *
  *  Header format (size in bytes):
- *  ----------------------------------------------------------------------------
- *  | NextPageId (4)| NumTuples(2) | NumDeletedTuples(2) |
- *  ----------------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------
+ *  | NextPageId (4)| NumTuples(2) | NumDeletedTuples(2) | PaxCapacity(2) | NumColumns(2) |
+ *  ----------------------------------------------------------------------------------------------
  *  ----------------------------------------------------------------
  *  | Tuple_1 offset+size (4) | Tuple_2 offset+size (4) | ... |
  *  ----------------------------------------------------------------
  *
  * Tuple format:
  * | meta | data |
+ *
+ * Slots never move, so a RID stays valid for the life of the page. Tuple data is stored in slot order from the end
+ * of the page, compaction slides live tuples over reclaimed ones and leaves the reclaimed slots with an empty tuple.
+ *
+ * A tuple that grows is rewritten in its slot, moving its neighbours within the page if needed. When it no longer fits
+ * in the page, the table heap stores it in a "moved" slot elsewhere and the home slot keeps a forwarding pointer to
+ * it, so the tuple keeps its RID. Every live slot reserves room for such a pointer.
+ *
+ * PAX pages fix their number of slots when they are initialized and keep the fixed-size part of each column in a
+ * minipage of its own, so a scan reads a column without touching the others:
+ *  ------------------------------------------------------------------------------------------------------
+ *  | HEADER | SLOTS (PaxCapacity) | DIRECTORY | MINIPAGE 1 | ... | MINIPAGE N | ... FREE ... | VARLEN ... |
+ *  ------------------------------------------------------------------------------------------------------
+ * The directory holds the offset of every minipage and the width of its entries. The slot of a PAX tuple points to
+ * its varlen part, the bytes after its fixed-size columns, which is laid out, compacted and forwarded like the data
+ * of a row tuple.
  */
 
 class TablePage {
@@ -56,6 +74,14 @@ class TablePage {
    */
   void Init();
 
+  /**
+   * Initialize the page as a PAX page for tuples of the given schema.
+   */
+  void InitPax(const Schema &schema);
+
+  /** @return true if the page stores its tuples column by column */
+  auto IsPax() const -> bool { return pax_capacity_ != 0; }
+
   /** @return number of tuples in this page */
   auto GetNumTuples() const -> uint32_t { return num_tuples_; }
 
@@ -68,6 +94,9 @@ class TablePage {
   /** Get the next offset to insert, return nullopt if this tuple cannot fit in this page */
   auto GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t>;
 
+  /** @return the length of the largest tuple that still fits in this page, including the space for its slot */
+  auto GetFreeSpaceRemaining() const -> uint16_t;
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -85,6 +114,19 @@ class TablePage {
    */
   auto GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple>;
 
+  /**
+   * Read a tuple from a table without copying it. The view points into this page and is only valid while the page
+   * stays latched.
+   */
+  auto GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView>;
+
+  /**
+   * Read some columns of a tuple of a PAX page into a buffer, without touching the minipages of the other columns.
+   * Only the given columns of the returned view can be read, and only while the buffer is unchanged.
+   */
+  auto GetTupleColumns(const RID &rid, const Schema &schema, const std::vector<uint32_t> &column_ids,
+                       std::vector<char> *buf) const -> std::pair<TupleMeta, TupleView>;
+
   /**
    * Read a tuple meta from a table.
    */
@@ -95,18 +137,98 @@ class TablePage {
    */
   void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
 
+  /**
+   * Replace the data of a tuple, keeping its meta. A tuple that shrinks stays where it is, one that grows is given
+   * room by compacting the page. A forwarding pointer in the slot is replaced by the data.
+   * @return false if the page cannot hold the new tuple, in which case nothing changed
+   */
+  auto UpdateTupleInPlace(const Tuple &tuple, const RID &rid) -> bool;
+
+  /** Replace the data of a tuple with a forwarding pointer to the slot now storing it. Always fits. */
+  void SetForward(const RID &rid, const RID &target);
+
+  /** @return the slot a forwarded tuple points to */
+  auto GetForward(const RID &rid) const -> RID;
+
+  /** @return true if the tuple is deleted and the deleting transaction has completed, so its bytes can be reused */
+  static auto IsReclaimable(const TupleMeta &meta) -> bool {
+    return meta.is_deleted_ && meta.delete_txn_id_ == INVALID_TXN_ID;
+  }
+
+  /** @return true if the tuple has been reclaimed by a compaction and holds no data anymore */
+  auto IsReclaimed(const RID &rid) const -> bool {
+    auto &[offset, size, meta] = tuple_info_[rid.GetSlotNum()];
+    return size == 0 && IsReclaimable(meta);
+  }
+
+  /** @return the number of bytes still held by reclaimable tuples */
+  auto GetReclaimableBytes() const -> uint32_t;
+
+  /**
+   * Slide the live tuples towards the end of the page over the data of reclaimable tuples. The slots stay in place,
+   * so every RID keeps pointing to the same tuple.
+   * @return the number of bytes reclaimed
+   */
+  auto Compact() -> uint32_t;
+
+  /** @return true if the page holds tuples and every one of them has been deleted and reclaimed */
+  auto IsVacant() const -> bool;
+
+  /** Bytes reserved by every live slot, enough to turn it into a forwarding pointer */
+  static constexpr uint16_t TUPLE_MIN_FOOTPRINT = sizeof(page_id_t) + sizeof(uint32_t);
+
   static_assert(sizeof(page_id_t) == 4);
 
  private:
   using TupleInfo = std::tuple<uint16_t, uint16_t, TupleMeta>;
+  /** Directory entry of a PAX minipage; varlen columns keep only their offset, the rest of the entry is zero */
+  struct MiniPage {
+    uint16_t offset_;
+    uint16_t width_;
+    uint16_t stored_width_;
+  };
+
   char page_start_[0];
   page_id_t next_page_id_;
   uint16_t num_tuples_;
   uint16_t num_deleted_tuples_;
+  uint16_t pax_capacity_;
+  uint16_t num_columns_;
   TupleInfo tuple_info_[0];
 
   static constexpr size_t TUPLE_INFO_SIZE = 16;
   static_assert(sizeof(TupleInfo) == TUPLE_INFO_SIZE);
+
+  /** Varlen bytes a PAX page expects per varlen column when it decides how many slots it has */
+  static constexpr uint16_t PAX_VARLEN_ESTIMATE = 16;
+
+  /** @return the bytes live data of the given size occupies */
+  static auto Footprint(uint16_t size) -> uint16_t { return std::max(size, TUPLE_MIN_FOOTPRINT); }
+
+  /** @return the bytes the data of a slot occupies, reclaimed slots occupy none */
+  auto StoredFootprint(uint32_t slot) const -> uint16_t {
+    return IsReclaimed(RID{INVALID_PAGE_ID, slot}) ? 0 : Footprint(std::get<1>(tuple_info_[slot]));
+  }
+
+  /** @return the lowest offset tuple data may use once the page has the given number of slots */
+  auto GetDataStart(uint32_t num_slots) const -> size_t;
+
+  /** @return the minipage directory of a PAX page */
+  auto GetMiniPages() const -> const MiniPage * {
+    return reinterpret_cast<const MiniPage *>(page_start_ + TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * pax_capacity_);
+  }
+
+  /** @return the size of the fixed-size part of a tuple, which PAX pages keep in the minipages */
+  auto GetFixedLength() const -> uint16_t;
+
+  /** @return the part of a tuple the slot points to: all of it on row pages, its varlen part on PAX pages */
+  auto GetSlotData(const Tuple &tuple) const -> std::pair<const char *, uint16_t>;
+
+  /** Copy the fixed-size part of a tuple to the minipages of a PAX slot. */
+  void WriteColumns(uint32_t slot, const char *data);
+
+  /** Lay the tuples out again from the end of the page without gaps, giving `slot` new data. */
+  void Rewrite(uint32_t slot, const char *data, uint16_t size);
 };
 
 static_assert(sizeof(TablePage) == TABLE_PAGE_HEADER_SIZE);
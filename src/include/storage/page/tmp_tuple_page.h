@@ -22,14 +22,54 @@ class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    SetFreeSpacePointer(page_size);
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /** @return the offset of the start of the tuples, everything before it is free */
+  auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /**
+   * Insert a tuple in front of the ones already on the page.
+   * @param tuple the tuple
+   * @param[out] out where the tuple was put
+   * @return false if the page has no room for the tuple
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    auto size = static_cast<uint32_t>(sizeof(uint32_t) + tuple.GetLength());
+    auto free_space = GetFreeSpacePointer();
+    if (free_space < SIZE_TMP_PAGE_HEADER + size) {
+      return false;
+    }
+    free_space -= size;
+    tuple.SerializeTo(GetData() + free_space);
+    SetFreeSpacePointer(free_space);
+    *out = TmpTuple(GetTablePageId(), free_space);
+    return true;
+  }
+
+  /**
+   * Read a tuple back.
+   * @param offset the offset Insert() put the tuple at
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple inserted before it, the page size if it is the first one
+   */
+  auto Get(size_t offset, Tuple *tuple) -> size_t {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
+
+  /** Size of the page header: page id, LSN and free space pointer */
+  static constexpr size_t SIZE_TMP_PAGE_HEADER = 12;
 
  private:
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+
+  void SetFreeSpacePointer(uint32_t free_space) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space, sizeof(uint32_t));
+  }
+
   static_assert(sizeof(page_id_t) == 4);
 };
 
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks how many bytes each page of a table heap can still take.
+ *
+ * An inserter claims a page before writing to it. A claimed page is hidden from every other inserter until it is
+ * released with its new free space, so concurrent inserters always work on different pages. The numbers are only
+ * hints: the page itself decides whether a tuple fits.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * Claim the page with the least free space that still fits `size` bytes.
+   * @param size the number of bytes the caller wants to insert
+   * @return the claimed page, or std::nullopt if no unclaimed page has room
+   */
+  auto Claim(uint32_t size) -> std::optional<page_id_t>;
+
+  /**
+   * Give a claimed page back, or register a page the caller created itself.
+   * @param page_id the page to release
+   * @param free_bytes the number of bytes the page can still take
+   */
+  void Release(page_id_t page_id, uint16_t free_bytes);
+
+  /**
+   * Claim a page the caller created itself, so it stays hidden from other inserters and from Remove until released.
+   * @param page_id the page to claim
+   */
+  void MarkClaimed(page_id_t page_id);
+
+  /**
+   * Record the free space of a page, e.g. after its space has been reclaimed. Claimed pages are left alone, their
+   * holder reports the space when it releases them.
+   * @param page_id the page to update
+   * @param free_bytes the number of bytes the page can still take
+   */
+  void Update(page_id_t page_id, uint16_t free_bytes);
+
+  /**
+   * Forget a page that is about to be freed, so it can no longer be claimed.
+   * @param page_id the page to remove
+   * @return false if an inserter holds the page, in which case it is kept
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /** @return the free space recorded for a page, or std::nullopt if the page is unknown or claimed */
+  auto GetFreeSpace(page_id_t page_id) -> std::optional<uint16_t>;
+
+ private:
+  void RecordLatched(page_id_t page_id, uint16_t free_bytes);
+
+  std::mutex latch_;
+  /** Free bytes of every unclaimed page */
+  std::unordered_map<page_id_t, uint16_t> free_bytes_;
+  /** The same entries ordered by free bytes, for best-fit lookups */
+  std::set<std::pair<uint16_t, page_id_t>> by_free_bytes_;
+  std::unordered_set<page_id_t> claimed_;
+};
+
+}  // namespace bustub
@@ -12,40 +12,103 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
+#include <thread>  // NOLINT
+#include <tuple>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
 #include "recovery/log_manager.h"
+#include "storage/page/page_guard.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+#include "type/dictionary.h"
 
 namespace bustub {
 
+class TablePage;
+
+/** How a table heap lays out the tuples in its pages */
+enum class TableFormat {
+  /** Slotted pages storing every tuple in one piece */
+  ROW,
+  /** PAX pages storing every column of a page in a minipage of its own */
+  PAX,
+};
+
+/** How a table heap stores its VARCHAR values */
+enum class TableEncoding {
+  /** Every value is stored as it is */
+  PLAIN,
+  /** Values are stored as codes of a dictionary of the table, as long as the dictionary has room */
+  DICTIONARY,
+};
+
+/** What a vacuum pass over a table heap did */
+struct VacuumStats {
+  /** Number of pages that had bytes reclaimed */
+  size_t num_compacted_pages_{0};
+  /** Number of bytes reclaimed from deleted tuples */
+  size_t num_reclaimed_bytes_{0};
+  /** Number of pages that held only reclaimed tuples and were unlinked */
+  size_t num_freed_pages_{0};
+  /** Number of overflow pages of reclaimed tuples that were freed */
+  size_t num_freed_overflow_pages_{0};
+};
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
  */
 class TableHeap {
   friend class TableIterator;
+  friend class TableReadGuard;
 
  public:
-  ~TableHeap() = default;
+  /** Fraction of a page held by reclaimable tuples at which the background worker compacts it */
+  static constexpr double VACUUM_DEAD_FRACTION = 0.25;
+
+  /** Tuples larger than this move their largest varlen values to overflow pages until they are no larger */
+  static constexpr uint32_t TOAST_TUPLE_THRESHOLD = BUSTUB_PAGE_SIZE / 4;
+
+  ~TableHeap();
 
   /**
    * Create a table heap without a transaction. (open table)
    * @param buffer_pool_manager the buffer pool manager
-   * @param first_page_id the id of the first page
+   * @param schema the schema of the stored tuples. Without it, tuples are stored as they are and must fit in a page.
+   * @param format the page layout, PAX needs a schema
+   * @param encoding how VARCHAR values are stored, dictionary encoding needs a schema
    */
-  explicit TableHeap(BufferPoolManager *bpm);
+  explicit TableHeap(BufferPoolManager *bpm, const Schema *schema = nullptr, TableFormat format = TableFormat::ROW,
+                     TableEncoding encoding = TableEncoding::PLAIN);
+
+  /** @return the page layout of the table */
+  auto GetFormat() const -> TableFormat { return format_; }
+
+  /** @return the dictionary VARCHAR values are encoded with, nullptr if the table stores them as they are */
+  auto GetDictionary() const -> const Dictionary * { return dictionary_.get(); }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return std::nullopt.
+   * With a schema, a tuple larger than TOAST_TUPLE_THRESHOLD is stored with its largest varlen values in overflow
+   * pages, which are read back only when those columns are.
+   * The tuple goes to any page the free space map finds room in, so it may land before the tail of the table.
+   * With a transaction, the page stays reserved for the next inserts of that transaction until it commits or aborts.
    * @param meta tuple meta
    * @param tuple tuple to insert
    * @return rid of the inserted tuple
@@ -61,7 +124,16 @@ class TableHeap {
   void UpdateTupleMeta(const TupleMeta &meta, RID rid);
 
   /**
-   * Read a tuple from the table.
+   * Replace a tuple, keeping its RID. The tuple is rewritten in its page if it still fits there, otherwise it is
+   * stored in another page and its slot forwards to it. The caller must hold the row exclusively.
+   * @param tuple the new tuple
+   * @param rid the tuple to replace
+   */
+  void UpdateTuple(const Tuple &tuple, RID rid);
+
+  /**
+   * Read a tuple from the table. Out-of-line values are read from their overflow pages on access, which stay
+   * allocated only while the caller holds a TableReadGuard of this table.
    * @param rid rid of the tuple to read
    * @return the meta and tuple
    */
@@ -75,15 +147,57 @@ class TableHeap {
    */
   auto GetTupleMeta(RID rid) -> TupleMeta;
 
+  /**
+   * Check whether every tuple on a page is live. A page loses this property once any of its tuples is marked deleted,
+   * which lets index-only scans skip the heap page for the common case.
+   * @param page_id the page to check
+   * @return true if no tuple on the page has been marked deleted
+   */
+  auto IsPageAllVisible(page_id_t page_id) -> bool;
+
   /** @return the iterator of this table, use this for project 3 */
   auto MakeIterator() -> TableIterator;
 
   /** @return the iterator of this table, use this for project 4 except updates */
   auto MakeEagerIterator() -> TableIterator;
 
+  /**
+   * @return an iterator over the pages from first_page_id up to, but not including, stop_page_id, use this to split a
+   * scan of the table into page ranges
+   * @param first_page_id the first page of the range
+   * @param stop_page_id the page following the range, INVALID_PAGE_ID to read up to the end of the table
+   */
+  auto MakeRangeIterator(page_id_t first_page_id, page_id_t stop_page_id) -> TableIterator;
+
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the number of pages of this table, not counting overflow pages */
+  inline auto GetNumPages() const -> size_t { return num_pages_.load(); }
+
+  /** @return the ids of the pages of this table, in scan order */
+  auto GetPageIds() -> std::vector<page_id_t>;
+
+  /**
+   * Compact every page of the table and unlink the pages that only hold reclaimed tuples. The first and the last page
+   * are always kept. The unlinked pages and the overflow pages of every tuple reclaimed so far go back to the buffer
+   * pool if no TableReadGuard of this table is left, otherwise they wait for a later pass.
+   * @return what the pass did
+   */
+  auto Vacuum() -> VacuumStats;
+
+  /**
+   * Give a page a transaction reserved for its inserts back to the free space map.
+   * @param page_id the reserved page
+   */
+  void ReleaseInsertPage(page_id_t page_id);
+
+  /** @return the min/max of the fixed-size columns of every page, nullptr if the heap has no schema */
+  inline auto GetZoneMap() -> ZoneMap * { return zone_map_.get(); }
+
+  /** @return the free space map that routes inserts to pages of this table */
+  inline auto GetFreeSpaceMap() -> FreeSpaceMap & { return free_space_map_; }
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -93,11 +207,110 @@ class TableHeap {
   void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
 
  private:
+  /**
+   * Allocate a fresh page and link it after the last page of the table. Only the link is done under latch_. The new
+   * page is claimed by the caller and must be released to the free space map once the caller is done with it.
+   * @param[out] page_id the id of the new page
+   * @return the write guard of the new page
+   */
+  auto AppendPage(page_id_t *page_id) -> WritePageGuard;
+
+  /** Queue a page for the background worker, starting the worker on first use. */
+  void ScheduleCompaction(page_id_t page_id);
+
+  /** Compact a single page in place and publish its new free space. Overflow chains are freed by the next Vacuum. */
+  auto CompactPage(page_id_t page_id) -> uint32_t;
+
+  /**
+   * Latch the slot that stores a tuple, following its forwarding pointer if it has one. Page latches are never
+   * nested, so a moved tuple is checked after latching and looked up again if it moved on in between.
+   * @return the read guard of the page, the slot storing the tuple and the meta of the tuple's own slot
+   */
+  auto LatchStoredTuple(RID rid) -> std::tuple<ReadPageGuard, RID, TupleMeta>;
+
+  /** Store the data of a forwarded tuple in a moved slot of any page. */
+  auto InsertMovedTuple(const Tuple &tuple) -> RID;
+
+  /** Mark moved slots that are no longer forwarded to as reclaimable. */
+  void ReleaseMovedTuples(const std::vector<RID> &moved);
+
+  /** Give overflow chains of replaced tuples to the next Vacuum. */
+  void DeferOverflowChains(const std::vector<page_id_t> &chains);
+
+  /**
+   * @return the tuple as the heap stores it: wide tuples are toasted, foreign out-of-line values copied and VARCHAR
+   * values encoded with the dictionary of the heap
+   */
+  auto PrepareTuple(const Tuple &tuple) -> std::optional<Tuple>;
+
+  /** Store the VARCHAR values of a tuple as codes of the dictionary of the heap, or as they are if there is none. */
+  auto EncodeTuple(const Tuple &tuple) -> Tuple;
+
+  /** Move the largest varlen values of a wide tuple to overflow pages. */
+  auto ToastTuple(const Tuple &tuple) -> Tuple;
+
+  /** Collect the first overflow page of every out-of-line value of a serialized tuple. */
+  void CollectOverflowChains(const char *data, std::vector<page_id_t> *chains) const;
+
+  /** Collect the overflow chains of a tuple in a latched page. */
+  void CollectStoredChains(const TablePage *page, const RID &rid, std::vector<page_id_t> *chains) const;
+
+  /** Initialize a new page of the table in its format. */
+  void InitPage(TablePage *page) const;
+
+  /**
+   * Collect what hangs off the tuples a page compaction is about to reclaim: their overflow chains and, for forwarded
+   * tuples, the moved slots storing them.
+   */
+  void CollectReclaimable(page_id_t page_id, const TablePage *page, std::vector<page_id_t> *chains,
+                          std::vector<RID> *moved) const;
+
+  /** Store a value in a fresh overflow chain. @return the first page of the chain */
+  auto WriteOverflowChain(const char *data, uint32_t size) -> page_id_t;
+
+  /** Free every page of an overflow chain. @return the number of freed pages */
+  auto FreeOverflowChain(page_id_t page_id) -> size_t;
+
+  /**
+   * Free the unlinked pages and the overflow chains of reclaimed tuples, unless a reader is registered. vacuum_latch_
+   * must be held.
+   * @return the number of freed overflow pages
+   */
+  auto FreeRetired() -> size_t;
+
+  /** Body of the background worker, it compacts queued pages until the heap is destroyed. */
+  void RunCompaction();
+
   BufferPoolManager *bpm_;
+  /** Schema of the stored tuples, nullptr if the heap does not move values out of line */
+  std::unique_ptr<const Schema> schema_;
+  /** Value ranges of the pages, kept for heaps with a schema */
+  std::unique_ptr<ZoneMap> zone_map_;
+  /** Strings of a dictionary-encoded heap, nullptr otherwise */
+  std::unique_ptr<Dictionary> dictionary_;
+  TableFormat format_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  std::atomic<size_t> num_pages_{1};
+
+  FreeSpaceMap free_space_map_;
+
+  /** Serializes compaction between the worker and Vacuum, taken before latch_ */
+  std::mutex vacuum_latch_;
+  std::condition_variable vacuum_cv_;
+  std::deque<page_id_t> vacuum_queue_;           /* protected by vacuum_latch_ */
+  std::unordered_set<page_id_t> vacuum_pending_; /* protected by vacuum_latch_ */
+  bool vacuum_stop_{false};                      /* protected by vacuum_latch_ */
+  std::vector<page_id_t> overflow_garbage_;      /* protected by vacuum_latch_ */
+  std::vector<page_id_t> retired_pages_;         /* protected by vacuum_latch_ */
+  std::thread vacuum_thread_;
+  /** Number of live TableReadGuards, unlinked pages and overflow chains are freed only when it is zero */
+  std::atomic<size_t> num_readers_{0};
+
+  std::mutex visibility_latch_;
+  std::unordered_set<page_id_t> pages_with_deletes_; /* protected by visibility_latch_ */
 };
 
 }  // namespace bustub
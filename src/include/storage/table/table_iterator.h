@@ -15,18 +15,48 @@
 #include <cassert>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "common/macros.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
+#include "storage/page/page_guard.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 class TableHeap;
 
+/**
+ * TableReadGuard registers a reader of a table heap for as long as it lives. Vacuum unlinks pages while readers are
+ * registered but only frees them once every reader is gone, so a reader may hold page ids across calls without
+ * holding a table lock.
+ */
+class TableReadGuard {
+ public:
+  TableReadGuard() = default;
+  explicit TableReadGuard(TableHeap *table_heap);
+  DISALLOW_COPY(TableReadGuard);
+  TableReadGuard(TableReadGuard &&that) noexcept;
+  auto operator=(TableReadGuard &&that) noexcept -> TableReadGuard &;
+  ~TableReadGuard() { Drop(); }
+
+  /** Unregister the reader, if the guard holds one. */
+  void Drop();
+
+ private:
+  TableHeap *table_heap_{nullptr};
+};
+
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * GetTupleView() keeps the current page read-latched, and operator++ reuses that latch until the cursor leaves the
+ * page, so a scan reads one page after another without copying tuples out of them. The latch must be dropped with
+ * ReleasePage() before the caller blocks (e.g. on a row lock) or writes to the table.
+ *
+ * Moved slots hold the data of forwarded tuples and are skipped; a forwarded tuple is read at its own RID, with the
+ * latch moved from its page to the page storing it.
  */
 class TableIterator {
   friend class Cursor;
@@ -41,20 +71,77 @@ class TableIterator {
 
   auto GetTuple() -> std::pair<TupleMeta, Tuple>;
 
+  /**
+   * Read the current tuple in place. The view is valid until the iterator moves to another page or ReleasePage() is
+   * called. Tuples of PAX pages are gathered into a buffer of the iterator, which the next read reuses.
+   */
+  auto GetTupleView() -> std::pair<TupleMeta, TupleView>;
+
+  /**
+   * Read some columns of the current tuple. Only the given columns of the view can be read. PAX pages read just the
+   * minipages of those columns, row pages return the whole tuple as GetTupleView() does.
+   */
+  auto GetTupleColumns(const std::vector<uint32_t> &column_ids) -> std::pair<TupleMeta, TupleView>;
+
+  /** Drop the latch on the current page, if the iterator holds one. */
+  void ReleasePage() {
+    page_guard_.Drop();
+    forward_guard_.Drop();
+    page_latched_ = false;
+    forward_latched_ = false;
+  }
+
   auto GetRID() -> RID;
 
   auto IsEnd() -> bool;
 
   auto operator++() -> TableIterator &;
 
+  /** Move to the first tuple of the next page, skipping the rest of the current one. */
+  void SkipPage();
+
  private:
+  /** @return a latch on the page of rid_, taken over from the iterator if it holds one */
+  auto TakePage() -> ReadPageGuard;
+
+  /**
+   * Keep the latch on the page of rid_ if the iterator held one before moving, drop it otherwise. An iterator at its
+   * end drops its read guard too.
+   */
+  void KeepPage(ReadPageGuard *page_guard, bool was_latched);
+
+  /** Advance rid_ by one slot, moving page_guard to the page of the new rid_ when it changes. */
+  void Step(ReadPageGuard *page_guard);
+
+  /** Latch the slot storing the current tuple and read it, or only the given columns of it if there are any. */
+  auto ReadTuple(const std::vector<uint32_t> *column_ids) -> std::pair<TupleMeta, TupleView>;
+
+  /** @return whether rid_ is the slot of a tuple; moved slots are read through the slot forwarding to them */
+  auto AtHomeSlot(ReadPageGuard *page_guard) const -> bool;
+
   TableHeap *table_heap_;
+  /** Taken before any page is read, the pages the iterator walks stay allocated until it is destroyed */
+  TableReadGuard read_guard_;
   RID rid_;
 
   // When creating table iterator, we will record the maximum RID that we should scan.
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  /** Read latch on the page of rid_, only held after GetTupleView() */
+  ReadPageGuard page_guard_;
+  bool page_latched_{false};
+
+  /** Read latch on the page storing a forwarded rid_, held instead of page_guard_ after GetTupleView() */
+  ReadPageGuard forward_guard_;
+  bool forward_latched_{false};
+  RID forward_slot_;
+  TupleMeta forward_meta_;
+
+  /** Tuple of a PAX page gathered by the last read */
+  Tuple pax_tuple_;
+  std::vector<char> pax_columns_;
 };
 
 }  // namespace bustub
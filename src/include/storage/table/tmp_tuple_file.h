@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.h
+//
+// Identification: src/include/storage/table/tmp_tuple_file.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleFile is a run of tuples an operator spilled out of memory, kept on TmpTuplePages of the buffer pool. Tuples
+ * are appended and read back with a cursor; the pages live as long as the file.
+ *
+ * The tuples are stored as they are, they must not refer to a dictionary or overflow pages of a table. Tuples built
+ * from values, as executors pass them on, never do.
+ */
+class TmpTupleFile {
+ public:
+  /** A position in the file, a cursor at its start is default constructed */
+  struct Cursor {
+    size_t page_idx_{0};
+    size_t offset_{0};
+  };
+
+  explicit TmpTupleFile(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /** Delete the pages of the file */
+  ~TmpTupleFile();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleFile);
+
+  /**
+   * Append a tuple.
+   * @throws Exception if the buffer pool has no free frame or the tuple is larger than a page
+   */
+  void Append(const Tuple &tuple);
+
+  /**
+   * Read the tuple at a cursor and move the cursor past it. The tuples of a page are read in the reverse order they
+   * were appended in, the pages in the order they were filled.
+   * @param cursor the position to read at
+   * @param[out] tuple the tuple
+   * @return false if the cursor is at the end of the file
+   */
+  auto Next(Cursor *cursor, Tuple *tuple) -> bool;
+
+  /** @return the number of tuples in the file */
+  auto GetNumTuples() const -> size_t { return num_tuples_; }
+
+ private:
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  size_t num_tuples_{0};
+};
+
+}  // namespace bustub
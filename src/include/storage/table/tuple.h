@@ -21,8 +21,25 @@
 
 namespace bustub {
 
+class BufferPoolManager;
+class Dictionary;
+
 static constexpr size_t TUPLE_META_SIZE = 12;
 
+/**
+ * A varlen field whose length has this bit set was moved to a chain of overflow pages. The field then holds the real
+ * length (without the bit) followed by the id of the first overflow page.
+ */
+static constexpr uint32_t VARLEN_OVERFLOW_FLAG = 1U << 31;
+static constexpr uint32_t VARLEN_OVERFLOW_POINTER_SIZE = sizeof(uint32_t) + sizeof(page_id_t);
+
+/**
+ * A varlen field whose length has this bit set holds a code of the dictionary of its table. The field then holds the
+ * real length (without the bit) followed by the code.
+ */
+static constexpr uint32_t VARLEN_DICTIONARY_FLAG = 1U << 30;
+static constexpr uint32_t VARLEN_DICTIONARY_CODE_SIZE = sizeof(uint32_t) + sizeof(uint32_t);
+
 struct TupleMeta {
   /**
    * @brief txn id that inserts this tuple. INVALID_TXN if the insertion is completed.
@@ -38,6 +55,15 @@ struct TupleMeta {
    * @brief marks whether this tuple is marked removed from table heap.
    */
   bool is_deleted_;
+  /**
+   * @brief the slot holds a forwarding pointer to the slot that stores the tuple. Maintained by the table page.
+   */
+  bool is_forwarded_{false};
+  /**
+   * @brief the slot stores the tuple of a forwarded slot, it is only reachable through that slot. Maintained by the
+   * table page.
+   */
+  bool is_moved_{false};
 };
 
 static_assert(sizeof(TupleMeta) == TUPLE_META_SIZE);
@@ -47,11 +73,16 @@ static_assert(sizeof(TupleMeta) == TUPLE_META_SIZE);
  * ---------------------------------------------------------------------
  * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
  * ---------------------------------------------------------------------
+ *
+ * A varied-sized payload is either stored inline as | size | data |, or, for wide tuples stored in a table heap, as
+ * a pointer to overflow pages (see VARLEN_OVERFLOW_FLAG). Out-of-line values are only fetched when the column is read.
+ * Tables with dictionary encoding store the payload as a code instead (see VARLEN_DICTIONARY_FLAG).
  */
 class Tuple {
   friend class TablePage;
   friend class TableHeap;
   friend class TableIterator;
+  friend class TupleView;
 
  public:
   // Default constructor (to create a dummy tuple)
@@ -97,19 +128,87 @@ class Tuple {
   auto KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) -> Tuple;
 
   // Is the column value null ?
-  inline auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
-    Value value = GetValue(schema, column_idx);
-    return value.IsNull();
-  }
+  auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool;
 
   auto ToString(const Schema *schema) const -> std::string;
 
  private:
   // Get the starting storage address of specific column
-  auto GetDataPtr(const Schema *schema, uint32_t column_idx) const -> const char *;
+  auto GetDataPtr(const Schema *schema, uint32_t column_idx) const -> const char * {
+    return GetDataPtr(data_.data(), schema, column_idx);
+  }
+
+  // Get the starting address of specific column in serialized tuple data
+  static auto GetDataPtr(const char *data, const Schema *schema, uint32_t column_idx) -> const char *;
+
+  // Read a column of serialized tuple data, VARCHAR values borrow their bytes if `borrow` is set and they are inline
+  static auto GetValue(const char *data, const Schema *schema, uint32_t column_idx, BufferPoolManager *overflow_bpm,
+                       const Dictionary *dictionary, bool borrow) -> Value;
+
+  // Whether a column of serialized tuple data is null, without fetching out-of-line values
+  static auto IsNull(const char *data, const Schema *schema, uint32_t column_idx) -> bool;
 
   RID rid_{};  // if pointing to the table heap, the rid is valid
   std::vector<char> data_;
+  // where out-of-line values live, set when the tuple is read from a table heap; they stay readable while a
+  // TableReadGuard of that heap is held
+  BufferPoolManager *overflow_bpm_{nullptr};
+  // the codes of the tuple belong to this dictionary, set when the tuple is read from a dictionary-encoded table heap
+  const Dictionary *dictionary_{nullptr};
+};
+
+/**
+ * TupleView is a non-owning view of a serialized tuple, usually one that lives in a pinned table page.
+ *
+ * Columns are read in place: a VARCHAR value returned by the view borrows its bytes instead of copying them, so
+ * neither the view nor its values may outlive the buffer (for a table page, the page latch). Call Materialize() to
+ * get an owning Tuple that can be kept around.
+ */
+class TupleView {
+ public:
+  TupleView() = default;
+
+  TupleView(const char *data, uint32_t size, RID rid, BufferPoolManager *overflow_bpm = nullptr,
+            const Dictionary *dictionary = nullptr)
+      : data_(data), size_(size), rid_(rid), overflow_bpm_(overflow_bpm), dictionary_(dictionary) {}
+
+  // view of an owning tuple, valid as long as the tuple is neither modified nor destroyed
+  explicit TupleView(const Tuple &tuple)
+      : data_(tuple.GetData()),
+        size_(tuple.GetLength()),
+        rid_(tuple.GetRid()),
+        overflow_bpm_(tuple.overflow_bpm_),
+        dictionary_(tuple.dictionary_) {}
+
+  inline auto GetRid() const -> RID { return rid_; }
+
+  inline auto GetData() const -> const char * { return data_; }
+
+  inline auto GetLength() const -> uint32_t { return size_; }
+
+  // Get the value of a specified column, inline VARCHAR values point into the viewed buffer
+  auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value {
+    return Tuple::GetValue(data_, schema, column_idx, overflow_bpm_, dictionary_, true);
+  }
+
+  // Get the value of a specified column as an owning value, which may outlive the view
+  auto CopyValue(const Schema *schema, uint32_t column_idx) const -> Value {
+    return Tuple::GetValue(data_, schema, column_idx, overflow_bpm_, dictionary_, false);
+  }
+
+  inline auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
+    return Tuple::IsNull(data_, schema, column_idx);
+  }
+
+  // Copy the viewed tuple into an owning tuple
+  auto Materialize() const -> Tuple;
+
+ private:
+  const char *data_{nullptr};
+  uint32_t size_{0};
+  RID rid_{};
+  BufferPoolManager *overflow_bpm_{nullptr};
+  const Dictionary *dictionary_{nullptr};
 };
 
 }  // namespace bustub
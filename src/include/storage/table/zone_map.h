@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** The values one column has taken on a page */
+struct ColumnZone {
+  /** Smallest non-null value, only set if num_values_ > 0 */
+  Value min_;
+  /** Largest non-null value, only set if num_values_ > 0 */
+  Value max_;
+  /** Number of non-null values */
+  uint32_t num_values_{0};
+  /** Number of null values */
+  uint32_t null_count_{0};
+};
+
+/** The values the tuples of one page have taken, indexed by column. Columns the map does not track stay empty. */
+struct PageZone {
+  std::vector<ColumnZone> columns_;
+};
+
+/**
+ * ZoneMap keeps the min, max and null count of the fixed-size columns of every page of a table heap, so a scan can
+ * skip pages whose values cannot satisfy its predicate.
+ *
+ * A zone only ever widens: it covers every value written to the page, including those of deleted tuples and of the
+ * versions an update replaced, until the page is freed. A forwarded tuple counts towards the page of its own RID,
+ * which is where a scan reads it.
+ */
+class ZoneMap {
+ public:
+  /** @param schema the schema of the tuples of the table, it must outlive the map */
+  explicit ZoneMap(const Schema *schema);
+
+  /** @return whether the map records the values of a column */
+  auto IsTracked(uint32_t col_idx) const -> bool;
+
+  /**
+   * Widen the zone of a page to cover a tuple written to it.
+   * @param page_id the page the tuple belongs to
+   * @param tuple the tuple
+   */
+  void Add(page_id_t page_id, const Tuple &tuple);
+
+  /**
+   * Forget a page that has been freed.
+   * @param page_id the page to remove
+   */
+  void Remove(page_id_t page_id);
+
+  /** @return the zone of a page, or std::nullopt if no tuple was ever written to it */
+  auto GetZone(page_id_t page_id) -> std::optional<PageZone>;
+
+ private:
+  const Schema *schema_;
+  /** Columns whose values are recorded: fixed-size columns of an ordered type */
+  std::vector<uint32_t> tracked_;
+
+  std::mutex latch_;
+  std::unordered_map<page_id_t, PageZone> zones_; /* protected by latch_ */
+};
+
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dictionary.h
+//
+// Identification: src/include/type/dictionary.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace bustub {
+
+class Dictionary;
+
+/** A string of a dictionary, along with its code */
+struct DictionaryEntry {
+  std::string data_;
+  uint32_t code_{0};
+  /** HashUtil::HashBytes of data_, so hashing an encoded value does not touch its bytes */
+  size_t hash_{0};
+  const Dictionary *dictionary_{nullptr};
+};
+
+/**
+ * Dictionary maps the distinct strings of a dictionary-encoded table to small integer codes. Codes are handed out in
+ * insertion order and never change, and entries are never removed, so a code can be decoded without latching.
+ *
+ * VARCHAR values decoded from a dictionary carry their entry (see Value::GetDictionaryEntry()): two values of the same
+ * dictionary are compared by code, and hashed with the hash stored in the entry.
+ */
+class Dictionary {
+ public:
+  /** Number of distinct strings a dictionary takes, further strings are stored as they are */
+  static constexpr uint32_t CAPACITY = 1 << 16;
+
+  /**
+   * Look up the code of a string, adding the string if it is new.
+   * @return the entry of the string, or nullptr if it is new and the dictionary is full
+   */
+  auto Intern(const char *data, uint32_t len) -> const DictionaryEntry *;
+
+  /** @return the entry of a string, or nullptr if the dictionary does not hold it */
+  auto Find(const char *data, uint32_t len) const -> const DictionaryEntry *;
+
+  /** @return the entry of a code handed out by Intern() */
+  auto GetEntry(uint32_t code) const -> const DictionaryEntry * {
+    return &chunks_[code / CHUNK_SIZE][code % CHUNK_SIZE];
+  }
+
+  /** @return the number of strings in the dictionary */
+  auto Size() const -> uint32_t;
+
+ private:
+  static constexpr uint32_t CHUNK_SIZE = 256;
+
+  mutable std::mutex latch_;
+  /** Code of every string, keyed by views into the entries */
+  std::unordered_map<std::string_view, uint32_t> codes_; /* protected by latch_ */
+  /** Entries in code order. Chunks are allocated as the dictionary grows and never move. */
+  std::array<std::unique_ptr<DictionaryEntry[]>, CAPACITY / CHUNK_SIZE> chunks_;
+  uint32_t size_{0}; /* protected by latch_ */
+};
+
+}  // namespace bustub
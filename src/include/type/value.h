@@ -24,6 +24,8 @@
 
 namespace bustub {
 
+struct DictionaryEntry;
+
 inline auto GetCmpBool(bool boolean) -> CmpBool { return boolean ? CmpBool::CmpTrue : CmpBool::CmpFalse; }
 
 // A value is an abstract class that represents a view over SQL data stored in
@@ -61,9 +63,13 @@ class Value {
   // VARCHAR
   Value(TypeId type, const char *data, uint32_t len, bool manage_data);
   Value(TypeId type, const std::string &data);
+  // VARCHAR decoded from a dictionary, the value borrows the bytes of the entry
+  Value(TypeId type, const DictionaryEntry *entry);
 
   Value() : Value(TypeId::INVALID) {}
   Value(const Value &other);
+  // leaves other an invalid value, so vectors of values grow without copying VARCHAR bytes
+  Value(Value &&other) noexcept : Value() { Swap(*this, other); }
   auto operator=(Value other) -> Value &;
   ~Value();
   // NOLINTNEXTLINE
@@ -72,6 +78,7 @@ class Value {
     std::swap(first.size_, second.size_);
     std::swap(first.manage_data_, second.manage_data_);
     std::swap(first.type_id_, second.type_id_);
+    std::swap(first.dict_entry_, second.dict_entry_);
   }
   // check whether value is integer
   auto CheckInteger() const -> bool;
@@ -126,6 +133,8 @@ class Value {
   inline auto OperateNull(const Value &o) const -> Value { return Type::GetInstance(type_id_)->OperateNull(*this, o); }
   inline auto IsZero() const -> bool { return Type::GetInstance(type_id_)->IsZero(*this); }
   inline auto IsNull() const -> bool { return size_.len_ == BUSTUB_VALUE_NULL; }
+  // The dictionary entry of a VARCHAR read from a dictionary-encoded table, nullptr otherwise
+  inline auto GetDictionaryEntry() const -> const DictionaryEntry * { return dict_entry_; }
 
   // Serialize this value into the given storage space. The inlined parameter
   // indicates whether we are allowed to inline this value into the storage
@@ -166,6 +175,9 @@ class Value {
   bool manage_data_;
   // The data type
   TypeId type_id_;
+
+  // Where a VARCHAR was decoded from, if it was stored as a dictionary code
+  const DictionaryEntry *dict_entry_{nullptr};
 };
 }  // namespace bustub
 
@@ -0,0 +1,201 @@
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+namespace {
+
+/** A single `column op constant` term of a conjunctive predicate. */
+struct ColumnConstantTerm {
+  uint32_t col_idx_;
+  ComparisonType comp_type_;
+  Value value_;
+};
+
+auto FlipComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+/** Collect the `column op constant` terms of an AND tree. Other terms are left to the filter. */
+void CollectTerms(const AbstractExpressionRef &expr, std::vector<ColumnConstantTerm> *terms) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get()); logic_expr != nullptr) {
+    if (logic_expr->logic_type_ == LogicType::And) {
+      CollectTerms(expr->GetChildAt(0), terms);
+      CollectTerms(expr->GetChildAt(1), terms);
+    }
+    return;
+  }
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (cmp_expr == nullptr || cmp_expr->comp_type_ == ComparisonType::NotEqual) {
+    return;
+  }
+  auto comp_type = cmp_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr->GetChildAt(0).get());
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr->GetChildAt(1).get());
+  if (column_expr == nullptr || constant_expr == nullptr) {
+    column_expr = dynamic_cast<const ColumnValueExpression *>(expr->GetChildAt(1).get());
+    constant_expr = dynamic_cast<const ConstantValueExpression *>(expr->GetChildAt(0).get());
+    comp_type = FlipComparison(comp_type);
+  }
+  // Index keys only hold integers, other constant types would be serialized incorrectly.
+  if (column_expr == nullptr || constant_expr == nullptr || column_expr->GetTupleIdx() != 0 ||
+      constant_expr->val_.GetTypeId() != TypeId::INTEGER || constant_expr->val_.IsNull()) {
+    return;
+  }
+  terms->push_back({column_expr->GetColIdx(), comp_type, constant_expr->val_});
+}
+
+/** Keep the tighter of two bounds on the same column. `lower` picks the larger one, otherwise the smaller one. */
+void TightenBound(std::optional<std::pair<Value, bool>> *bound, const Value &value, bool inclusive, bool lower) {
+  if (!bound->has_value()) {
+    *bound = std::make_pair(value, inclusive);
+    return;
+  }
+  const auto &current = (*bound)->first;
+  auto tighter = lower ? value.CompareGreaterThan(current) : value.CompareLessThan(current);
+  if (tighter == CmpBool::CmpTrue || (value.CompareEquals(current) == CmpBool::CmpTrue && !inclusive)) {
+    *bound = std::make_pair(value, inclusive);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFilterAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFilterAsIndexScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Filter) {
+    return optimized_plan;
+  }
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Filter with multiple children?? Impossible!");
+  const auto &child_plan = optimized_plan->children_[0];
+  if (child_plan->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+  if (seq_scan.filter_predicate_ != nullptr) {
+    return optimized_plan;
+  }
+
+  std::vector<ColumnConstantTerm> terms;
+  CollectTerms(filter_plan.GetPredicate(), &terms);
+  if (terms.empty()) {
+    return optimized_plan;
+  }
+
+  const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+  std::optional<index_oid_t> best_index;
+  std::optional<IndexScanBound> best_lower;
+  std::optional<IndexScanBound> best_upper;
+  size_t best_matched = 0;
+
+  for (const auto *index : catalog_.GetTableIndexes(table_info->name_)) {
+    // Leading equalities extend the key prefix, the first column without an equality may carry a range.
+    std::vector<Value> prefix;
+    std::optional<std::pair<Value, bool>> lower;
+    std::optional<std::pair<Value, bool>> upper;
+    for (auto key_attr : index->index_->GetKeyAttrs()) {
+      std::optional<Value> equal;
+      for (const auto &term : terms) {
+        if (term.col_idx_ != key_attr) {
+          continue;
+        }
+        switch (term.comp_type_) {
+          case ComparisonType::Equal:
+            equal = term.value_;
+            break;
+          case ComparisonType::GreaterThan:
+          case ComparisonType::GreaterThanOrEqual:
+            TightenBound(&lower, term.value_, term.comp_type_ == ComparisonType::GreaterThanOrEqual, true);
+            break;
+          case ComparisonType::LessThan:
+          case ComparisonType::LessThanOrEqual:
+            TightenBound(&upper, term.value_, term.comp_type_ == ComparisonType::LessThanOrEqual, false);
+            break;
+          default:
+            break;
+        }
+      }
+      if (!equal.has_value()) {
+        break;
+      }
+      prefix.push_back(*equal);
+      lower.reset();
+      upper.reset();
+    }
+
+    size_t matched = prefix.size() + (lower.has_value() || upper.has_value() ? 1 : 0);
+    // A hash index can only look up the full key
+    if (index->index_type_ == IndexType::HashTableIndex && prefix.size() != index->index_->GetKeyAttrs().size()) {
+      continue;
+    }
+    if (matched == 0 || matched < best_matched) {
+      continue;
+    }
+    if (matched == best_matched) {
+      // Between indexes that bound the same number of columns, pick the cheaper one.
+      auto cost = EstimatedIndexScanCost(index->index_oid_);
+      auto best_cost = EstimatedIndexScanCost(*best_index);
+      if (cost == std::nullopt || best_cost == std::nullopt || *cost >= *best_cost) {
+        continue;
+      }
+    }
+    best_matched = matched;
+    best_index = index->index_oid_;
+    best_lower.reset();
+    best_upper.reset();
+    if (!prefix.empty() || lower.has_value()) {
+      best_lower = IndexScanBound{prefix, true};
+      if (lower.has_value()) {
+        best_lower->key_.push_back(lower->first);
+        best_lower->inclusive_ = lower->second;
+      }
+    }
+    if (!prefix.empty() || upper.has_value()) {
+      best_upper = IndexScanBound{prefix, true};
+      if (upper.has_value()) {
+        best_upper->key_.push_back(upper->first);
+        best_upper->inclusive_ = upper->second;
+      }
+    }
+  }
+
+  if (!best_index.has_value()) {
+    return optimized_plan;
+  }
+
+  // The filter stays on top: the bounds only cover the indexed prefix of the predicate.
+  auto index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, *best_index, std::move(best_lower),
+                                                        std::move(best_upper));
+  return std::make_shared<FilterPlanNode>(filter_plan.output_schema_, filter_plan.GetPredicate(),
+                                          std::move(index_scan));
+}
+
+}  // namespace bustub
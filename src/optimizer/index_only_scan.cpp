@@ -0,0 +1,128 @@
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Rewrite the column references of an expression over the table schema into references over the index key columns.
+ * @return the rewritten expression, or nullptr if the expression refers to a column outside of the index key
+ */
+auto RewriteExpressionForKey(const AbstractExpressionRef &expr, const std::vector<std::optional<uint32_t>> &key_pos)
+    -> AbstractExpressionRef {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    auto col_idx = column_value_expr->GetColIdx();
+    if (column_value_expr->GetTupleIdx() != 0 || col_idx >= key_pos.size() || key_pos[col_idx] == std::nullopt) {
+      return nullptr;
+    }
+    return std::make_shared<ColumnValueExpression>(0, *key_pos[col_idx], column_value_expr->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    auto rewritten = RewriteExpressionForKey(child, key_pos);
+    if (rewritten == nullptr) {
+      return nullptr;
+    }
+    children.emplace_back(std::move(rewritten));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+auto RewriteExpressionsForKey(const std::vector<AbstractExpressionRef> &exprs,
+                              const std::vector<std::optional<uint32_t>> &key_pos)
+    -> std::optional<std::vector<AbstractExpressionRef>> {
+  std::vector<AbstractExpressionRef> rewritten;
+  rewritten.reserve(exprs.size());
+  for (const auto &expr : exprs) {
+    auto rewritten_expr = RewriteExpressionForKey(expr, key_pos);
+    if (rewritten_expr == nullptr) {
+      return std::nullopt;
+    }
+    rewritten.emplace_back(std::move(rewritten_expr));
+  }
+  return rewritten;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  // Only projections and aggregations consume a known set of columns, other parents may need the whole tuple
+  if (optimized_plan->GetType() != PlanType::Projection && optimized_plan->GetType() != PlanType::Aggregation) {
+    return optimized_plan;
+  }
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1,
+                "Projection or aggregation with multiple children?? Impossible!");
+  const auto *filter_plan = dynamic_cast<const FilterPlanNode *>(optimized_plan->children_[0].get());
+  const auto &scan_ref = filter_plan == nullptr ? optimized_plan->children_[0] : filter_plan->children_[0];
+  if (scan_ref->GetType() != PlanType::IndexScan) {
+    return optimized_plan;
+  }
+  const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*scan_ref);
+  if (index_scan.IsIndexOnly()) {
+    return optimized_plan;
+  }
+
+  const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+  // Hash buckets do not hand out their keys to the executor
+  if (index_info->index_type_ == IndexType::HashTableIndex) {
+    return optimized_plan;
+  }
+  const auto &key_attrs = index_info->index_->GetKeyAttrs();
+  std::vector<std::optional<uint32_t>> key_pos(index_scan.OutputSchema().GetColumnCount());
+  std::vector<Column> key_columns;
+  for (uint32_t i = 0; i < key_attrs.size(); i++) {
+    key_pos[key_attrs[i]] = i;
+    key_columns.push_back(index_scan.OutputSchema().GetColumn(key_attrs[i]));
+  }
+  auto key_schema = std::make_shared<Schema>(key_columns);
+
+  AbstractPlanNodeRef new_child = std::make_shared<IndexScanPlanNode>(
+      key_schema, index_scan.GetIndexOid(), index_scan.GetLowerBound(), index_scan.GetUpperBound(),
+      index_scan.GetDirection(), true);
+  if (filter_plan != nullptr) {
+    auto predicate = RewriteExpressionForKey(filter_plan->GetPredicate(), key_pos);
+    if (predicate == nullptr) {
+      return optimized_plan;
+    }
+    new_child = std::make_shared<FilterPlanNode>(key_schema, std::move(predicate), std::move(new_child));
+  }
+
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    const auto &projection_plan = dynamic_cast<const ProjectionPlanNode &>(*optimized_plan);
+    auto exprs = RewriteExpressionsForKey(projection_plan.GetExpressions(), key_pos);
+    if (exprs == std::nullopt) {
+      return optimized_plan;
+    }
+    return std::make_shared<ProjectionPlanNode>(projection_plan.output_schema_, std::move(*exprs),
+                                                std::move(new_child));
+  }
+
+  const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+  auto group_bys = RewriteExpressionsForKey(agg_plan.GetGroupBys(), key_pos);
+  auto aggregates = RewriteExpressionsForKey(agg_plan.GetAggregates(), key_pos);
+  if (group_bys == std::nullopt || aggregates == std::nullopt) {
+    return optimized_plan;
+  }
+  return std::make_shared<AggregationPlanNode>(agg_plan.output_schema_, std::move(new_child), std::move(*group_bys),
+                                               std::move(*aggregates), agg_plan.GetAggregateTypes());
+}
+
+}  // namespace bustub
@@ -7,6 +7,7 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/hash_join_plan.h"
@@ -29,9 +30,25 @@ auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> Abstra
   }
   AbstractPlanNodeRef left_plan = OptimizeNLJAsHashJoin(ptr->GetLeftPlan());
   AbstractPlanNodeRef right_plan = OptimizeNLJAsHashJoin(ptr->GetRightPlan());
+  // only an equality, or a conjunction of equalities, between two columns can become a hash join
+  auto is_column_equality = [](const AbstractExpressionRef &expr) {
+    const auto com_expr = std::dynamic_pointer_cast<ComparisonExpression>(expr);
+    return com_expr != nullptr && com_expr->comp_type_ == ComparisonType::Equal &&
+           std::dynamic_pointer_cast<ColumnValueExpression>(com_expr->GetChildAt(0)) != nullptr &&
+           std::dynamic_pointer_cast<ColumnValueExpression>(com_expr->GetChildAt(1)) != nullptr;
+  };
+  const auto &predicate = ptr->Predicate();
+  bool is_equi_join = is_column_equality(predicate);
+  if (const auto logic_expr = std::dynamic_pointer_cast<LogicExpression>(predicate);
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    is_equi_join = std::all_of(logic_expr->GetChildren().begin(), logic_expr->GetChildren().end(), is_column_equality);
+  }
+  if (!is_equi_join) {
+    return ptr->CloneWithChildren({left_plan, right_plan});
+  }
   std::vector<AbstractExpressionRef> left_key_expressions;
   std::vector<AbstractExpressionRef> right_key_expressions;
-  std::vector<AbstractExpressionRef> vector = ptr->Predicate()->GetChildren();
+  std::vector<AbstractExpressionRef> vector = predicate->GetChildren();
   for (auto &it : vector) {
     const std::shared_ptr<ColumnValueExpression> col_expr = std::dynamic_pointer_cast<ColumnValueExpression>(it);
     if (col_expr) {
@@ -2,6 +2,7 @@
 #include <optional>
 #include "common/util/string_util.h"
 #include "execution/plans/abstract_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
 
@@ -38,7 +39,33 @@ auto Optimizer::EstimatedCardinality(const std::string &table_name) -> std::opti
   if (StringUtil::EndsWith(table_name, "_100")) {
     return std::make_optional(100);
   }
+  // Every tuple has one entry in each index, so any index with fresh statistics tells the table size. Planning never
+  // collects them, that would walk the whole tree.
+  for (const auto *index_info : catalog_.GetTableIndexes(table_name)) {
+    if (auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info->index_.get()); tree != nullptr) {
+      if (auto stats = tree->GetCachedStats(); stats.has_value()) {
+        return std::make_optional(stats->num_entries_);
+      }
+    }
+  }
   return std::nullopt;
 }
 
+auto Optimizer::EstimatedIndexScanCost(index_oid_t index_oid) -> std::optional<size_t> {
+  const auto *index_info = catalog_.GetIndex(index_oid);
+  if (index_info->index_type_ == IndexType::HashTableIndex) {
+    // A lookup reads the directory and a single bucket
+    return std::make_optional<size_t>(2);
+  }
+  auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info->index_.get());
+  if (tree == nullptr) {
+    return std::nullopt;
+  }
+  auto stats = tree->GetCachedStats();
+  if (!stats.has_value()) {
+    return std::nullopt;
+  }
+  return std::make_optional(stats->height_ + stats->num_leaf_pages_);
+}
+
 }  // namespace bustub
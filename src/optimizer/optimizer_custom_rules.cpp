@@ -11,8 +11,12 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   auto p = plan;
   p = OptimizeMergeProjection(p);
   p = OptimizeMergeFilterNLJ(p);
+  p = OptimizeNLJAsIndexJoin(p);
   p = OptimizeNLJAsHashJoin(p);
   p = OptimizeOrderByAsIndexScan(p);
+  p = OptimizeFilterAsIndexScan(p);
+  p = OptimizeIndexOnlyScan(p);
+  p = OptimizeMergeFilterScan(p);
   p = OptimizeSortLimitAsTopN(p);
   return p;
 }
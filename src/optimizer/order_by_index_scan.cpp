@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -33,11 +34,14 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     const auto &order_bys = sort_plan.GetOrderBy();
 
     std::vector<uint32_t> order_by_column_ids;
+    // All keys ascending (or default) scan forward, all keys descending scan backward
+    std::optional<IndexScanDirection> direction;
     for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+      auto key_direction = order_type == OrderByType::DESC ? IndexScanDirection::BACKWARD : IndexScanDirection::FORWARD;
+      if (order_type == OrderByType::INVALID || (direction.has_value() && *direction != key_direction)) {
         return optimized_plan;
       }
+      direction = key_direction;
 
       // Order expression is a column value expression
       const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
@@ -58,6 +62,9 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
+        if (index->index_type_ == IndexType::HashTableIndex) {
+          continue;
+        }
         const auto &columns = index->key_schema_.GetColumns();
         // check index key schema == order by columns
         bool valid = true;
@@ -69,7 +76,8 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
             }
           }
           if (valid) {
-            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_, std::nullopt,
+                                                       std::nullopt, direction.value_or(IndexScanDirection::FORWARD));
           }
         }
       }
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -107,6 +110,60 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return is_success;
 }
 
+/*
+ * Batched point query, the keys must be sorted in ascending order.
+ * The tree is descended for the first key only, a later key is looked up in the
+ * current leaf or found by walking the leaf chain to the right. A walk longer
+ * than the tree height costs more than a new descent, so it falls back to one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *txn) {
+  results->assign(keys.size(), {});
+  ReadPageGuard leaf_guard;
+  const LeafPage *leaf_page = nullptr;
+  size_t height = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    const auto &key = keys[i];
+    size_t hops = 0;
+    while (leaf_page != nullptr &&
+           (leaf_page->GetSize() == 0 || comparator_(key, leaf_page->KeyAt(leaf_page->GetSize() - 1)) > 0)) {
+      page_id_t next_page_id = leaf_page->GetNextPageId();
+      if (next_page_id == INVALID_PAGE_ID || hops == height) {
+        leaf_page = nullptr;
+        break;
+      }
+      // writers latch leaves in any order when merging, so never block on a sibling while holding a leaf
+      Page *next_page = bpm_->FetchPage(next_page_id);
+      if (next_page == nullptr || !next_page->TryRLatch()) {
+        if (next_page != nullptr) {
+          bpm_->UnpinPage(next_page_id, false);
+        }
+        leaf_page = nullptr;
+        break;
+      }
+      leaf_guard = ReadPageGuard(bpm_, next_page);
+      leaf_page = leaf_guard.template As<LeafPage>();
+      hops++;
+    }
+    if (leaf_page == nullptr) {
+      leaf_guard.Drop();
+      Context ctx;
+      if (GetKeyAt(key, comparator_, ctx) == INVALID_PAGE_ID) {
+        return;
+      }
+      height = ctx.access_set_.size();
+      leaf_guard = std::move(ctx.read_set_.back());
+      ctx.read_set_.pop_back();
+      leaf_page = leaf_guard.template As<LeafPage>();
+    }
+    int index = leaf_page->Lookup(key, comparator_);
+    if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+      (*results)[i].push_back(leaf_page->ValueAt(index));
+    }
+  }
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -160,6 +217,7 @@ auto BPLUSTREE_TYPE::InsertGetKeyAt(const KeyType &key, const KeyComparator &com
     p_leaf_page->SetPageType(IndexPageType::LEAF_PAGE);
     p_leaf_page->SetMaxSize(leaf_max_size_);
     p_leaf_page->SetNextPageId(INVALID_PAGE_ID);
+    p_leaf_page->SetPrevPageId(INVALID_PAGE_ID);
     p_leaf_page->SetSize(0);
     SetRootPageId(root_page_id, ctx);
     ctx.write_set_.push_back(std::move(write_guard));
@@ -214,7 +272,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   int index = leaf_page->Lookup(key, comparator_);
 
   // If the key already exists in the tree, return false.
-  if (index > 0 && index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+  if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
     // 已经存在
     is_success = false;
   } else {
@@ -231,6 +289,12 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
       leaf_page_new->SetSize(0);
       leaf_page_new->SetPageType(IndexPageType::LEAF_PAGE);
       leaf_page_new->SetNextPageId(leaf_page->GetNextPageId());
+      leaf_page_new->SetPrevPageId(leaf_page_id);
+      if (leaf_page->GetNextPageId() != INVALID_PAGE_ID) {
+        // latch order stays left to right, so fixing the right neighbour's back link can't deadlock
+        auto next_page_guard = bpm_->FetchPageWrite(leaf_page->GetNextPageId());
+        next_page_guard.template AsMut<B_PLUS_TREE_LEAF_PAGE_TYPE>()->SetPrevPageId(leaf_page_id_new);
+      }
       leaf_page->MoveHalfTo(leaf_page_new);
       // Determine whether to insert the new (key, value) pair in the old leaf page or the new leaf page.
       leaf_page->SetNextPageId(leaf_page_id_new);
@@ -503,6 +567,10 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
         auto *sibling_leaf_page = sibling_page_guard.AsMut<BPlusTree::LeafPage>();
         basic_leaf_page->MoveAllTo(sibling_leaf_page);
         sibling_leaf_page->SetNextPageId(basic_leaf_page->GetNextPageId());
+        if (basic_leaf_page->GetNextPageId() != INVALID_PAGE_ID) {
+          auto next_page_guard = bpm_->FetchPageWrite(basic_leaf_page->GetNextPageId());
+          next_page_guard.template AsMut<B_PLUS_TREE_LEAF_PAGE_TYPE>()->SetPrevPageId(sibling_id);
+        }
       }
       ctx.write_set_.push_back(std::move(parent_page_guard));
       RemoveEntry(parent_page_id, mid_key, ctx);
@@ -559,6 +627,8 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
           KeyType last_key = sibling_leaf_page->KeyAt(m);
           sibling_leaf_page->RemoveAt(m);
           basic_leaf_page->Insert(last_key, last_value, comparator_);
+          sibling_leaf_page->IncreaseVersion();
+          basic_leaf_page->IncreaseVersion();
           ReplaceKeyAt(parent_page, mid_key, last_key, ctx);
         }
       }
@@ -576,6 +646,34 @@ void BPLUSTREE_TYPE::SetTreeEmpty(Context &ctx) {
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const std::optional<KeyType> &key, bool rightmost) -> std::optional<ReadPageGuard> {
+  if (key.has_value()) {
+    Context ctx;
+    if (GetKeyAt(*key, comparator_, ctx) == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    ReadPageGuard leaf_guard = std::move(ctx.read_set_.back());
+    ctx.read_set_.clear();
+    return leaf_guard;
+  }
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
+  while (true) {
+    // crab down: the child is latched before the parent is released
+    ReadPageGuard child_guard = bpm_->FetchPageRead(page_id);
+    guard = std::move(child_guard);
+    const auto *page = guard.As<BPlusTree::InternalPage>();
+    if (page->IsLeafPage()) {
+      return guard;
+    }
+    page_id = page->ValueAt(rightmost ? page->GetSize() - 1 : 0);
+  }
+}
+
 /*
  * Input parameter is void, find the leftmost leaf page first, then construct
  * index iterator
@@ -583,47 +681,62 @@ void BPLUSTREE_TYPE::SetTreeEmpty(Context &ctx) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  Context ctx;
-  auto root_page_id = GetRootPageId();
-  //  ReadPageGuard root_page_guard = ctx.GetReadPageGuardAt(bpm_,root_page_id);
-  if (root_page_id == INVALID_PAGE_ID) {
+  auto leaf_guard = FindLeafRead(std::nullopt);
+  if (leaf_guard == std::nullopt) {
     return INDEXITERATOR_TYPE();
   }
-  BasicPageGuard root_page_guard = bpm_->FetchPageBasic(root_page_id);
-  auto *root_page = root_page_guard.As<BPlusTree::InternalPage>();
-  while (!root_page->IsLeafPage()) {
-    root_page_id = root_page->ValueAt(0);
-    if (root_page_id != INVALID_PAGE_ID) {
-      root_page_guard = bpm_->FetchPageBasic(root_page_id);
-      root_page = root_page_guard.As<BPlusTree::InternalPage>();
-    }
+  return INDEXITERATOR_TYPE(this, bpm_, comparator_, std::move(*leaf_guard), 0);
+}
+
+/*
+ * Input parameter is low key, find the leaf page that contains the first key
+ * which is not less than the input key, then construct index iterator
+ * @return : index iterator, End() if every key is less than the input key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  auto leaf_guard = FindLeafRead(key);
+  if (leaf_guard == std::nullopt) {
+    return INDEXITERATOR_TYPE();
   }
-  auto *leaf_page = root_page_guard.As<BPlusTree::LeafPage>();
-  return INDEXITERATOR_TYPE(bpm_, leaf_page, 0, std::move(root_page_guard));
+  // when every key of this leaf is smaller the index is past its end, and the iterator moves on to the next leaf
+  int index = leaf_guard->template As<BPlusTree::LeafPage>()->Lookup(key, comparator_);
+  return INDEXITERATOR_TYPE(this, bpm_, comparator_, std::move(*leaf_guard), index);
 }
 
 /*
- * Input parameter is low key, find the leaf page that contains the input key
- * first, then construct index iterator
+ * Input parameter is void, find the rightmost leaf page first, then construct
+ * a backward index iterator positioned at the largest key
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  Context ctx;
-  (void)ctx;
-  auto page_id = GetKeyAt(key, comparator_, ctx);
-  ctx.read_set_.clear();
-  if (page_id == INVALID_PAGE_ID) {
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE {
+  auto leaf_guard = FindLeafRead(std::nullopt, true);
+  if (leaf_guard == std::nullopt) {
     return INDEXITERATOR_TYPE();
   }
-  BasicPageGuard leaf_page_guard = bpm_->FetchPageBasic(page_id);
-  ctx.read_set_.pop_back();
-  const auto *leaf_page = leaf_page_guard.As<BPlusTree::LeafPage>();
-  int index = leaf_page->Lookup(key, comparator_);
-  if (comparator_(leaf_page->KeyAt(index), key) != 0) {
+  int index = leaf_guard->template As<BPlusTree::LeafPage>()->GetSize() - 1;
+  return INDEXITERATOR_TYPE(this, bpm_, comparator_, std::move(*leaf_guard), index, true);
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the last key
+ * which is not greater than the input key, then construct a backward index iterator
+ * @return : index iterator, End() if every key is greater than the input key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  auto leaf_guard = FindLeafRead(key);
+  if (leaf_guard == std::nullopt) {
     return INDEXITERATOR_TYPE();
   }
-  return INDEXITERATOR_TYPE(bpm_, leaf_page, index, std::move(leaf_page_guard));
+  const auto *leaf_page = leaf_guard->template As<BPlusTree::LeafPage>();
+  int index = leaf_page->Lookup(key, comparator_);
+  if (index >= leaf_page->GetSize() || comparator_(leaf_page->KeyAt(index), key) != 0) {
+    // when every key of this leaf is greater this is -1, and the iterator moves on to the previous leaf
+    index--;
+  }
+  return INDEXITERATOR_TYPE(this, bpm_, comparator_, std::move(*leaf_guard), index, true);
 }
 
 /*
@@ -632,7 +745,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(nullptr, nullptr, -1, BasicPageGuard()); }
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::SetRootPageId(page_id_t page_id, Context &ctx) {
@@ -653,6 +766,186 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
   return p_header_page->root_page_id_;
 }
 
+/*****************************************************************************
+ * STATISTICS AND MAINTENANCE
+ *****************************************************************************/
+/*
+ * Walk the tree level by level. The header page stays read latched for the whole walk so that the numbers describe
+ * one consistent tree; writers wait until the walk is done.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CollectStats() -> BPlusTreeStats {
+  BPlusTreeStats stats;
+  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t root_page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (root_page_id == INVALID_PAGE_ID) {
+    return stats;
+  }
+
+  // A leaf splits before it reaches its max size, so a full leaf holds max size - 1 entries.
+  const double leaf_capacity = std::max(leaf_max_size_ - 1, 1);
+  const double internal_capacity = internal_max_size_;
+  size_t internal_slots = 0;
+  std::vector<page_id_t> level{root_page_id};
+  while (!level.empty()) {
+    stats.height_++;
+    std::vector<page_id_t> next_level;
+    page_id_t prev_leaf_id = INVALID_PAGE_ID;
+    for (auto page_id : level) {
+      ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+      if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+        const auto *leaf = guard.As<LeafPage>();
+        auto size = static_cast<size_t>(leaf->GetSize());
+        stats.num_leaf_pages_++;
+        stats.num_entries_ += size;
+        auto bucket = static_cast<size_t>(size / leaf_capacity * BPlusTreeStats::FILL_BUCKETS);
+        stats.leaf_fill_histogram_[std::min(bucket, BPlusTreeStats::FILL_BUCKETS - 1)]++;
+        if (page_id != root_page_id && leaf->GetSize() < leaf->GetMinSize()) {
+          stats.num_underfull_leaves_++;
+        }
+        if (prev_leaf_id != INVALID_PAGE_ID && page_id != prev_leaf_id + 1) {
+          stats.num_leaf_discontinuities_++;
+        }
+        prev_leaf_id = page_id;
+        continue;
+      }
+      const auto *internal = guard.As<InternalPage>();
+      stats.num_internal_pages_++;
+      internal_slots += internal->GetSize();
+      for (int i = 0; i < internal->GetSize(); i++) {
+        next_level.push_back(internal->ValueAt(i));
+      }
+    }
+    level = std::move(next_level);
+  }
+
+  if (stats.num_leaf_pages_ > 0) {
+    stats.avg_leaf_fill_ = stats.num_entries_ / (leaf_capacity * stats.num_leaf_pages_);
+  }
+  if (stats.num_internal_pages_ > 0) {
+    stats.avg_internal_fill_ = internal_slots / (internal_capacity * stats.num_internal_pages_);
+  }
+  return stats;
+}
+
+/*
+ * Bulk load a packed copy of the tree and swap it in. The header page is write latched throughout, which keeps
+ * every other operation out of the tree while the old pages are read and freed. New pages are allocated in key
+ * order, so the leaves of the copy usually sit on consecutive page ids.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Rebuild() {
+  Context ctx;
+  ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
+  page_id_t root_page_id = ctx.header_page_->template As<BPlusTreeHeaderPage>()->root_page_id_;
+  auto freed = std::remove_if(retired_pages_.begin(), retired_pages_.end(),
+                              [this](page_id_t page_id) { return bpm_->DeletePage(page_id); });
+  retired_pages_.erase(freed, retired_pages_.end());
+  if (root_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+
+  std::vector<MappingType> entries;
+  std::vector<page_id_t> old_pages;
+  std::vector<page_id_t> level{root_page_id};
+  while (!level.empty()) {
+    std::vector<page_id_t> next_level;
+    for (auto page_id : level) {
+      old_pages.push_back(page_id);
+      ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+      if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+        const auto *leaf = guard.As<LeafPage>();
+        for (int i = 0; i < leaf->GetSize(); i++) {
+          entries.push_back(leaf->GetObjAt(i));
+        }
+        continue;
+      }
+      const auto *internal = guard.As<InternalPage>();
+      for (int i = 0; i < internal->GetSize(); i++) {
+        next_level.push_back(internal->ValueAt(i));
+      }
+    }
+    level = std::move(next_level);
+  }
+
+  // Split n items into the fewest groups of at most cap items, spreading the remainder so no group is underfull.
+  auto group_sizes = [](size_t n, size_t cap) {
+    size_t groups = (n + cap - 1) / cap;
+    std::vector<size_t> sizes(groups, n / groups);
+    for (size_t i = 0; i < n % groups; i++) {
+      sizes[i]++;
+    }
+    return sizes;
+  };
+
+  page_id_t new_root_id = INVALID_PAGE_ID;
+  if (!entries.empty()) {
+    // (first key, page id) of every node on the level being built
+    std::vector<std::pair<KeyType, page_id_t>> nodes;
+    page_id_t prev_leaf_id = INVALID_PAGE_ID;
+    WritePageGuard prev_leaf_guard;
+    size_t pos = 0;
+    for (auto size : group_sizes(entries.size(), std::max(leaf_max_size_ - 1, 1))) {
+      page_id_t leaf_id;
+      bpm_->NewPageGuarded(&leaf_id);
+      auto leaf_guard = bpm_->FetchPageWrite(leaf_id);
+      auto *leaf = leaf_guard.AsMut<LeafPage>();
+      leaf->SetPageType(IndexPageType::LEAF_PAGE);
+      leaf->SetMaxSize(leaf_max_size_);
+      leaf->SetSize(0);
+      leaf->SetNextPageId(INVALID_PAGE_ID);
+      leaf->SetPrevPageId(prev_leaf_id);
+      for (size_t i = 0; i < size; i++, pos++) {
+        leaf->Insert(entries[pos].first, entries[pos].second, comparator_);
+      }
+      if (prev_leaf_id != INVALID_PAGE_ID) {
+        prev_leaf_guard.AsMut<LeafPage>()->SetNextPageId(leaf_id);
+      }
+      nodes.emplace_back(leaf->KeyAt(0), leaf_id);
+      prev_leaf_id = leaf_id;
+      prev_leaf_guard = std::move(leaf_guard);
+    }
+    prev_leaf_guard.Drop();
+
+    while (nodes.size() > 1) {
+      std::vector<std::pair<KeyType, page_id_t>> parents;
+      pos = 0;
+      for (auto size : group_sizes(nodes.size(), internal_max_size_)) {
+        page_id_t internal_id;
+        bpm_->NewPageGuarded(&internal_id);
+        auto internal_guard = bpm_->FetchPageWrite(internal_id);
+        auto *internal = internal_guard.AsMut<InternalPage>();
+        internal->SetPageType(IndexPageType::INTERNAL_PAGE);
+        internal->SetMaxSize(internal_max_size_);
+        internal->SetSize(0);
+        internal->InsertFirstOf(nodes[pos].second);
+        parents.emplace_back(nodes[pos].first, internal_id);
+        for (size_t i = 1; i < size; i++) {
+          internal->Insert(nodes[pos + i].first, nodes[pos + i].second, comparator_);
+        }
+        pos += size;
+      }
+      nodes = std::move(parents);
+    }
+    new_root_id = nodes[0].second;
+  }
+
+  SetRootPageId(new_root_id, ctx);
+  // Bumping the leaf versions sends open iterators back through the new root. A page an iterator still pins cannot
+  // be freed yet, it is retired and freed by a later rebuild once the iterator has moved on.
+  for (auto page_id : old_pages) {
+    {
+      WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+      if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+        guard.AsMut<LeafPage>()->IncreaseVersion();
+      }
+    }
+    if (!bpm_->DeletePage(page_id)) {
+      retired_pages_.push_back(page_id);
+    }
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -9,6 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -30,6 +33,7 @@ auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  modifications_++;
   return container_->Insert(index_key, rid, transaction);
 }
 
@@ -39,6 +43,7 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  modifications_++;
   container_->Remove(index_key, transaction);
 }
 
@@ -51,6 +56,31 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i]);
+  }
+  // probe in key order, then hand the results back in the order of the input keys
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t lhs, size_t rhs) { return comparator_(index_keys[lhs], index_keys[rhs]) < 0; });
+  std::vector<KeyType> sorted_keys;
+  sorted_keys.reserve(keys.size());
+  for (auto i : order) {
+    sorted_keys.push_back(index_keys[i]);
+  }
+  std::vector<std::vector<RID>> sorted_results;
+  container_->GetValues(sorted_keys, &sorted_results, transaction);
+  results->assign(keys.size(), {});
+  for (size_t i = 0; i < order.size(); i++) {
+    (*results)[order[i]] = std::move(sorted_results[i]);
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
@@ -60,6 +90,72 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() -> INDEXITERATOR_TYPE { return container_->RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE {
+  return container_->RBegin(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRangeIterator(const std::optional<KeyType> &lower, bool lower_inclusive,
+                                            const std::optional<KeyType> &upper, bool upper_inclusive, bool reverse)
+    -> INDEXITERATOR_TYPE {
+  // the iteration starts from `start` and stops once it passes `stop`
+  const auto &start = reverse ? upper : lower;
+  const auto &stop = reverse ? lower : upper;
+  bool start_inclusive = reverse ? upper_inclusive : lower_inclusive;
+  bool stop_inclusive = reverse ? lower_inclusive : upper_inclusive;
+
+  INDEXITERATOR_TYPE iterator;
+  if (start == std::nullopt) {
+    iterator = reverse ? container_->RBegin() : container_->Begin();
+  } else {
+    iterator = reverse ? container_->RBegin(*start) : container_->Begin(*start);
+    while (!start_inclusive && !iterator.IsEnd() && comparator_((*iterator).first, *start) == 0) {
+      ++iterator;
+    }
+  }
+  if (stop != std::nullopt) {
+    iterator.SetStopKey(*stop, stop_inclusive, comparator_);
+  }
+  return iterator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::CollectStats() -> BPlusTreeStats {
+  std::scoped_lock lock(stats_mutex_);
+  modifications_ = 0;
+  stats_ = container_->CollectStats();
+  return *stats_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetCachedStats() -> std::optional<BPlusTreeStats> {
+  std::scoped_lock lock(stats_mutex_);
+  if (stats_.has_value() && modifications_ <= stats_->num_entries_ * STATS_STALE_RATIO) {
+    return stats_;
+  }
+  return std::nullopt;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::NeedsRebuild() -> bool {
+  // Only REINDEX asks, so the tree may be walked here
+  auto stats = GetCachedStats();
+  if (!stats.has_value()) {
+    stats = CollectStats();
+  }
+  return stats->num_leaf_pages_ > 1 && stats->avg_leaf_fill_ < REBUILD_FILL_THRESHOLD;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::Rebuild() {
+  container_->Rebuild();
+  CollectStats();
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
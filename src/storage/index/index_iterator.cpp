@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -14,45 +15,143 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, const B_PLUS_TREE_LEAF_PAGE_TYPE *page, int index,
-                                  BasicPageGuard page_guard) {
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                                  const KeyComparator &comparator, ReadPageGuard leaf_guard, int index, bool reverse) {
+  tree_ = tree;
   bpm_ = bpm;
-  page_ = page;
+  reverse_ = reverse;
+  comparator_.emplace(comparator);
+  Load(std::move(leaf_guard));
   index_ = index;
-  page_guard_ = std::move(page_guard);
+  if (index_ < 0 || index_ >= static_cast<int>(buffer_.size())) {
+    NextLeaf();
+  }
 }
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  bool is_end = false;
-  if ((page_ == nullptr) && (bpm_ == nullptr) && index_ == -1) {
-    is_end = true;
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_id_ == INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return buffer_[index_]; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  index_ += reverse_ ? -1 : 1;
+  if (index_ < 0 || index_ >= static_cast<int>(buffer_.size())) {
+    NextLeaf();
   }
-  return is_end;
+  CheckStopKey();
+  return *this;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return page_->GetObjAt(index_); }
+void INDEXITERATOR_TYPE::Load(ReadPageGuard leaf_guard) {
+  const auto *leaf = leaf_guard.template As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
+  page_id_ = leaf_guard.PageId();
+  // pin before the latch goes, so a merge can't free the page while it is still ours
+  pin_ = bpm_->FetchPageBasic(page_id_);
+  version_ = leaf->GetVersion();
+  buffer_.clear();
+  buffer_.reserve(leaf->GetSize());
+  for (int i = 0; i < leaf->GetSize(); i++) {
+    buffer_.push_back(leaf->GetObjAt(i));
+  }
+  page_id_t sibling_page_id = reverse_ ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+  leaf_guard.Drop();
+  if (sibling_page_id != INVALID_PAGE_ID) {
+    bpm_->PrefetchPage(sibling_page_id);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  if (index_ + 1 >= page_->GetSize()) {
-    page_id_t next_page_id = page_->GetNextPageId();
-    if (next_page_id != INVALID_PAGE_ID) {
-      page_guard_ = bpm_->FetchPageBasic(next_page_id);
-      page_ = page_guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
-      index_ = 0;
-    } else {
-      page_ = nullptr;
-      index_ = -1;
-      bpm_ = nullptr;
+void INDEXITERATOR_TYPE::NextLeaf() {
+  while (true) {
+    // without a key to resume from, the copied leaf was empty and only an empty root leaf can be
+    std::optional<KeyType> last_key;
+    if (!buffer_.empty()) {
+      last_key = reverse_ ? buffer_.front().first : buffer_.back().first;
+    }
+    ReadPageGuard leaf_guard = bpm_->FetchPageRead(page_id_);
+    const auto *leaf = leaf_guard.template As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
+    if (leaf->GetVersion() != version_) {
+      leaf_guard.Drop();
+      if (last_key.has_value()) {
+        Reseek(*last_key);
+      } else {
+        SetEnd();
+      }
+      return;
+    }
+    page_id_t sibling_page_id = reverse_ ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+    if (sibling_page_id == INVALID_PAGE_ID) {
+      SetEnd();
+      return;
+    }
+    // writers latch leaves in any order when merging, so never block on a sibling while holding a leaf
+    Page *sibling_page = bpm_->FetchPage(sibling_page_id, AccessType::Scan);
+    if (sibling_page == nullptr || !sibling_page->TryRLatch()) {
+      if (sibling_page != nullptr) {
+        bpm_->UnpinPage(sibling_page_id, false, AccessType::Scan);
+      }
+      leaf_guard.Drop();
+      if (last_key.has_value()) {
+        Reseek(*last_key);
+      } else {
+        SetEnd();
+      }
+      return;
+    }
+    leaf_guard.Drop();
+    Load(ReadPageGuard(bpm_, sibling_page));
+    if (!buffer_.empty()) {
+      index_ = reverse_ ? static_cast<int>(buffer_.size()) - 1 : 0;
+      return;
     }
-  } else {
-    index_++;
   }
-  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Reseek(const KeyType &last_key) {
+  auto stop_key = std::move(stop_key_);
+  bool stop_inclusive = stop_inclusive_;
+  *this = reverse_ ? tree_->RBegin(last_key) : tree_->Begin(last_key);
+  stop_key_ = std::move(stop_key);
+  stop_inclusive_ = stop_inclusive;
+  while (!IsEnd() && (*comparator_)(buffer_[index_].first, last_key) == 0) {
+    ++(*this);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetStopKey(const KeyType &stop_key, bool inclusive, const KeyComparator &comparator) {
+  stop_key_ = stop_key;
+  stop_inclusive_ = inclusive;
+  comparator_.emplace(comparator);
+  CheckStopKey();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetEnd() {
+  pin_.Drop();
+  buffer_.clear();
+  page_id_ = INVALID_PAGE_ID;
+  index_ = -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckStopKey() {
+  if (IsEnd() || stop_key_ == std::nullopt) {
+    return;
+  }
+  int cmp = (*comparator_)(buffer_[index_].first, *stop_key_);
+  if (reverse_) {
+    cmp = -cmp;
+  }
+  if (cmp > 0 || (cmp == 0 && !stop_inclusive_)) {
+    SetEnd();
+  }
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
@@ -29,13 +29,31 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) { SetMaxSize(max_size); }
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and previous page id
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+  IncreaseVersion();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+  prev_page_id_ = prev_page_id;
+  IncreaseVersion();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetVersion() const -> uint32_t { return version_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::IncreaseVersion() { version_++; }
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
@@ -72,6 +90,8 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetObjAt(int index) const -> const MappingType
 }
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(B_PLUS_TREE_LEAF_PAGE_TYPE *recipient) {
+  IncreaseVersion();
+  recipient->IncreaseVersion();
   int n = GetSize();
   if (n >= 1) {
     MappingType tmp = array_[0];
@@ -87,6 +107,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(B_PLUS_TREE_LEAF_PAGE_TYPE *re
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(B_PLUS_TREE_LEAF_PAGE_TYPE *recipient) {
+  IncreaseVersion();
+  recipient->IncreaseVersion();
   int n = GetSize();
   int rn = recipient->GetSize();
   BUSTUB_ASSERT(n + rn < GetMaxSize(), "leafPage MoveAllto function error because n+rn>=MaxSize");
@@ -99,6 +121,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(B_PLUS_TREE_LEAF_PAGE_TYPE *recipient
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(B_PLUS_TREE_LEAF_PAGE_TYPE *recipient) {
+  IncreaseVersion();
+  recipient->IncreaseVersion();
   int n = GetSize();
   int rn = recipient->GetSize();
   if (rn + n / 2 >= recipient->GetMaxSize()) {
@@ -114,6 +138,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(B_PLUS_TREE_LEAF_PAGE_TYPE *recipien
 }
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveEndToFrontOf(B_PLUS_TREE_LEAF_PAGE_TYPE *recipient) {
+  IncreaseVersion();
+  recipient->IncreaseVersion();
   int n = recipient->GetSize();
   BUSTUB_ASSERT(n + 1 < recipient->GetMaxSize(), "MoveEndToFrontOf recipient full");
   MappingType tmp = recipient->array_[0];
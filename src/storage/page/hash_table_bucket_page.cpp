@@ -10,6 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "storage/page/hash_table_bucket_page.h"
 #include "common/logger.h"
 #include "common/util/hash_util.h"
@@ -20,62 +28,147 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::MatchFingerprints(uint32_t group_start, uint8_t fingerprint) const -> uint32_t {
+  // A group starts on a byte boundary of the bitmaps and spans two of their bytes
+  uint32_t readable = static_cast<uint8_t>(readable_[group_start / 8]);
+  if (group_start / 8 + 1 < sizeof(readable_)) {
+    readable |= static_cast<uint32_t>(static_cast<uint8_t>(readable_[group_start / 8 + 1])) << 8;
+  }
+#if defined(__SSE2__)
+  if (group_start + PROBE_GROUP_SIZE <= BUCKET_ARRAY_SIZE) {
+    __m128i slots = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + group_start));
+    __m128i matches = _mm_cmpeq_epi8(slots, _mm_set1_epi8(static_cast<char>(fingerprint)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(matches)) & readable;
+  }
+#endif
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < PROBE_GROUP_SIZE && group_start + i < BUCKET_ARRAY_SIZE; i++) {
+    if (fingerprints_[group_start + i] == fingerprint) {
+      matches |= 1U << i;
+    }
+  }
+  return matches & readable;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result,
+                                      uint8_t fingerprint) const -> bool {
+  bool found = false;
+  // Slots are filled from the front, so nothing lives past the first never-occupied slot
+  for (uint32_t group_start = 0; group_start < BUCKET_ARRAY_SIZE && IsOccupied(group_start);
+       group_start += PROBE_GROUP_SIZE) {
+    for (uint32_t matches = MatchFingerprints(group_start, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_start + __builtin_ctz(matches);
+      if (cmp(array_[bucket_idx].first, key) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) -> bool {
+  for (uint32_t group_start = 0; group_start < BUCKET_ARRAY_SIZE && IsOccupied(group_start);
+       group_start += PROBE_GROUP_SIZE) {
+    for (uint32_t matches = MatchFingerprints(group_start, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_start + __builtin_ctz(matches);
+      if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+        return false;
+      }
+    }
+  }
+  // Occupied slots form a prefix, so the first unreadable slot is either a tombstone or the first unused one
+  auto *free_byte = std::find_if(std::begin(readable_), std::end(readable_),
+                                 [](char byte) { return static_cast<uint8_t>(byte) != 0xFF; });
+  if (free_byte == std::end(readable_)) {
+    return false;
+  }
+  uint32_t free_idx = (free_byte - std::begin(readable_)) * 8 + __builtin_ctz(~static_cast<uint8_t>(*free_byte));
+  if (free_idx >= BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  fingerprints_[free_idx] = fingerprint;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) -> bool {
+  for (uint32_t group_start = 0; group_start < BUCKET_ARRAY_SIZE && IsOccupied(group_start);
+       group_start += PROBE_GROUP_SIZE) {
+    for (uint32_t matches = MatchFingerprints(group_start, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_start + __builtin_ctz(matches);
+      if (cmp(array_[bucket_idx].first, key) == 0 && array_[bucket_idx].second == value) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+auto HASH_TABLE_BUCKET_TYPE::FingerprintAt(uint32_t bucket_idx) const -> uint8_t {
+  return fingerprints_[bucket_idx];
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  // The slot stays occupied as a tombstone so that scans keep going past it
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::IsFull() const -> bool {
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+auto HASH_TABLE_BUCKET_TYPE::NumReadable() const -> uint32_t {
+  uint32_t num_readable = 0;
+  for (auto byte : readable_) {
+    num_readable += std::bitset<8>(static_cast<unsigned char>(byte)).count();
+  }
+  return num_readable;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::IsEmpty() const -> bool {
+  return std::all_of(std::begin(readable_), std::end(readable_), [](char byte) { return byte == 0; });
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -16,19 +16,106 @@
 #include <cstring>
 #include <optional>
 #include <tuple>
+#include <vector>
+
 #include "common/config.h"
 #include "common/exception.h"
+#include "common/macros.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return the bytes a serialized varlen value occupies, its length included */
+auto VarlenSize(const char *data) -> uint32_t {
+  auto len = *reinterpret_cast<const uint32_t *>(data);
+  if (len == BUSTUB_VALUE_NULL) {
+    return sizeof(uint32_t);
+  }
+  if ((len & VARLEN_OVERFLOW_FLAG) != 0) {
+    return VARLEN_OVERFLOW_POINTER_SIZE;
+  }
+  if ((len & VARLEN_DICTIONARY_FLAG) != 0) {
+    return VARLEN_DICTIONARY_CODE_SIZE;
+  }
+  return sizeof(uint32_t) + len;
+}
+
+}  // namespace
+
 void TablePage::Init() {
   next_page_id_ = INVALID_PAGE_ID;
   num_tuples_ = 0;
   num_deleted_tuples_ = 0;
+  pax_capacity_ = 0;
+  num_columns_ = 0;
+}
+
+void TablePage::InitPax(const Schema &schema) {
+  Init();
+  num_columns_ = schema.GetColumnCount();
+  size_t directory_size = sizeof(MiniPage) * num_columns_;
+  size_t row_size = TUPLE_INFO_SIZE;
+  size_t varlen_size = 0;
+  for (const auto &col : schema.GetColumns()) {
+    row_size += col.IsInlined() ? col.GetFixedLength() : sizeof(uint32_t);
+    varlen_size += col.IsInlined() ? 0 : sizeof(uint32_t) + std::min<size_t>(col.GetLength(), PAX_VARLEN_ESTIMATE);
+  }
+  row_size += std::max<size_t>(varlen_size, TUPLE_MIN_FOOTPRINT);
+  BUSTUB_ENSURE(TABLE_PAGE_HEADER_SIZE + directory_size + row_size <= BUSTUB_PAGE_SIZE,
+                "tuples of this schema do not fit in a PAX page");
+  pax_capacity_ = (BUSTUB_PAGE_SIZE - TABLE_PAGE_HEADER_SIZE - directory_size) / row_size;
+
+  auto minipages = reinterpret_cast<MiniPage *>(page_start_ + TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * pax_capacity_);
+  size_t offset = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * pax_capacity_ + directory_size;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = schema.GetColumn(i);
+    minipages[i].offset_ = offset;
+    minipages[i].width_ = col.GetFixedLength();
+    minipages[i].stored_width_ = col.IsInlined() ? col.GetFixedLength() : sizeof(uint32_t);
+    offset += minipages[i].stored_width_ * pax_capacity_;
+  }
+}
+
+auto TablePage::GetDataStart(uint32_t num_slots) const -> size_t {
+  if (!IsPax()) {
+    return TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * num_slots;
+  }
+  const auto &last = GetMiniPages()[num_columns_ - 1];
+  return last.offset_ + last.stored_width_ * pax_capacity_;
+}
+
+auto TablePage::GetFixedLength() const -> uint16_t {
+  uint16_t length = 0;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    length += GetMiniPages()[i].width_;
+  }
+  return length;
+}
+
+auto TablePage::GetSlotData(const Tuple &tuple) const -> std::pair<const char *, uint16_t> {
+  if (!IsPax()) {
+    return {tuple.data_.data(), tuple.GetLength()};
+  }
+  auto fixed_length = GetFixedLength();
+  BUSTUB_ASSERT(tuple.GetLength() >= fixed_length, "tuple does not match the schema of the page");
+  return {tuple.data_.data() + fixed_length, tuple.GetLength() - fixed_length};
+}
+
+void TablePage::WriteColumns(uint32_t slot, const char *data) {
+  auto minipages = GetMiniPages();
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &minipage = minipages[i];
+    memcpy(page_start_ + minipage.offset_ + minipage.stored_width_ * slot, data, minipage.stored_width_);
+    data += minipage.width_;
+  }
 }
 
 auto TablePage::GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t> {
+  if (IsPax() && num_tuples_ == pax_capacity_) {
+    return std::nullopt;
+  }
   size_t slot_end_offset;
   if (num_tuples_ > 0) {
     auto &[offset, size, meta] = tuple_info_[num_tuples_ - 1];
@@ -36,23 +123,45 @@ auto TablePage::GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) co
   } else {
     slot_end_offset = BUSTUB_PAGE_SIZE;
   }
-  auto tuple_offset = slot_end_offset - tuple.GetLength();
-  auto offset_size = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * (num_tuples_ + 1);
+  auto offset_size = GetDataStart(num_tuples_ + 1);
+  auto footprint = Footprint(GetSlotData(tuple).second);
+  if (footprint > slot_end_offset) {
+    return std::nullopt;
+  }
+  auto tuple_offset = slot_end_offset - footprint;
   if (tuple_offset < offset_size) {
     return std::nullopt;
   }
   return tuple_offset;
 }
 
+auto TablePage::GetFreeSpaceRemaining() const -> uint16_t {
+  if (IsPax() && num_tuples_ == pax_capacity_) {
+    return 0;
+  }
+  size_t slot_end_offset = num_tuples_ > 0 ? std::get<0>(tuple_info_[num_tuples_ - 1]) : BUSTUB_PAGE_SIZE;
+  auto offset_size = GetDataStart(num_tuples_ + 1);
+  if (slot_end_offset <= offset_size) {
+    return 0;
+  }
+  // The fixed-size part of a PAX tuple has its room in the minipages already
+  auto free = slot_end_offset - offset_size + (IsPax() ? GetFixedLength() : 0);
+  return std::min<size_t>(free, BUSTUB_PAGE_SIZE);
+}
+
 auto TablePage::InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::optional<uint16_t> {
   auto tuple_offset = GetNextTupleOffset(meta, tuple);
   if (tuple_offset == std::nullopt) {
     return std::nullopt;
   }
+  auto [data, size] = GetSlotData(tuple);
   auto tuple_id = num_tuples_;
-  tuple_info_[tuple_id] = std::make_tuple(*tuple_offset, tuple.GetLength(), meta);
+  tuple_info_[tuple_id] = std::make_tuple(*tuple_offset, size, meta);
   num_tuples_++;
-  memcpy(page_start_ + *tuple_offset, tuple.data_.data(), tuple.GetLength());
+  memcpy(page_start_ + *tuple_offset, data, size);
+  if (IsPax()) {
+    WriteColumns(tuple_id, tuple.data_.data());
+  }
   return tuple_id;
 }
 
@@ -64,8 +173,14 @@ void TablePage::UpdateTupleMeta(const TupleMeta &meta, const RID &rid) {
   auto &[offset, size, old_meta] = tuple_info_[tuple_id];
   if (!old_meta.is_deleted_ && meta.is_deleted_) {
     num_deleted_tuples_++;
+  } else if (old_meta.is_deleted_ && !meta.is_deleted_) {
+    num_deleted_tuples_--;
   }
-  tuple_info_[tuple_id] = std::make_tuple(offset, size, meta);
+  // How the slot stores its tuple is up to the page, callers only change the logical state
+  auto new_meta = meta;
+  new_meta.is_forwarded_ = old_meta.is_forwarded_;
+  new_meta.is_moved_ = old_meta.is_moved_;
+  tuple_info_[tuple_id] = std::make_tuple(offset, size, new_meta);
 }
 
 auto TablePage::GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple> {
@@ -75,12 +190,64 @@ auto TablePage::GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple> {
   }
   auto &[offset, size, meta] = tuple_info_[tuple_id];
   Tuple tuple;
-  tuple.data_.resize(size);
-  memmove(tuple.data_.data(), page_start_ + offset, size);
+  if (!IsPax()) {
+    tuple.data_.resize(size);
+    memmove(tuple.data_.data(), page_start_ + offset, size);
+  } else {
+    // Gather the fixed-size columns from the minipages in front of the varlen part
+    auto fixed_length = GetFixedLength();
+    tuple.data_.assign(fixed_length + size, 0);
+    auto data = tuple.data_.data();
+    auto minipages = GetMiniPages();
+    for (uint32_t i = 0; i < num_columns_; i++) {
+      const auto &minipage = minipages[i];
+      memcpy(data, page_start_ + minipage.offset_ + minipage.stored_width_ * tuple_id, minipage.stored_width_);
+      data += minipage.width_;
+    }
+    memcpy(data, page_start_ + offset, size);
+  }
   tuple.rid_ = rid;
   return std::make_pair(meta, std::move(tuple));
 }
 
+auto TablePage::GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView> {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  BUSTUB_ASSERT(!IsPax(), "tuples of a PAX page are not stored contiguously");
+  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  return std::make_pair(meta, TupleView(page_start_ + offset, size, rid));
+}
+
+auto TablePage::GetTupleColumns(const RID &rid, const Schema &schema, const std::vector<uint32_t> &column_ids,
+                                std::vector<char> *buf) const -> std::pair<TupleMeta, TupleView> {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  BUSTUB_ASSERT(IsPax(), "only PAX pages store columns apart");
+  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  auto fixed_length = schema.GetLength();
+  buf->assign(fixed_length, 0);
+  auto minipages = GetMiniPages();
+  for (auto col_idx : column_ids) {
+    const auto &col = schema.GetColumn(col_idx);
+    const auto &minipage = minipages[col_idx];
+    const char *src = page_start_ + minipage.offset_ + minipage.stored_width_ * tuple_id;
+    if (col.IsInlined()) {
+      memcpy(buf->data() + col.GetOffset(), src, minipage.stored_width_);
+      continue;
+    }
+    // A varlen value is copied out of the varlen part on its own, and the copy is pointed to
+    auto value = page_start_ + offset + (*reinterpret_cast<const uint32_t *>(src) - fixed_length);
+    uint32_t value_offset = buf->size();
+    memcpy(buf->data() + col.GetOffset(), &value_offset, sizeof(uint32_t));
+    buf->insert(buf->end(), value, value + VarlenSize(value));
+  }
+  return std::make_pair(meta, TupleView(buf->data(), buf->size(), rid));
+}
+
 auto TablePage::GetTupleMeta(const RID &rid) const -> TupleMeta {
   auto tuple_id = rid.GetSlotNum();
   if (tuple_id >= num_tuples_) {
@@ -96,14 +263,138 @@ void TablePage::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tup
     throw bustub::Exception("Tuple ID out of range");
   }
   auto &[offset, size, old_meta] = tuple_info_[tuple_id];
-  if (size != tuple.GetLength()) {
+  auto [data, data_size] = GetSlotData(tuple);
+  if (size != data_size) {
     throw bustub::Exception("Tuple size mismatch");
   }
   if (!old_meta.is_deleted_ && meta.is_deleted_) {
     num_deleted_tuples_++;
   }
   tuple_info_[tuple_id] = std::make_tuple(offset, size, meta);
-  memcpy(page_start_ + offset, tuple.data_.data(), tuple.GetLength());
+  memcpy(page_start_ + offset, data, data_size);
+  if (IsPax()) {
+    WriteColumns(tuple_id, tuple.data_.data());
+  }
+}
+
+auto TablePage::UpdateTupleInPlace(const Tuple &tuple, const RID &rid) -> bool {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  auto [data, data_size] = GetSlotData(tuple);
+  if (Footprint(data_size) <= StoredFootprint(tuple_id)) {
+    size = data_size;
+    memcpy(page_start_ + offset, data, size);
+  } else {
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < num_tuples_; i++) {
+      used += i == tuple_id ? Footprint(data_size) : StoredFootprint(i);
+    }
+    if (GetDataStart(num_tuples_) + used > BUSTUB_PAGE_SIZE) {
+      return false;
+    }
+    Rewrite(tuple_id, data, data_size);
+  }
+  if (IsPax()) {
+    WriteColumns(tuple_id, tuple.data_.data());
+  }
+  std::get<2>(tuple_info_[tuple_id]).is_forwarded_ = false;
+  return true;
+}
+
+void TablePage::SetForward(const RID &rid, const RID &target) {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  page_id_t page_id = target.GetPageId();
+  uint32_t slot_num = target.GetSlotNum();
+  memcpy(page_start_ + offset, &page_id, sizeof(page_id_t));
+  memcpy(page_start_ + offset + sizeof(page_id_t), &slot_num, sizeof(uint32_t));
+  size = TUPLE_MIN_FOOTPRINT;
+  meta.is_forwarded_ = true;
+}
+
+auto TablePage::GetForward(const RID &rid) const -> RID {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  BUSTUB_ASSERT(meta.is_forwarded_, "tuple is not forwarded");
+  page_id_t page_id;
+  uint32_t slot_num;
+  memcpy(&page_id, page_start_ + offset, sizeof(page_id_t));
+  memcpy(&slot_num, page_start_ + offset + sizeof(page_id_t), sizeof(uint32_t));
+  return {page_id, slot_num};
+}
+
+void TablePage::Rewrite(uint32_t slot, const char *data, uint16_t size) {
+  // The tuples may move either way, so they are laid out again from a copy of the page
+  std::vector<char> old_page(page_start_, page_start_ + BUSTUB_PAGE_SIZE);
+  uint16_t end = BUSTUB_PAGE_SIZE;
+  for (uint32_t i = 0; i < num_tuples_; i++) {
+    auto &[offset, old_size, meta] = tuple_info_[i];
+    const char *src = i == slot ? data : old_page.data() + offset;
+    auto new_size = i == slot ? size : old_size;
+    end -= i == slot ? Footprint(new_size) : StoredFootprint(i);
+    memcpy(page_start_ + end, src, new_size);
+    offset = end;
+    old_size = new_size;
+  }
+}
+
+auto TablePage::GetReclaimableBytes() const -> uint32_t {
+  uint32_t bytes = 0;
+  for (uint32_t i = 0; i < num_tuples_; i++) {
+    auto &[offset, size, meta] = tuple_info_[i];
+    if (IsReclaimable(meta)) {
+      bytes += StoredFootprint(i);
+    }
+  }
+  return bytes;
+}
+
+auto TablePage::Compact() -> uint32_t {
+  if (num_tuples_ == 0) {
+    return 0;
+  }
+  auto old_end = std::get<0>(tuple_info_[num_tuples_ - 1]);
+  // Tuples are stored in slot order from the end of the page, so every move goes towards a higher offset and never
+  // overwrites a tuple that is still to be moved.
+  uint16_t end = BUSTUB_PAGE_SIZE;
+  for (uint32_t i = 0; i < num_tuples_; i++) {
+    auto &[offset, size, meta] = tuple_info_[i];
+    if (IsReclaimable(meta)) {
+      offset = end;
+      size = 0;
+      // A reclaimed slot no longer holds a forwarding pointer
+      meta.is_forwarded_ = false;
+      continue;
+    }
+    auto new_offset = static_cast<uint16_t>(end - StoredFootprint(i));
+    if (new_offset != offset) {
+      memmove(page_start_ + new_offset, page_start_ + offset, size);
+      offset = new_offset;
+    }
+    end = new_offset;
+  }
+  return end - old_end;
+}
+
+auto TablePage::IsVacant() const -> bool {
+  if (num_tuples_ == 0 || num_deleted_tuples_ != num_tuples_) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num_tuples_; i++) {
+    if (StoredFootprint(i) != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 }  // namespace bustub
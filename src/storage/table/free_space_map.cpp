@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+namespace bustub {
+
+auto FreeSpaceMap::Claim(uint32_t size) -> std::optional<page_id_t> {
+  if (size > BUSTUB_PAGE_SIZE) {
+    return std::nullopt;
+  }
+  std::scoped_lock guard(latch_);
+  auto it = by_free_bytes_.lower_bound({static_cast<uint16_t>(size), INVALID_PAGE_ID});
+  if (it == by_free_bytes_.end()) {
+    return std::nullopt;
+  }
+  auto page_id = it->second;
+  by_free_bytes_.erase(it);
+  free_bytes_.erase(page_id);
+  claimed_.insert(page_id);
+  return page_id;
+}
+
+void FreeSpaceMap::Release(page_id_t page_id, uint16_t free_bytes) {
+  std::scoped_lock guard(latch_);
+  claimed_.erase(page_id);
+  RecordLatched(page_id, free_bytes);
+}
+
+void FreeSpaceMap::MarkClaimed(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  claimed_.insert(page_id);
+}
+
+void FreeSpaceMap::Update(page_id_t page_id, uint16_t free_bytes) {
+  std::scoped_lock guard(latch_);
+  if (claimed_.count(page_id) == 0) {
+    RecordLatched(page_id, free_bytes);
+  }
+}
+
+auto FreeSpaceMap::Remove(page_id_t page_id) -> bool {
+  std::scoped_lock guard(latch_);
+  if (claimed_.count(page_id) != 0) {
+    return false;
+  }
+  if (auto it = free_bytes_.find(page_id); it != free_bytes_.end()) {
+    by_free_bytes_.erase({it->second, page_id});
+    free_bytes_.erase(it);
+  }
+  return true;
+}
+
+auto FreeSpaceMap::GetFreeSpace(page_id_t page_id) -> std::optional<uint16_t> {
+  std::scoped_lock guard(latch_);
+  auto it = free_bytes_.find(page_id);
+  if (it == free_bytes_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void FreeSpaceMap::RecordLatched(page_id_t page_id, uint16_t free_bytes) {
+  if (auto it = free_bytes_.find(page_id); it != free_bytes_.end()) {
+    by_free_bytes_.erase({it->second, page_id});
+  }
+  free_bytes_[page_id] = free_bytes;
+  by_free_bytes_.emplace(free_bytes, page_id);
+}
+
+}  // namespace bustub
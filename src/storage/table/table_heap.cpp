@@ -10,9 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <mutex>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -20,82 +22,601 @@
 #include "common/macros.h"
 #include "concurrency/transaction.h"
 #include "fmt/format.h"
+#include "storage/page/overflow_page.h"
 #include "storage/page/page_guard.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
-TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
+TableHeap::TableHeap(BufferPoolManager *bpm, const Schema *schema, TableFormat format, TableEncoding encoding)
+    : bpm_(bpm), schema_(schema != nullptr ? std::make_unique<const Schema>(*schema) : nullptr), format_(format) {
+  BUSTUB_ENSURE(format_ == TableFormat::ROW || schema_ != nullptr, "PAX pages need the schema of the table");
+  BUSTUB_ENSURE(encoding == TableEncoding::PLAIN || schema_ != nullptr, "dictionary encoding needs the schema");
+  if (schema_ != nullptr) {
+    zone_map_ = std::make_unique<ZoneMap>(schema_.get());
+  }
+  if (encoding == TableEncoding::DICTIONARY) {
+    dictionary_ = std::make_unique<Dictionary>();
+  }
   // Initialize the first table page.
   auto guard = bpm->NewPageGuarded(&first_page_id_);
   last_page_id_ = first_page_id_;
   auto first_page = guard.AsMut<TablePage>();
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
-  first_page->Init();
+  InitPage(first_page);
+  free_space_map_.Release(first_page_id_, first_page->GetFreeSpaceRemaining());
+}
+
+TableHeap::~TableHeap() {
+  {
+    std::scoped_lock guard(vacuum_latch_);
+    vacuum_stop_ = true;
+  }
+  vacuum_cv_.notify_all();
+  if (vacuum_thread_.joinable()) {
+    vacuum_thread_.join();
+  }
 }
 
 auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr, Transaction *txn,
                             table_oid_t oid) -> std::optional<RID> {
-  std::unique_lock<std::mutex> guard(latch_);
-  auto page_guard = bpm_->FetchPageWrite(last_page_id_);
-  while (true) {
+  auto toasted = PrepareTuple(tuple);
+  const auto &stored = toasted.has_value() ? *toasted : tuple;
+
+  page_id_t page_id = INVALID_PAGE_ID;
+  WritePageGuard page_guard;
+  std::optional<uint16_t> slot_id;
+  // The page this transaction reserved on an earlier insert is not shared, so no one else contends on its latch
+  auto insert_pages = txn != nullptr ? txn->GetInsertPageSet() : nullptr;
+  if (insert_pages != nullptr) {
+    if (auto it = insert_pages->find(this); it != insert_pages->end()) {
+      page_id = it->second;
+      page_guard = bpm_->FetchPageWrite(page_id);
+      auto page = page_guard.AsMut<TablePage>();
+      slot_id = page->InsertTuple(meta, stored);
+      if (!slot_id.has_value()) {
+        free_space_map_.Release(page_id, page->GetFreeSpaceRemaining());
+        page_guard.Drop();
+        insert_pages->erase(it);
+      }
+    }
+  }
+
+  while (!slot_id.has_value()) {
+    // Every inserter works on a page it claimed, so concurrent inserts spread over different pages
+    auto claimed = free_space_map_.Claim(stored.GetLength());
+    if (claimed.has_value()) {
+      page_id = *claimed;
+      page_guard = bpm_->FetchPageWrite(page_id);
+    } else {
+      page_guard = AppendPage(&page_id);
+    }
     auto page = page_guard.AsMut<TablePage>();
-    if (page->GetNextTupleOffset(meta, tuple) != std::nullopt) {
+    slot_id = page->InsertTuple(meta, stored);
+    if (slot_id.has_value()) {
       break;
     }
 
     // if there's no tuple in the page, and we can't insert the tuple, then this tuple is too large.
-    BUSTUB_ENSURE(page->GetNumTuples() != 0, "tuple is too large, cannot insert");
+    auto empty = page->GetNumTuples() == 0;
+    free_space_map_.Release(page_id, page->GetFreeSpaceRemaining());
+    page_guard.Drop();
+    if (empty && toasted.has_value()) {
+      std::vector<page_id_t> chains;
+      CollectOverflowChains(stored.GetData(), &chains);
+      for (auto chain : chains) {
+        FreeOverflowChain(chain);
+      }
+    }
+    BUSTUB_ENSURE(!empty, "tuple is too large, cannot insert");
+  }
+  auto free_bytes = page_guard.As<TablePage>()->GetFreeSpaceRemaining();
+  // Moved slots are read through the page of the forwarded tuple, whose zone covers them
+  if (zone_map_ != nullptr && !meta.is_moved_) {
+    zone_map_->Add(page_id, tuple);
+  }
+
+  if (lock_mgr != nullptr) {
+    BUSTUB_ENSURE(lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{page_id, *slot_id}),
+                  "failed to lock when inserting new tuple");
+  }
+
+  page_guard.Drop();
+  if (insert_pages != nullptr) {
+    (*insert_pages)[this] = page_id;
+  } else {
+    free_space_map_.Release(page_id, free_bytes);
+  }
+
+  return RID(page_id, *slot_id);
+}
+
+auto TableHeap::AppendPage(page_id_t *page_id) -> WritePageGuard {
+  auto npg = bpm_->NewPage(page_id);
+  BUSTUB_ENSURE(*page_id != INVALID_PAGE_ID, "cannot allocate page");
+  npg->WLatch();
+  auto next_page_guard = WritePageGuard{bpm_, npg};
+  InitPage(next_page_guard.AsMut<TablePage>());
+  // The new page belongs to this inserter until it releases it, like a page taken from the free space map
+  free_space_map_.MarkClaimed(*page_id);
+
+  // Nobody else knows about the new page yet, so holding its latch while linking it cannot deadlock. Pages are
+  // allocated outside of latch_, so the chain is not ordered by page id.
+  std::scoped_lock guard(latch_);
+  auto last_page_guard = bpm_->FetchPageWrite(last_page_id_);
+  last_page_guard.AsMut<TablePage>()->SetNextPageId(*page_id);
+  last_page_id_ = *page_id;
+  num_pages_++;
+  return next_page_guard;
+}
+
+auto TableHeap::PrepareTuple(const Tuple &tuple) -> std::optional<Tuple> {
+  if (schema_ == nullptr) {
+    return std::nullopt;
+  }
+  // Codes only mean something in the dictionary they came from, so such tuples are encoded afresh
+  if (dictionary_ != nullptr || tuple.dictionary_ != nullptr) {
+    auto encoded = EncodeTuple(tuple);
+    return encoded.GetLength() > TOAST_TUPLE_THRESHOLD ? ToastTuple(encoded) : encoded;
+  }
+  // A tuple read from a heap may point to overflow pages it does not own, it gets chains of its own
+  std::vector<page_id_t> chains;
+  if (tuple.overflow_bpm_ != nullptr) {
+    CollectOverflowChains(tuple.GetData(), &chains);
+  }
+  if (chains.empty() && tuple.GetLength() <= TOAST_TUPLE_THRESHOLD) {
+    return std::nullopt;
+  }
+  return ToastTuple(tuple);
+}
+
+auto TableHeap::EncodeTuple(const Tuple &tuple) -> Tuple {
+  std::vector<Value> values;
+  values.reserve(schema_->GetColumnCount());
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    values.push_back(tuple.GetValue(schema_.get(), i));
+  }
+  if (dictionary_ == nullptr) {
+    Tuple decoded(values, schema_.get());
+    decoded.rid_ = tuple.GetRid();
+    return decoded;
+  }
+
+  // Strings that no longer fit in the dictionary are stored as they are
+  const auto &varlen_cols = schema_->GetUnlinedColumns();
+  std::vector<const DictionaryEntry *> entries(varlen_cols.size(), nullptr);
+  uint32_t size = schema_->GetLength();
+  for (size_t i = 0; i < varlen_cols.size(); i++) {
+    const auto &value = values[varlen_cols[i]];
+    if (!value.IsNull()) {
+      entries[i] = dictionary_->Intern(value.GetData(), value.GetLength());
+    }
+    if (entries[i] != nullptr) {
+      size += VARLEN_DICTIONARY_CODE_SIZE;
+    } else {
+      size += sizeof(uint32_t) + (value.IsNull() ? 0 : value.GetLength());
+    }
+  }
+
+  Tuple encoded(tuple.GetRid());
+  encoded.data_.resize(size);
+  uint32_t offset = schema_->GetLength();
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    const auto &col = schema_->GetColumn(i);
+    if (col.IsInlined()) {
+      values[i].SerializeTo(encoded.data_.data() + col.GetOffset());
+    }
+  }
+  for (size_t i = 0; i < varlen_cols.size(); i++) {
+    const auto &value = values[varlen_cols[i]];
+    char *field = encoded.data_.data() + offset;
+    *reinterpret_cast<uint32_t *>(encoded.data_.data() + schema_->GetColumn(varlen_cols[i]).GetOffset()) = offset;
+    if (entries[i] != nullptr) {
+      *reinterpret_cast<uint32_t *>(field) = value.GetLength() | VARLEN_DICTIONARY_FLAG;
+      *reinterpret_cast<uint32_t *>(field + sizeof(uint32_t)) = entries[i]->code_;
+      offset += VARLEN_DICTIONARY_CODE_SIZE;
+    } else {
+      value.SerializeTo(field);
+      offset += sizeof(uint32_t) + (value.IsNull() ? 0 : value.GetLength());
+    }
+  }
+  BUSTUB_ASSERT(offset == size, "encoded tuple size mismatch");
+  return encoded;
+}
 
-    page_id_t next_page_id = INVALID_PAGE_ID;
-    auto npg = bpm_->NewPage(&next_page_id);
-    BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
+auto TableHeap::ToastTuple(const Tuple &tuple) -> Tuple {
+  std::vector<page_id_t> chains;
+  if (tuple.overflow_bpm_ != nullptr) {
+    CollectOverflowChains(tuple.GetData(), &chains);
+  }
+  if (!chains.empty()) {
+    std::vector<Value> values;
+    values.reserve(schema_->GetColumnCount());
+    for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+      values.push_back(tuple.GetValue(schema_.get(), i));
+    }
+    Tuple inlined(values, schema_.get());
+    inlined.rid_ = tuple.GetRid();
+    return ToastTuple(inlined);
+  }
 
-    page->SetNextPageId(next_page_id);
+  const auto &varlen_cols = schema_->GetUnlinedColumns();
+  const char *data = tuple.GetData();
+  auto payload = [&](uint32_t col_idx) { return Tuple::GetDataPtr(data, schema_.get(), col_idx); };
+  auto payload_size = [&](uint32_t col_idx) -> uint32_t {
+    auto len = *reinterpret_cast<const uint32_t *>(payload(col_idx));
+    if (len == BUSTUB_VALUE_NULL) {
+      return sizeof(uint32_t);
+    }
+    if ((len & VARLEN_DICTIONARY_FLAG) != 0) {
+      return VARLEN_DICTIONARY_CODE_SIZE;
+    }
+    return (len & VARLEN_OVERFLOW_FLAG) != 0 ? VARLEN_OVERFLOW_POINTER_SIZE : sizeof(uint32_t) + len;
+  };
 
-    auto next_page = reinterpret_cast<TablePage *>(npg->GetData());
-    next_page->Init();
+  // Largest values first, until the tuple is small enough
+  std::vector<uint32_t> by_size(varlen_cols);
+  std::stable_sort(by_size.begin(), by_size.end(),
+                   [&](uint32_t a, uint32_t b) { return payload_size(a) > payload_size(b); });
+  std::vector<uint32_t> out_of_line;
+  uint32_t size = tuple.GetLength();
+  for (auto col_idx : by_size) {
+    if (size <= TOAST_TUPLE_THRESHOLD || payload_size(col_idx) <= VARLEN_OVERFLOW_POINTER_SIZE) {
+      break;
+    }
+    out_of_line.push_back(col_idx);
+    size -= payload_size(col_idx) - VARLEN_OVERFLOW_POINTER_SIZE;
+  }
 
+  Tuple toasted(tuple.GetRid());
+  toasted.data_.resize(size);
+  memcpy(toasted.data_.data(), data, schema_->GetLength());
+  uint32_t offset = schema_->GetLength();
+  for (auto col_idx : varlen_cols) {
+    *reinterpret_cast<uint32_t *>(toasted.data_.data() + schema_->GetColumn(col_idx).GetOffset()) = offset;
+    const char *src = payload(col_idx);
+    if (std::find(out_of_line.begin(), out_of_line.end(), col_idx) != out_of_line.end()) {
+      auto len = *reinterpret_cast<const uint32_t *>(src);
+      auto first_page_id = WriteOverflowChain(src + sizeof(uint32_t), len);
+      *reinterpret_cast<uint32_t *>(toasted.data_.data() + offset) = len | VARLEN_OVERFLOW_FLAG;
+      *reinterpret_cast<page_id_t *>(toasted.data_.data() + offset + sizeof(uint32_t)) = first_page_id;
+      offset += VARLEN_OVERFLOW_POINTER_SIZE;
+    } else {
+      memcpy(toasted.data_.data() + offset, src, payload_size(col_idx));
+      offset += payload_size(col_idx);
+    }
+  }
+  BUSTUB_ASSERT(offset == size, "toasted tuple size mismatch");
+  return toasted;
+}
+
+void TableHeap::CollectOverflowChains(const char *data, std::vector<page_id_t> *chains) const {
+  if (schema_ == nullptr) {
+    return;
+  }
+  for (auto col_idx : schema_->GetUnlinedColumns()) {
+    const char *src = Tuple::GetDataPtr(data, schema_.get(), col_idx);
+    auto len = *reinterpret_cast<const uint32_t *>(src);
+    if (len != BUSTUB_VALUE_NULL && (len & VARLEN_OVERFLOW_FLAG) != 0) {
+      chains->push_back(*reinterpret_cast<const page_id_t *>(src + sizeof(uint32_t)));
+    }
+  }
+}
+
+void TableHeap::CollectStoredChains(const TablePage *page, const RID &rid, std::vector<page_id_t> *chains) const {
+  if (schema_ == nullptr || schema_->GetUnlinedColumns().empty()) {
+    return;
+  }
+  if (page->IsPax()) {
+    CollectOverflowChains(page->GetTuple(rid).second.GetData(), chains);
+  } else {
+    CollectOverflowChains(page->GetTupleView(rid).second.GetData(), chains);
+  }
+}
+
+void TableHeap::InitPage(TablePage *page) const {
+  if (format_ == TableFormat::PAX) {
+    page->InitPax(*schema_);
+  } else {
+    page->Init();
+  }
+}
+
+void TableHeap::CollectReclaimable(page_id_t page_id, const TablePage *page, std::vector<page_id_t> *chains,
+                                   std::vector<RID> *moved) const {
+  for (uint32_t slot = 0; slot < page->GetNumTuples(); slot++) {
+    RID rid{page_id, slot};
+    auto meta = page->GetTupleMeta(rid);
+    // Reclaimed slots are left with an empty tuple, everything they held is already gone
+    if (!TablePage::IsReclaimable(meta) || page->IsReclaimed(rid)) {
+      continue;
+    }
+    if (meta.is_forwarded_) {
+      moved->push_back(page->GetForward(rid));
+    } else {
+      CollectStoredChains(page, rid, chains);
+    }
+  }
+}
+
+auto TableHeap::WriteOverflowChain(const char *data, uint32_t size) -> page_id_t {
+  // Written back to front, so every page knows its successor when it is filled
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  auto num_pages = (size + OVERFLOW_PAGE_CAPACITY - 1) / OVERFLOW_PAGE_CAPACITY;
+  for (auto i = num_pages; i > 0; i--) {
+    auto begin = (i - 1) * OVERFLOW_PAGE_CAPACITY;
+    page_id_t page_id;
+    auto page_guard = bpm_->NewPageGuarded(&page_id);
+    BUSTUB_ENSURE(page_id != INVALID_PAGE_ID, "cannot allocate overflow page");
+    page_guard.AsMut<OverflowPage>()->Init(next_page_id, data + begin,
+                                           std::min<uint32_t>(OVERFLOW_PAGE_CAPACITY, size - begin));
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+auto TableHeap::FreeOverflowChain(page_id_t page_id) -> size_t {
+  size_t num_freed = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page_guard = bpm_->FetchPageRead(page_id);
+    auto next_page_id = page_guard.As<OverflowPage>()->GetNextPageId();
+    page_guard.Drop();
+    bpm_->DeletePage(page_id);
+    num_freed++;
+    page_id = next_page_id;
+  }
+  return num_freed;
+}
+
+auto TableHeap::Vacuum() -> VacuumStats {
+  VacuumStats stats;
+  std::scoped_lock vacuum_guard(vacuum_latch_);
+  std::scoped_lock guard(latch_);
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page_guard = bpm_->FetchPageWrite(page_id);
+    auto page = page_guard.AsMut<TablePage>();
+    std::vector<RID> moved;
+    CollectReclaimable(page_id, page, &overflow_garbage_, &moved);
+    auto reclaimed = page->Compact();
+    auto next_page_id = page->GetNextPageId();
+    auto vacant = page->IsVacant();
+    auto free_bytes = page->GetFreeSpaceRemaining();
     page_guard.Drop();
+    // Moved slots on pages already passed are reclaimed by the next pass
+    ReleaseMovedTuples(moved);
+    if (reclaimed > 0) {
+      stats.num_compacted_pages_++;
+      stats.num_reclaimed_bytes_ += reclaimed;
+    }
 
-    // acquire latch here as TSAN complains. Given we only have one insertion thread, this is fine.
-    npg->WLatch();
-    auto next_page_guard = WritePageGuard{bpm_, npg};
+    // Once the free space map has let go of the page no inserter can reach it, but one may have filled it before
+    if (vacant && page_id != first_page_id_ && page_id != last_page_id_ && free_space_map_.Remove(page_id)) {
+      page_guard = bpm_->FetchPageWrite(page_id);
+      vacant = page_guard.As<TablePage>()->IsVacant();
+      free_bytes = page_guard.As<TablePage>()->GetFreeSpaceRemaining();
+      page_guard.Drop();
+    } else {
+      vacant = false;
+    }
+    if (!vacant) {
+      free_space_map_.Update(page_id, free_bytes);
+      prev_page_id = page_id;
+      page_id = next_page_id;
+      continue;
+    }
 
-    last_page_id_ = next_page_id;
-    page_guard = std::move(next_page_guard);
+    auto prev_page_guard = bpm_->FetchPageWrite(prev_page_id);
+    prev_page_guard.AsMut<TablePage>()->SetNextPageId(next_page_id);
+    prev_page_guard.Drop();
+    // A reader may still be on the page, it keeps the next page id to move on
+    retired_pages_.push_back(page_id);
+    num_pages_--;
+    if (zone_map_ != nullptr) {
+      zone_map_->Remove(page_id);
+    }
+    {
+      std::scoped_lock visibility_guard(visibility_latch_);
+      pages_with_deletes_.erase(page_id);
+    }
+    if (vacuum_pending_.erase(page_id) != 0) {
+      vacuum_queue_.erase(std::find(vacuum_queue_.begin(), vacuum_queue_.end(), page_id));
+    }
+    stats.num_freed_pages_++;
+    page_id = next_page_id;
   }
-  auto last_page_id = last_page_id_;
 
-  auto page = page_guard.AsMut<TablePage>();
-  auto slot_id = *page->InsertTuple(meta, tuple);
+  stats.num_freed_overflow_pages_ = FreeRetired();
+  return stats;
+}
 
-  // only allow one insertion at a time, otherwise it will deadlock.
-  guard.unlock();
+auto TableHeap::FreeRetired() -> size_t {
+  // A reader registered from now on starts at a linked page and only sees the tuples stored there, so it can reach
+  // neither a retired page nor the chain of a reclaimed tuple
+  if (num_readers_.load() != 0) {
+    return 0;
+  }
+  auto pinned = std::remove_if(retired_pages_.begin(), retired_pages_.end(),
+                               [this](page_id_t page_id) { return !bpm_->DeletePage(page_id); });
+  retired_pages_.erase(pinned, retired_pages_.end());
+  size_t num_freed = 0;
+  for (auto chain : overflow_garbage_) {
+    num_freed += FreeOverflowChain(chain);
+  }
+  overflow_garbage_.clear();
+  return num_freed;
+}
 
-  if (lock_mgr != nullptr) {
-    BUSTUB_ENSURE(lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{last_page_id, slot_id}),
-                  "failed to lock when inserting new tuple");
+void TableHeap::ScheduleCompaction(page_id_t page_id) {
+  std::scoped_lock guard(vacuum_latch_);
+  if (vacuum_stop_ || !vacuum_pending_.insert(page_id).second) {
+    return;
+  }
+  vacuum_queue_.push_back(page_id);
+  if (!vacuum_thread_.joinable()) {
+    vacuum_thread_ = std::thread(&TableHeap::RunCompaction, this);
   }
+  vacuum_cv_.notify_one();
+}
 
+auto TableHeap::CompactPage(page_id_t page_id) -> uint32_t {
+  auto page_guard = bpm_->FetchPageWrite(page_id);
+  auto page = page_guard.AsMut<TablePage>();
+  std::vector<RID> moved;
+  CollectReclaimable(page_id, page, &overflow_garbage_, &moved);
+  auto reclaimed = page->Compact();
+  auto free_bytes = page->GetFreeSpaceRemaining();
   page_guard.Drop();
+  free_space_map_.Update(page_id, free_bytes);
+  ReleaseMovedTuples(moved);
+  return reclaimed;
+}
 
-  return RID(last_page_id, slot_id);
+void TableHeap::RunCompaction() {
+  std::unique_lock<std::mutex> guard(vacuum_latch_);
+  while (true) {
+    vacuum_cv_.wait(guard, [&] { return vacuum_stop_ || !vacuum_queue_.empty(); });
+    if (vacuum_stop_) {
+      return;
+    }
+    auto page_id = vacuum_queue_.front();
+    vacuum_queue_.pop_front();
+    vacuum_pending_.erase(page_id);
+    // Holding vacuum_latch_ keeps Vacuum from freeing the page underneath
+    CompactPage(page_id);
+  }
+}
+
+void TableHeap::ReleaseInsertPage(page_id_t page_id) {
+  auto page_guard = bpm_->FetchPageRead(page_id);
+  auto free_bytes = page_guard.As<TablePage>()->GetFreeSpaceRemaining();
+  page_guard.Drop();
+  free_space_map_.Release(page_id, free_bytes);
 }
 
 void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
+  if (meta.is_deleted_) {
+    // mark the page before the tuple, so index-only scans never trust a page holding a deleted tuple
+    std::scoped_lock guard(visibility_latch_);
+    pages_with_deletes_.insert(rid.GetPageId());
+  }
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
   auto page = page_guard.AsMut<TablePage>();
   page->UpdateTupleMeta(meta, rid);
+  auto worth_compacting = TablePage::IsReclaimable(meta) &&
+                          page->GetReclaimableBytes() >= VACUUM_DEAD_FRACTION * BUSTUB_PAGE_SIZE;
+  page_guard.Drop();
+
+  // The worker latches the page, so it is only woken once the page latch is gone
+  if (worth_compacting) {
+    ScheduleCompaction(rid.GetPageId());
+  }
+}
+
+void TableHeap::UpdateTuple(const Tuple &tuple, RID rid) {
+  auto toasted = PrepareTuple(tuple);
+  const auto &stored = toasted.has_value() ? *toasted : tuple;
+  // The zone is widened before the new values can be read
+  if (zone_map_ != nullptr) {
+    zone_map_->Add(rid.GetPageId(), tuple);
+  }
+
+  // No two pages are latched at once, the row lock of the caller keeps the tuple from changing in between
+  auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
+  auto page = page_guard.AsMut<TablePage>();
+  std::vector<page_id_t> old_chains;
+  if (!page->GetTupleMeta(rid).is_forwarded_) {
+    CollectStoredChains(page, rid, &old_chains);
+    if (!page->UpdateTupleInPlace(stored, rid)) {
+      page_guard.Drop();
+      auto target = InsertMovedTuple(stored);
+      page_guard = bpm_->FetchPageWrite(rid.GetPageId());
+      page_guard.AsMut<TablePage>()->SetForward(rid, target);
+    }
+    page_guard.Drop();
+    DeferOverflowChains(old_chains);
+    return;
+  }
+
+  // A forwarded tuple goes back home if it fits there again, then into its moved slot, then to a new one
+  auto old_target = page->GetForward(rid);
+  auto moved_home = page->UpdateTupleInPlace(stored, rid);
+  page_guard.Drop();
+  if (!moved_home) {
+    page_guard = bpm_->FetchPageWrite(old_target.GetPageId());
+    page = page_guard.AsMut<TablePage>();
+    CollectStoredChains(page, old_target, &old_chains);
+    if (page->UpdateTupleInPlace(stored, old_target)) {
+      page_guard.Drop();
+      DeferOverflowChains(old_chains);
+      return;
+    }
+    page_guard.Drop();
+    auto target = InsertMovedTuple(stored);
+    page_guard = bpm_->FetchPageWrite(rid.GetPageId());
+    page_guard.AsMut<TablePage>()->SetForward(rid, target);
+    page_guard.Drop();
+  }
+  // The chains of the old moved slot are collected once its page is compacted
+  ReleaseMovedTuples({old_target});
+}
+
+auto TableHeap::InsertMovedTuple(const Tuple &tuple) -> RID {
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+  meta.is_moved_ = true;
+  auto rid = InsertTuple(meta, tuple);
+  BUSTUB_ENSURE(rid.has_value(), "cannot store moved tuple");
+  return *rid;
+}
+
+void TableHeap::ReleaseMovedTuples(const std::vector<RID> &moved) {
+  for (const auto &rid : moved) {
+    auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
+    auto page = page_guard.AsMut<TablePage>();
+    auto meta = page->GetTupleMeta(rid);
+    meta.is_deleted_ = true;
+    meta.delete_txn_id_ = INVALID_TXN_ID;
+    page->UpdateTupleMeta(meta, rid);
+  }
+}
+
+void TableHeap::DeferOverflowChains(const std::vector<page_id_t> &chains) {
+  if (chains.empty()) {
+    return;
+  }
+  std::scoped_lock guard(vacuum_latch_);
+  overflow_garbage_.insert(overflow_garbage_.end(), chains.begin(), chains.end());
+}
+
+auto TableHeap::LatchStoredTuple(RID rid) -> std::tuple<ReadPageGuard, RID, TupleMeta> {
+  while (true) {
+    auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+    auto page = page_guard.As<TablePage>();
+    auto meta = page->GetTupleMeta(rid);
+    if (!meta.is_forwarded_) {
+      return {std::move(page_guard), rid, meta};
+    }
+    auto target = page->GetForward(rid);
+    page_guard.Drop();
+    auto target_guard = bpm_->FetchPageRead(target.GetPageId());
+    auto target_meta = target_guard.As<TablePage>()->GetTupleMeta(target);
+    // A moved slot is released only after its tuple moved on, the forwarding pointer is read again then
+    if (target_meta.is_moved_ && !target_meta.is_deleted_) {
+      return {std::move(target_guard), target, meta};
+    }
+  }
 }
 
 auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
-  auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+  auto [page_guard, slot, meta] = LatchStoredTuple(rid);
   auto page = page_guard.As<TablePage>();
-  auto [meta, tuple] = page->GetTuple(rid);
+  auto tuple = page->GetTuple(slot).second;
   tuple.rid_ = rid;
+  tuple.overflow_bpm_ = bpm_;
+  tuple.dictionary_ = dictionary_.get();
   return std::make_pair(meta, std::move(tuple));
 }
 
@@ -105,6 +626,11 @@ auto TableHeap::GetTupleMeta(RID rid) -> TupleMeta {
   return page->GetTupleMeta(rid);
 }
 
+auto TableHeap::IsPageAllVisible(page_id_t page_id) -> bool {
+  std::scoped_lock guard(visibility_latch_);
+  return pages_with_deletes_.count(page_id) == 0;
+}
+
 auto TableHeap::MakeIterator() -> TableIterator {
   std::unique_lock<std::mutex> guard(latch_);
   auto last_page_id = last_page_id_;
@@ -117,7 +643,28 @@ auto TableHeap::MakeIterator() -> TableIterator {
 
 auto TableHeap::MakeEagerIterator() -> TableIterator { return {this, {first_page_id_, 0}, {INVALID_PAGE_ID, 0}}; }
 
+auto TableHeap::MakeRangeIterator(page_id_t first_page_id, page_id_t stop_page_id) -> TableIterator {
+  return {this, {first_page_id, 0}, {stop_page_id, 0}};
+}
+
+auto TableHeap::GetPageIds() -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(num_pages_.load());
+  for (auto page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+    page_ids.push_back(page_id);
+    page_id = bpm_->FetchPageRead(page_id).As<TablePage>()->GetNextPageId();
+  }
+  return page_ids;
+}
+
 void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
+  if (meta.is_deleted_) {
+    std::scoped_lock guard(visibility_latch_);
+    pages_with_deletes_.insert(rid.GetPageId());
+  }
+  if (zone_map_ != nullptr) {
+    zone_map_->Add(rid.GetPageId(), tuple);
+  }
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
   auto page = page_guard.AsMut<TablePage>();
   page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
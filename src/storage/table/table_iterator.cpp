@@ -20,37 +20,172 @@
 
 namespace bustub {
 
+TableReadGuard::TableReadGuard(TableHeap *table_heap) : table_heap_(table_heap) { table_heap_->num_readers_++; }
+
+TableReadGuard::TableReadGuard(TableReadGuard &&that) noexcept : table_heap_(that.table_heap_) {
+  that.table_heap_ = nullptr;
+}
+
+auto TableReadGuard::operator=(TableReadGuard &&that) noexcept -> TableReadGuard & {
+  if (this != &that) {
+    Drop();
+    table_heap_ = that.table_heap_;
+    that.table_heap_ = nullptr;
+  }
+  return *this;
+}
+
+void TableReadGuard::Drop() {
+  if (table_heap_ != nullptr) {
+    table_heap_->num_readers_--;
+    table_heap_ = nullptr;
+  }
+}
+
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
-    : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
-  // If the rid doesn't correspond to a tuple (i.e., the table has just been initialized), then
-  // we set rid_ to invalid.
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
-  auto page = page_guard.As<TablePage>();
-  if (rid_.GetSlotNum() >= page->GetNumTuples()) {
+    : table_heap_(table_heap), read_guard_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
+  // An empty first page is stepped over like any other, the iterator ends at the stop tuple or the end of the table
+  if (rid_ == stop_at_rid_) {
     rid_ = RID{INVALID_PAGE_ID, 0};
+    read_guard_.Drop();
+    return;
+  }
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  while (!IsEnd() && !AtHomeSlot(&page_guard)) {
+    Step(&page_guard);
+  }
+  KeepPage(&page_guard, false);
+}
+
+auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> {
+  // Latching the page a second time could block behind a waiting writer
+  if (page_latched_) {
+    auto [meta, tuple] = page_guard_.As<TablePage>()->GetTuple(rid_);
+    if (!meta.is_forwarded_) {
+      tuple.overflow_bpm_ = table_heap_->bpm_;
+      tuple.dictionary_ = table_heap_->dictionary_.get();
+      return std::make_pair(meta, std::move(tuple));
+    }
   }
+  ReleasePage();
+  return table_heap_->GetTuple(rid_);
 }
 
-auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
+auto TableIterator::GetTupleView() -> std::pair<TupleMeta, TupleView> { return ReadTuple(nullptr); }
+
+auto TableIterator::GetTupleColumns(const std::vector<uint32_t> &column_ids) -> std::pair<TupleMeta, TupleView> {
+  return ReadTuple(&column_ids);
+}
+
+auto TableIterator::ReadTuple(const std::vector<uint32_t> *column_ids) -> std::pair<TupleMeta, TupleView> {
+  if (!forward_latched_) {
+    if (!page_latched_) {
+      page_guard_ = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+      page_latched_ = true;
+    }
+    auto meta = page_guard_.As<TablePage>()->GetTupleMeta(rid_);
+    if (meta.is_forwarded_) {
+      // Page latches are not nested, the latch moves to the page storing the tuple
+      ReleasePage();
+      auto [guard, slot, home_meta] = table_heap_->LatchStoredTuple(rid_);
+      forward_guard_ = std::move(guard);
+      forward_slot_ = slot;
+      forward_meta_ = home_meta;
+      forward_latched_ = true;
+    }
+  }
+  auto page = forward_latched_ ? forward_guard_.As<TablePage>() : page_guard_.As<TablePage>();
+  auto slot = forward_latched_ ? forward_slot_ : rid_;
+  auto meta = forward_latched_ ? forward_meta_ : page->GetTupleMeta(rid_);
+
+  TupleView view;
+  if (!page->IsPax()) {
+    view = page->GetTupleView(slot).second;
+  } else if (column_ids == nullptr) {
+    pax_tuple_ = page->GetTuple(slot).second;
+    view = TupleView(pax_tuple_.GetData(), pax_tuple_.GetLength(), slot);
+  } else {
+    view = page->GetTupleColumns(slot, *table_heap_->schema_, *column_ids, &pax_columns_).second;
+  }
+  return std::make_pair(
+      meta, TupleView(view.GetData(), view.GetLength(), rid_, table_heap_->bpm_, table_heap_->dictionary_.get()));
+}
 
 auto TableIterator::GetRID() -> RID { return rid_; }
 
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
-  auto page = page_guard.As<TablePage>();
+  auto was_latched = page_latched_ || forward_latched_;
+  auto page_guard = TakePage();
+
+  do {
+    Step(&page_guard);
+  } while (!IsEnd() && !AtHomeSlot(&page_guard));
+
+  KeepPage(&page_guard, was_latched);
+
+  return *this;
+}
+
+auto TableIterator::TakePage() -> ReadPageGuard {
+  // Reuse the latch taken by GetTupleView(), otherwise latch the page just for this move
+  auto page_guard = page_latched_ ? std::move(page_guard_) : ReadPageGuard{};
+  auto home_latched = page_latched_;
+  ReleasePage();
+  if (!home_latched) {
+    page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  }
+  return page_guard;
+}
+
+void TableIterator::KeepPage(ReadPageGuard *page_guard, bool was_latched) {
+  if (was_latched && !IsEnd()) {
+    page_guard_ = std::move(*page_guard);
+    page_latched_ = true;
+  }
+  page_guard->Drop();
+  // An iterator at its end reads no more pages, so it no longer holds pages back from Vacuum
+  if (IsEnd()) {
+    read_guard_.Drop();
+  }
+}
+
+void TableIterator::SkipPage() {
+  auto was_latched = page_latched_ || forward_latched_;
+  auto page_guard = TakePage();
+
+  // The page of the stop tuple is the last one the iterator visits
+  auto next_page_id = page_guard.As<TablePage>()->GetNextPageId();
+  if (rid_.GetPageId() == stop_at_rid_.GetPageId() || next_page_id == INVALID_PAGE_ID) {
+    rid_ = RID{INVALID_PAGE_ID, 0};
+  } else {
+    rid_ = RID{next_page_id, 0};
+    page_guard.Drop();
+    page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+    if (rid_ == stop_at_rid_) {
+      rid_ = RID{INVALID_PAGE_ID, 0};
+    }
+  }
+  while (!IsEnd() && !AtHomeSlot(&page_guard)) {
+    Step(&page_guard);
+  }
+
+  KeepPage(&page_guard, was_latched);
+}
+
+void TableIterator::Step(ReadPageGuard *page_guard) {
+  auto page = page_guard->As<TablePage>();
+  auto page_id = rid_.GetPageId();
   auto next_tuple_id = rid_.GetSlotNum() + 1;
 
   if (stop_at_rid_.GetPageId() != INVALID_PAGE_ID) {
-    BUSTUB_ASSERT(
-        /* case 1: cursor before the page of the stop tuple */ rid_.GetPageId() < stop_at_rid_.GetPageId() ||
-            /* case 2: cursor at the page before the tuple */
-            (rid_.GetPageId() == stop_at_rid_.GetPageId() && next_tuple_id <= stop_at_rid_.GetSlotNum()),
-        "iterate out of bound");
+    // Pages are not linked in page id order, so only a cursor on the page of the stop tuple can be checked
+    BUSTUB_ASSERT(page_id != stop_at_rid_.GetPageId() || next_tuple_id <= stop_at_rid_.GetSlotNum(),
+                  "iterate out of bound");
   }
 
-  rid_ = RID{rid_.GetPageId(), next_tuple_id};
+  rid_ = RID{page_id, next_tuple_id};
 
   if (rid_ == stop_at_rid_) {
     rid_ = RID{INVALID_PAGE_ID, 0};
@@ -60,11 +195,21 @@ auto TableIterator::operator++() -> TableIterator & {
     auto next_page_id = page->GetNextPageId();
     // if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
     rid_ = RID{next_page_id, 0};
+    // A range of pages stops at the first tuple of the page following it
+    if (rid_ == stop_at_rid_) {
+      rid_ = RID{INVALID_PAGE_ID, 0};
+    }
   }
 
-  page_guard.Drop();
+  if (!IsEnd() && rid_.GetPageId() != page_id) {
+    page_guard->Drop();
+    *page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  }
+}
 
-  return *this;
+auto TableIterator::AtHomeSlot(ReadPageGuard *page_guard) const -> bool {
+  auto page = page_guard->As<TablePage>();
+  return rid_.GetSlotNum() < page->GetNumTuples() && !page->GetTupleMeta(rid_).is_moved_;
 }
 
 }  // namespace bustub
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.cpp
+//
+// Identification: src/storage/table/tmp_tuple_file.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_file.h"
+
+#include "common/exception.h"
+#include "storage/page/tmp_tuple_page.h"
+
+namespace bustub {
+
+TmpTupleFile::~TmpTupleFile() {
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleFile::Append(const Tuple &tuple) {
+  TmpTuple out(INVALID_PAGE_ID, 0);
+  if (!page_ids_.empty()) {
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_ids_.back()));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill a tuple to");
+    }
+    bool inserted = page->Insert(tuple, &out);
+    bpm_->UnpinPage(page_ids_.back(), inserted);
+    if (inserted) {
+      num_tuples_++;
+      return;
+    }
+  }
+
+  page_id_t page_id;
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill a tuple to");
+  }
+  page_ids_.push_back(page_id);
+  page->Init(page_id, BUSTUB_PAGE_SIZE);
+  bool inserted = page->Insert(tuple, &out);
+  bpm_->UnpinPage(page_id, true);
+  if (!inserted) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "tuple is too large to spill to a page");
+  }
+  num_tuples_++;
+}
+
+auto TmpTupleFile::Next(Cursor *cursor, Tuple *tuple) -> bool {
+  while (cursor->page_idx_ < page_ids_.size()) {
+    auto page_id = page_ids_[cursor->page_idx_];
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a spilled tuple from");
+    }
+    // A cursor that has not read from this page yet starts at its newest tuple
+    if (cursor->offset_ == 0) {
+      cursor->offset_ = page->GetFreeSpacePointer();
+    }
+    if (cursor->offset_ < BUSTUB_PAGE_SIZE) {
+      cursor->offset_ = page->Get(cursor->offset_, tuple);
+      bpm_->UnpinPage(page_id, false);
+      return true;
+    }
+    bpm_->UnpinPage(page_id, false);
+    cursor->page_idx_++;
+    cursor->offset_ = 0;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -16,7 +16,11 @@
 #include <string>
 #include <vector>
 
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "storage/page/overflow_page.h"
 #include "storage/table/tuple.h"
+#include "type/dictionary.h"
 
 namespace bustub {
 
@@ -61,11 +65,63 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) {
 }
 
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
+  return GetValue(data_.data(), schema, column_idx, overflow_bpm_, dictionary_, false);
+}
+
+auto Tuple::IsNull(const Schema *schema, const uint32_t column_idx) const -> bool {
+  return IsNull(data_.data(), schema, column_idx);
+}
+
+auto Tuple::GetValue(const char *data, const Schema *schema, const uint32_t column_idx,
+                     BufferPoolManager *overflow_bpm, const Dictionary *dictionary, bool borrow) -> Value {
   assert(schema);
   const TypeId column_type = schema->GetColumn(column_idx).GetType();
-  const char *data_ptr = GetDataPtr(schema, column_idx);
-  // the third parameter "is_inlined" is unused
-  return Value::DeserializeFrom(data_ptr, column_type);
+  const char *data_ptr = GetDataPtr(data, schema, column_idx);
+  if (column_type != TypeId::VARCHAR) {
+    // the third parameter "is_inlined" is unused
+    return Value::DeserializeFrom(data_ptr, column_type);
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr);
+  if (len != BUSTUB_VALUE_NULL && (len & VARLEN_DICTIONARY_FLAG) != 0) {
+    // Decoded values borrow from the dictionary, which lives as long as its table
+    if (dictionary == nullptr) {
+      throw Exception("dictionary code read from a tuple that is not backed by a table heap");
+    }
+    return {TypeId::VARCHAR, dictionary->GetEntry(*reinterpret_cast<const uint32_t *>(data_ptr + sizeof(uint32_t)))};
+  }
+  if (len == BUSTUB_VALUE_NULL || (len & VARLEN_OVERFLOW_FLAG) == 0) {
+    if (borrow && len != BUSTUB_VALUE_NULL) {
+      return {TypeId::VARCHAR, data_ptr + sizeof(uint32_t), len, false};
+    }
+    return Value::DeserializeFrom(data_ptr, column_type);
+  }
+
+  // Gather the value from its overflow pages
+  if (overflow_bpm == nullptr) {
+    throw Exception("out-of-line value read from a tuple that is not backed by a table heap");
+  }
+  len &= ~VARLEN_OVERFLOW_FLAG;
+  std::vector<char> buf(len);
+  uint32_t pos = 0;
+  auto page_id = *reinterpret_cast<const page_id_t *>(data_ptr + sizeof(uint32_t));
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = overflow_bpm->FetchPageRead(page_id);
+    const auto *page = guard.As<OverflowPage>();
+    BUSTUB_ENSURE(pos + page->GetSize() <= len, "overflow chain is longer than its value");
+    memcpy(buf.data() + pos, page->GetData(), page->GetSize());
+    pos += page->GetSize();
+    page_id = page->GetNextPageId();
+  }
+  BUSTUB_ENSURE(pos == len, "overflow chain is shorter than its value");
+  return {TypeId::VARCHAR, buf.data(), len, true};
+}
+
+auto Tuple::IsNull(const char *data, const Schema *schema, const uint32_t column_idx) -> bool {
+  assert(schema);
+  if (schema->GetColumn(column_idx).GetType() != TypeId::VARCHAR) {
+    return GetValue(data, schema, column_idx, nullptr, nullptr, true).IsNull();
+  }
+  return *reinterpret_cast<const uint32_t *>(GetDataPtr(data, schema, column_idx)) == BUSTUB_VALUE_NULL;
 }
 
 auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
@@ -78,18 +134,18 @@ auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const s
   return {values, &key_schema};
 }
 
-auto Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const -> const char * {
+auto Tuple::GetDataPtr(const char *data, const Schema *schema, const uint32_t column_idx) -> const char * {
   assert(schema);
   const auto &col = schema->GetColumn(column_idx);
   bool is_inlined = col.IsInlined();
   // For inline type, data is stored where it is.
   if (is_inlined) {
-    return (data_.data() + col.GetOffset());
+    return (data + col.GetOffset());
   }
   // We read the relative offset from the tuple data.
-  int32_t offset = *reinterpret_cast<const int32_t *>(data_.data() + col.GetOffset());
+  int32_t offset = *reinterpret_cast<const int32_t *>(data + col.GetOffset());
   // And return the beginning address of the real data for the VARCHAR type.
-  return (data_.data() + offset);
+  return (data + offset);
 }
 
 auto Tuple::ToString(const Schema *schema) const -> std::string {
@@ -129,4 +185,12 @@ void Tuple::DeserializeFrom(const char *storage) {
   memcpy(this->data_.data(), storage + sizeof(int32_t), size);
 }
 
+auto TupleView::Materialize() const -> Tuple {
+  Tuple tuple(rid_);
+  tuple.data_.assign(data_, data_ + size_);
+  tuple.overflow_bpm_ = overflow_bpm_;
+  tuple.dictionary_ = dictionary_;
+  return tuple;
+}
+
 }  // namespace bustub
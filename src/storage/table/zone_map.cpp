@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+ZoneMap::ZoneMap(const Schema *schema) : schema_(schema) {
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    const auto &column = schema_->GetColumn(i);
+    if (!column.IsInlined()) {
+      continue;
+    }
+    switch (column.GetType()) {
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+      case TypeId::DECIMAL:
+      case TypeId::TIMESTAMP:
+        tracked_.push_back(i);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+auto ZoneMap::IsTracked(uint32_t col_idx) const -> bool {
+  return std::binary_search(tracked_.begin(), tracked_.end(), col_idx);
+}
+
+void ZoneMap::Add(page_id_t page_id, const Tuple &tuple) {
+  if (tracked_.empty()) {
+    return;
+  }
+  // Fixed-size columns are read straight from the tuple, before the map is latched
+  std::vector<Value> values;
+  values.reserve(tracked_.size());
+  for (auto col_idx : tracked_) {
+    values.push_back(tuple.GetValue(schema_, col_idx));
+  }
+
+  std::scoped_lock guard(latch_);
+  auto &zone = zones_[page_id];
+  if (zone.columns_.empty()) {
+    zone.columns_.resize(schema_->GetColumnCount());
+  }
+  for (size_t i = 0; i < tracked_.size(); i++) {
+    auto &column = zone.columns_[tracked_[i]];
+    const auto &value = values[i];
+    if (value.IsNull()) {
+      column.null_count_++;
+      continue;
+    }
+    if (column.num_values_ == 0 || value.CompareLessThan(column.min_) == CmpBool::CmpTrue) {
+      column.min_ = value;
+    }
+    if (column.num_values_ == 0 || value.CompareGreaterThan(column.max_) == CmpBool::CmpTrue) {
+      column.max_ = value;
+    }
+    column.num_values_++;
+  }
+}
+
+void ZoneMap::Remove(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  zones_.erase(page_id);
+}
+
+auto ZoneMap::GetZone(page_id_t page_id) -> std::optional<PageZone> {
+  std::scoped_lock guard(latch_);
+  auto it = zones_.find(page_id);
+  if (it == zones_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+}  // namespace bustub
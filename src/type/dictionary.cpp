@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dictionary.cpp
+//
+// Identification: src/type/dictionary.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "type/dictionary.h"
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+auto Dictionary::Intern(const char *data, uint32_t len) -> const DictionaryEntry * {
+  std::scoped_lock guard(latch_);
+  if (auto it = codes_.find(std::string_view(data, len)); it != codes_.end()) {
+    return GetEntry(it->second);
+  }
+  if (size_ == CAPACITY) {
+    return nullptr;
+  }
+  auto code = size_;
+  if (code % CHUNK_SIZE == 0) {
+    chunks_[code / CHUNK_SIZE] = std::make_unique<DictionaryEntry[]>(CHUNK_SIZE);
+  }
+  auto &entry = chunks_[code / CHUNK_SIZE][code % CHUNK_SIZE];
+  entry.data_.assign(data, len);
+  entry.code_ = code;
+  entry.hash_ = HashUtil::HashBytes(data, len);
+  entry.dictionary_ = this;
+  codes_.emplace(entry.data_, code);
+  size_++;
+  return &entry;
+}
+
+auto Dictionary::Find(const char *data, uint32_t len) const -> const DictionaryEntry * {
+  std::scoped_lock guard(latch_);
+  auto it = codes_.find(std::string_view(data, len));
+  return it == codes_.end() ? nullptr : GetEntry(it->second);
+}
+
+auto Dictionary::Size() const -> uint32_t {
+  std::scoped_lock guard(latch_);
+  return size_;
+}
+
+}  // namespace bustub
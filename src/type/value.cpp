@@ -15,6 +15,7 @@
 #include <utility>
 
 #include "common/exception.h"
+#include "type/dictionary.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -23,6 +24,7 @@ Value::Value(const Value &other) {
   size_ = other.size_;
   manage_data_ = other.manage_data_;
   value_ = other.value_;
+  dict_entry_ = other.dict_entry_;
   switch (type_id_) {
     case TypeId::VARCHAR:
       if (size_.len_ == BUSTUB_VALUE_NULL) {
@@ -254,6 +256,15 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
   }
 }
 
+Value::Value(TypeId type, const DictionaryEntry *entry) : Value(type) {
+  if (type != TypeId::VARCHAR) {
+    throw Exception(ExceptionType::INCOMPATIBLE_TYPE, "Invalid Type for dictionary-encoded Value constructor");
+  }
+  value_.const_varlen_ = entry->data_.data();
+  size_.len_ = static_cast<uint32_t>(entry->data_.size());
+  dict_entry_ = entry;
+}
+
 // delete allocated char array space
 Value::~Value() {
   switch (type_id_) {
@@ -14,6 +14,7 @@
 #include <string>
 
 #include "common/exception.h"
+#include "type/dictionary.h"
 #include "type/type_util.h"
 #include "type/varlen_type.h"
 
@@ -36,6 +37,16 @@ namespace bustub {
     return GetCmpBool(TypeUtil::CompareStrings(str1, len1, str2, len2) OP 0); \
   }
 
+namespace {
+
+// Strings of one dictionary are equal exactly when their codes are
+auto SameDictionary(const Value &left, const Value &right) -> bool {
+  return left.GetDictionaryEntry() != nullptr && right.GetDictionaryEntry() != nullptr &&
+         left.GetDictionaryEntry()->dictionary_ == right.GetDictionaryEntry()->dictionary_;
+}
+
+}  // namespace
+
 VarlenType::VarlenType(TypeId type) : Type(type) {}
 
 VarlenType::~VarlenType() = default;
@@ -51,6 +62,9 @@ auto VarlenType::CompareEquals(const Value &left, const Value &right) const -> C
   if (left.IsNull() || right.IsNull()) {
     return CmpBool::CmpNull;
   }
+  if (SameDictionary(left, right)) {
+    return GetCmpBool(left.GetDictionaryEntry()->code_ == right.GetDictionaryEntry()->code_);
+  }
   if (GetLength(left) == BUSTUB_VARCHAR_MAX_LEN || GetLength(right) == BUSTUB_VARCHAR_MAX_LEN) {
     return GetCmpBool(GetLength(left) == GetLength(right));
   }
@@ -63,6 +77,9 @@ auto VarlenType::CompareNotEquals(const Value &left, const Value &right) const -
   if (left.IsNull() || right.IsNull()) {
     return CmpBool::CmpNull;
   }
+  if (SameDictionary(left, right)) {
+    return GetCmpBool(left.GetDictionaryEntry()->code_ != right.GetDictionaryEntry()->code_);
+  }
   if (GetLength(left) == BUSTUB_VARCHAR_MAX_LEN || GetLength(right) == BUSTUB_VARCHAR_MAX_LEN) {
     return GetCmpBool(GetLength(left) != GetLength(right));
   }
@@ -68,7 +68,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    assert(bucket_page->Insert(i, i, IntComparator()));
+    assert(bucket_page->Insert(i, i, IntComparator(), static_cast<uint8_t>(i)));
   }
 
   // check for the inserted pairs
@@ -80,7 +80,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   // remove a few pairs
   for (unsigned i = 0; i < 10; i++) {
     if (i % 2 == 1) {
-      assert(bucket_page->Remove(i, i, IntComparator()));
+      assert(bucket_page->Remove(i, i, IntComparator(), static_cast<uint8_t>(i)));
     }
   }
 
@@ -101,7 +101,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   // try to remove the already-removed pairs
   for (unsigned i = 0; i < 10; i++) {
     if (i % 2 == 1) {
-      assert(!bucket_page->Remove(i, i, IntComparator()));
+      assert(!bucket_page->Remove(i, i, IntComparator(), static_cast<uint8_t>(i)));
     }
   }
 
@@ -113,4 +113,50 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketFingerprintTest) {
+  auto *disk_manager = new DiskManager("hash_table_fingerprint_test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page =
+      reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(bpm->NewPage(&bucket_page_id)->GetData());
+
+  // Only a handful of fingerprints, so most probes hit slots holding other keys
+  auto fingerprint = [](int key) { return static_cast<uint8_t>(key % 3); };
+  int capacity = 0;
+  while (bucket_page->Insert(capacity, capacity, IntComparator(), fingerprint(capacity))) {
+    capacity++;
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(capacity, bucket_page->NumReadable());
+
+  for (int i = 0; i < capacity; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &res, fingerprint(i)));
+    EXPECT_EQ(std::vector<int>{i}, res);
+    EXPECT_EQ(fingerprint(i), bucket_page->FingerprintAt(i));
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(bucket_page->GetValue(capacity, IntComparator(), &res, fingerprint(capacity)));
+
+  // Tombstones are reused, and a removed pair no longer matches
+  EXPECT_TRUE(bucket_page->Remove(17, 17, IntComparator(), fingerprint(17)));
+  EXPECT_FALSE(bucket_page->GetValue(17, IntComparator(), &res, fingerprint(17)));
+  EXPECT_TRUE(bucket_page->Insert(17, 34, IntComparator(), fingerprint(17)));
+  EXPECT_EQ(34, bucket_page->ValueAt(17));
+  EXPECT_FALSE(bucket_page->Insert(17, 34, IntComparator(), fingerprint(17)));
+
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_TRUE(bucket_page->Remove(i, i == 17 ? 34 : i, IntComparator(), fingerprint(i)));
+  }
+  EXPECT_TRUE(bucket_page->IsEmpty());
+
+  bpm->UnpinPage(bucket_page_id, true);
+  disk_manager->ShutDown();
+  remove("hash_table_fingerprint_test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
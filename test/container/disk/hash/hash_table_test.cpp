@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -117,4 +118,60 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentSplitMergeTest) {
+  auto *disk_manager = new DiskManager("hash_table_concurrent_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // Each thread owns a stripe of keys, every key gets two values so buckets hold duplicates
+  const int num_threads = 4;
+  const int keys_per_thread = 3000;
+  auto run = [&](auto &&fn) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; i < keys_per_thread; i++) {
+          fn(i * num_threads + t);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  };
+
+  run([&](int key) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+    EXPECT_TRUE(ht.Insert(nullptr, key, -key - 1));
+  });
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+
+  run([&](int key) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, key, &res));
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ((std::vector<int>{-key - 1, key}), res);
+  });
+
+  run([&](int key) {
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+    EXPECT_TRUE(ht.Remove(nullptr, key, -key - 1));
+    EXPECT_FALSE(ht.Remove(nullptr, key, key));
+  });
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  std::vector<int> res;
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    EXPECT_FALSE(ht.GetValue(nullptr, key, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("hash_table_concurrent_test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
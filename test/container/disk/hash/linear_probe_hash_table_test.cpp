@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, IncrementalResizeTest) {
+  auto *disk_manager = new DiskManager("linear_probe_resize_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // Every pair stays visible while the table grows underneath it
+  const int num_keys = 5000;
+  bool saw_resize = false;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    saw_resize = saw_resize || ht.IsResizing();
+    if (i % 97 == 0) {
+      for (int j = 0; j <= i; j += 13) {
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, j, &res));
+        EXPECT_EQ(std::vector<int>{j}, res);
+      }
+    }
+  }
+  EXPECT_TRUE(saw_resize);
+  EXPECT_GE(ht.GetSize(), 2 * num_keys);
+  EXPECT_GT(ht.GetSize(), initial_size);
+
+  // Duplicate pairs are rejected, other values for the same key are kept
+  EXPECT_FALSE(ht.Insert(nullptr, 7, 7));
+  EXPECT_TRUE(ht.Insert(nullptr, 7, 8));
+  std::vector<int> res;
+  ht.GetValue(nullptr, 7, &res);
+  std::sort(res.begin(), res.end());
+  EXPECT_EQ((std::vector<int>{7, 8}), res);
+
+  // Lookups, removes and inserts keep moving entries until the old table is gone
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_FALSE(ht.IsResizing());
+
+  disk_manager->ShutDown();
+  remove("linear_probe_resize_test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentResizeTest) {
+  auto *disk_manager = new DiskManager("linear_probe_concurrent_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  // The even keys are inserted up front and must be found at all times, writers churn the odd ones
+  const int num_keys = 4000;
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      for (int i = 1 + 2 * t; i < 4 * num_keys; i += 4) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&, t] {
+      while (!done) {
+        for (int i = 2 * t; i < num_keys; i += 4) {
+          std::vector<int> res;
+          EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+          EXPECT_EQ(std::vector<int>{i}, res);
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  for (int i = 0; i < 4 * num_keys; i++) {
+    std::vector<int> res;
+    bool present = i % 2 == 0 ? i < num_keys : i % 3 != 0;
+    EXPECT_EQ(present, ht.GetValue(nullptr, i, &res)) << i;
+  }
+
+  disk_manager->ShutDown();
+  remove("linear_probe_concurrent_test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentSamePairInsertTest) {
+  auto *disk_manager = new DiskManager("linear_probe_same_pair_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  // Every thread inserts the same pairs, exactly one insert of each pair succeeds
+  const int num_keys = 2000;
+  const int num_threads = 4;
+  std::atomic<int> num_inserted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_keys; i++) {
+        if (ht.Insert(nullptr, i, i)) {
+          num_inserted++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_keys, num_inserted);
+
+  // A single remove takes each pair out for good
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    res.clear();
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res)) << i;
+  }
+
+  disk_manager->ShutDown();
+  remove("linear_probe_same_pair_test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// execution_test_util.h
+//
+// Identification: test/execution/execution_test_util.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binder/binder.h"
+#include "common/bustub_instance.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+
+namespace bustub {
+
+/** Run a statement and return its rows as comma separated lines, without the header */
+inline auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, ",");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/** Run a statement and return its rows one line each */
+inline auto QueryRows(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  std::stringstream ss(Query(bustub, sql));
+  std::vector<std::string> rows;
+  std::string row;
+  while (std::getline(ss, row)) {
+    rows.push_back(row);
+  }
+  return rows;
+}
+
+/** Bind, plan and optimize a query with the custom rules, without running it */
+inline auto Plan(BustubInstance *bustub, const std::string &sql) -> AbstractPlanNodeRef {
+  Binder binder(*bustub->catalog_);
+  binder.ParseAndSave(sql);
+  auto statement = binder.BindStatement(binder.statement_nodes_[0]);
+  Planner planner(*bustub->catalog_);
+  planner.PlanQuery(*statement);
+  Optimizer optimizer(*bustub->catalog_, false);
+  return optimizer.Optimize(planner.plan_);
+}
+
+}  // namespace bustub
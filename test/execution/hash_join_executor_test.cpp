@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor_test.cpp
+//
+// Identification: test/execution/hash_join_executor_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+auto ToString(const Tuple &tuple, const Schema &schema) -> std::string {
+  std::string row;
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    row += tuple.GetValue(&schema, i).ToString() + ",";
+  }
+  return row;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(HashJoinExecutorTest, StreamsManyMatchesPerKey) {
+  auto bustub = std::make_unique<BustubInstance>();
+  Query(bustub.get(), "CREATE TABLE t (a INTEGER, b INTEGER);");
+  Query(bustub.get(), "CREATE TABLE s (c INTEGER, d INTEGER);");
+  Query(bustub.get(), "INSERT INTO t VALUES (1, 10), (2, 20), (1, 11), (3, 30), (1, 12);");
+  // Key 1 has more matches than a batch holds, so its matches are returned across several calls
+  std::vector<std::string> rows;
+  for (int i = 0; i < 3000; i++) {
+    rows.push_back(fmt::format("({}, {})", i % 1000 == 999 ? 2 : 1, i));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO s VALUES {};", fmt::join(rows, ", ")));
+
+  auto inner = QueryRows(bustub.get(), "SELECT * FROM t INNER JOIN s ON a = c;");
+  std::map<std::string, size_t> counts;
+  for (const auto &row : inner) {
+    counts[row.substr(0, row.find(',', row.find(',') + 1))]++;
+  }
+  ASSERT_EQ(inner.size(), 3 * 2997 + 3);
+  ASSERT_EQ(counts["1,10"], 2997);
+  ASSERT_EQ(counts["1,12"], 2997);
+  ASSERT_EQ(counts["2,20"], 3);
+  // The rows come out in the order of the left side
+  ASSERT_EQ(inner.front().substr(0, 5), "1,10,");
+  ASSERT_EQ(inner.back().substr(0, 5), "1,12,");
+
+  auto left = QueryRows(bustub.get(), "SELECT * FROM t LEFT JOIN s ON a = c;");
+  ASSERT_EQ(left.size(), inner.size() + 1);
+  ASSERT_EQ(std::count(left.begin(), left.end(), "3,30,integer_null,integer_null,"), 1);
+
+  // Pulled from directly, the join probes as rows are asked for; a batch after single rows picks up where they ended
+  auto *txn = bustub->txn_manager_->Begin();
+  ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_, false);
+  auto plan = Plan(bustub.get(), "SELECT * FROM t LEFT JOIN s ON a = c;");
+  ASSERT_EQ(plan->GetType(), PlanType::HashJoin);
+  auto executor = ExecutorFactory::CreateExecutor(&exec_ctx, plan);
+  executor->Init();
+  std::vector<std::string> pulled;
+  Tuple tuple;
+  RID rid;
+  TupleBatch batch;
+  for (size_t round = 0;; round++) {
+    if (round % 2 == 0) {
+      for (int i = 0; i < 7 && executor->Next(&tuple, &rid); i++) {
+        pulled.push_back(ToString(tuple, plan->OutputSchema()));
+      }
+    } else if (executor->NextBatch(&batch)) {
+      for (size_t row = 0; row < batch.Size(); row++) {
+        pulled.push_back(ToString(batch.GetTuple(row, plan->OutputSchema()), plan->OutputSchema()));
+      }
+    } else {
+      break;
+    }
+  }
+  ASSERT_EQ(pulled, left);
+  ASSERT_FALSE(executor->Next(&tuple, &rid));
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST(HashJoinExecutorTest, SpillsOverMemoryBudget) {
+  auto saved_budget = query_memory_budget.load();
+  auto bustub = std::make_unique<BustubInstance>();
+  Query(bustub.get(), "CREATE TABLE t (a INTEGER, b VARCHAR(16));");
+  Query(bustub.get(), "CREATE TABLE s (c INTEGER, d VARCHAR(16));");
+  std::vector<std::string> rows;
+  for (int i = 0; i < 1500; i++) {
+    rows.push_back(fmt::format("({}, 'b{}')", i % 700, i));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+  rows.clear();
+  for (int i = 0; i < 2000; i++) {
+    rows.push_back(fmt::format("({}, 'd{}')", i % 500, i));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO s VALUES {};", fmt::join(rows, ", ")));
+
+  std::vector<std::string> queries = {
+      "SELECT * FROM t INNER JOIN s ON a = c;",
+      "SELECT * FROM t LEFT JOIN s ON a = c;",
+  };
+  for (const auto &sql : queries) {
+    query_memory_budget = saved_budget;
+    auto expected = QueryRows(bustub.get(), sql);
+    query_memory_budget = 16 << 10;
+    auto actual = QueryRows(bustub.get(), sql);
+    // Spilled partitions are joined last, so only the order of the rows differs
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(expected, actual) << sql;
+  }
+
+  // Pulled from directly, with the budget held for the hash table given back once the join is done
+  auto *txn = bustub->txn_manager_->Begin();
+  ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_, false);
+  auto plan = Plan(bustub.get(), "SELECT * FROM t LEFT JOIN s ON a = c;");
+  ASSERT_EQ(plan->GetType(), PlanType::HashJoin);
+  {
+    auto executor = ExecutorFactory::CreateExecutor(&exec_ctx, plan);
+    executor->Init();
+    auto *join = dynamic_cast<HashJoinExecutor *>(executor.get());
+    ASSERT_GT(join->GetNumSpilledPartitions(), 0);
+    ASSERT_LT(join->GetNumSpilledPartitions(), HashJoinExecutor::SPILL_PARTITIONS);
+    ASSERT_LE(exec_ctx.GetMemoryUsed(), 16 << 10);
+    size_t pulled = 0;
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      pulled += batch.Size();
+    }
+    // Keys 0 to 99 match 3 x 4 rows, keys 100 to 499 match 2 x 4 rows, keys 500 to 699 are 2 unmatched rows each
+    ASSERT_EQ(pulled, 100 * 12 + 400 * 8 + 200 * 2);
+  }
+  ASSERT_EQ(exec_ctx.GetMemoryUsed(), 0);
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  query_memory_budget = saved_budget;
+}
+
+// NOLINTNEXTLINE
+TEST(HashJoinExecutorTest, ParallelJoinMatchesSerial) {
+  auto saved_workers = hash_join_workers.load();
+  auto bustub = std::make_unique<BustubInstance>();
+  Query(bustub.get(), "CREATE TABLE t (a INTEGER, b INTEGER);");
+  Query(bustub.get(), "CREATE TABLE s (c INTEGER, d VARCHAR(16));");
+  Query(bustub.get(), "CREATE TABLE u (e INTEGER, f INTEGER);");
+  std::vector<std::string> rows;
+  for (int i = 0; i < 6000; i++) {
+    rows.push_back(fmt::format("({}, {})", i, i % 13));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+  // Enough right rows for the partitions to be built in parallel
+  rows.clear();
+  for (int i = 0; i < 20000; i++) {
+    rows.push_back(fmt::format("({}, 'd{}')", i % 4000, i));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO s VALUES {};", fmt::join(rows, ", ")));
+  rows.clear();
+  for (int i = 0; i < 500; i++) {
+    rows.push_back(fmt::format("({}, {})", i * 2, i));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO u VALUES {};", fmt::join(rows, ", ")));
+
+  std::vector<std::string> queries = {
+      "SELECT * FROM t INNER JOIN s ON a = c;",
+      "SELECT * FROM t LEFT JOIN s ON a = c;",
+      "SELECT * FROM t INNER JOIN s ON a = c INNER JOIN u ON c = e;",
+  };
+  for (const auto &sql : queries) {
+    hash_join_workers = 1;
+    auto expected = QueryRows(bustub.get(), sql);
+    hash_join_workers = 4;
+    auto actual = QueryRows(bustub.get(), sql);
+    ASSERT_FALSE(expected.empty()) << sql;
+    // Morsels are handed on in the order they were pulled in, so the rows come out as a serial run returns them
+    ASSERT_EQ(expected, actual) << sql;
+  }
+  hash_join_workers = saved_workers;
+}
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table_test.cpp
+//
+// Identification: test/execution/join_hash_table_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/join_hash_table.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(JoinHashTableTest, ChainsRowsOfAKeyInOrder) {
+  Schema schema({Column("k", TypeId::INTEGER), Column("s", TypeId::VARCHAR, 32)});
+  JoinHashTable table(2);
+  // Keys are (i % 100, "k" + i % 3), so each of the 300 keys has the rows i, i + 300, i + 600, ...
+  std::vector<std::vector<Value>> keys(2);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 3000; i++) {
+    keys[0].push_back(ValueFactory::GetIntegerValue(i % 100));
+    keys[1].push_back(ValueFactory::GetVarcharValue("k" + std::to_string(i % 3)));
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i),
+                                           ValueFactory::GetVarcharValue("row" + std::to_string(i))},
+                        &schema);
+  }
+  std::vector<hash_t> hashes;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    hashes.push_back(JoinHashTable::HashKey(keys, i));
+  }
+  auto probe_keys = keys;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    table.Append(hashes[i], &keys, i, tuples[i]);
+  }
+  table.Build();
+  ASSERT_EQ(table.GetNumRows(), 3000);
+
+  std::vector<uint32_t> heads;
+  table.FindBatch(hashes, probe_keys, &heads);
+  for (size_t i = 0; i < 300; i++) {
+    ASSERT_EQ(heads[i], i);
+    std::vector<int32_t> matches;
+    for (auto row = heads[i]; row != JoinHashTable::NO_ROW; row = table.NextMatch(row)) {
+      auto tuple = table.GetTuple(row);
+      matches.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      ASSERT_EQ(tuple.CopyValue(&schema, 1).ToString(), "row" + std::to_string(matches.back()));
+    }
+    ASSERT_EQ(matches.size(), 10);
+    for (size_t j = 0; j < matches.size(); j++) {
+      ASSERT_EQ(matches[j], i + j * 300);
+    }
+  }
+  // Every later row of a key finds the first row of the key
+  ASSERT_EQ(heads[2999], 2999 % 300);
+
+  // A key that is not in the table, and one with a null value, find nothing
+  std::vector<std::vector<Value>> missing = {
+      {ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(1)},
+      {ValueFactory::GetVarcharValue("k0"), ValueFactory::GetNullValueByType(TypeId::VARCHAR)}};
+  ASSERT_FALSE(JoinHashTable::HasNullKey(missing, 0));
+  ASSERT_TRUE(JoinHashTable::HasNullKey(missing, 1));
+  ASSERT_EQ(table.Find(JoinHashTable::HashKey(missing, 0), missing, 0), JoinHashTable::NO_ROW);
+  ASSERT_EQ(table.Find(JoinHashTable::HashKey(missing, 1), missing, 1), JoinHashTable::NO_ROW);
+
+  table.Clear();
+  ASSERT_EQ(table.GetNumRows(), 0);
+  ASSERT_EQ(table.Find(hashes[0], probe_keys, 0), JoinHashTable::NO_ROW);
+}
+
+}  // namespace bustub
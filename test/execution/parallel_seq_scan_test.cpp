@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_seq_scan_test.cpp
+//
+// Identification: test/execution/parallel_seq_scan_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fmt/format.h>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelSeqScanTest, MatchesSerialScan) {
+  auto saved_workers = parallel_scan_workers.load();
+  auto bustub = std::make_unique<BustubInstance>();
+  Query(bustub.get(), "CREATE TABLE t (a INTEGER, b VARCHAR(300));");
+  Query(bustub.get(), "CREATE TABLE s (c INTEGER);");
+  Query(bustub.get(), "INSERT INTO s VALUES (3), (1500), (2999);");
+  for (int i = 0; i < 3000; i += 100) {
+    std::vector<std::string> rows;
+    for (int j = i; j < i + 100; j++) {
+      rows.push_back(fmt::format("({}, '{}')", j, std::string(200 + j % 50, 'a' + j % 26)));
+    }
+    Query(bustub.get(), fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+  }
+  Query(bustub.get(), "DELETE FROM t WHERE a >= 1000 AND a < 1010;");
+  ASSERT_GE(bustub->catalog_->GetTable("t")->table_->GetNumPages(), ParallelSeqScanExecutor::MIN_PAGES);
+
+  std::vector<std::string> queries = {
+      "SELECT * FROM t;",
+      "SELECT a FROM t WHERE a > 1200 AND a < 1300;",
+      "SELECT a FROM t WHERE a = 2999 OR a < 5;",
+      "SELECT count(*), sum(a), max(a) FROM t;",
+      "SELECT c, a FROM s, t WHERE c = a;",
+  };
+  for (const auto &sql : queries) {
+    parallel_scan_workers = 1;
+    auto expected = Query(bustub.get(), sql);
+    parallel_scan_workers = 4;
+    auto actual = Query(bustub.get(), sql);
+    ASSERT_FALSE(expected.empty()) << sql;
+    // Morsels are returned in page order, so the rows come out as a serial scan returns them
+    ASSERT_EQ(expected, actual) << sql;
+  }
+  ASSERT_EQ(Query(bustub.get(), "SELECT count(*) FROM t;"), "2990,\n");
+  parallel_scan_workers = saved_workers;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelSeqScanTest, LocksRowsNotTheTable) {
+  auto saved_workers = parallel_scan_workers.load();
+  parallel_scan_workers = 4;
+  auto bustub = std::make_unique<BustubInstance>();
+  Query(bustub.get(), "CREATE TABLE t (a INTEGER, b VARCHAR(300));");
+  for (int i = 0; i < 2000; i += 100) {
+    std::vector<std::string> rows;
+    for (int j = i; j < i + 100; j++) {
+      rows.push_back(fmt::format("({}, '{}')", j, std::string(250, 'a' + j % 26)));
+    }
+    Query(bustub.get(), fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+  }
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto oid = table_info->oid_;
+  auto schema = std::make_shared<const Schema>(table_info->schema_);
+  auto plan = std::make_shared<SeqScanPlanNode>(schema, oid, table_info->name_);
+  ExecutorContext probe_ctx(nullptr, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                            bustub->lock_manager_, false);
+  ASSERT_TRUE(ParallelSeqScanExecutor::CanRun(&probe_ctx, plan.get()));
+
+  auto scan = [&](Transaction *txn) {
+    ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                             bustub->lock_manager_, false);
+    ParallelSeqScanExecutor executor(&exec_ctx, plan.get());
+    executor.Init();
+    size_t num_rows = 0;
+    Tuple tuple;
+    RID rid;
+    while (executor.Next(&tuple, &rid)) {
+      // A returned row is read under a shared lock, read committed lets go of it once its morsel is gathered
+      if (txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ) {
+        EXPECT_TRUE(txn->IsRowSharedLocked(oid, rid));
+      }
+      num_rows++;
+    }
+    return num_rows;
+  };
+
+  // Repeatable read holds the row locks of the rows it read, under an intention lock on the table
+  auto *txn = bustub->txn_manager_->Begin(nullptr, IsolationLevel::REPEATABLE_READ);
+  ASSERT_EQ(scan(txn), 2000);
+  ASSERT_TRUE(txn->IsTableIntentionSharedLocked(oid));
+  ASSERT_FALSE(txn->IsTableSharedLocked(oid));
+  ASSERT_EQ((*txn->GetSharedRowLockSet())[oid].size(), 2000);
+
+  // So another transaction may still write rows the scan did not read
+  auto *writer = bustub->txn_manager_->Begin(nullptr, IsolationLevel::REPEATABLE_READ);
+  ASSERT_TRUE(bustub->lock_manager_->LockTable(writer, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  bustub->txn_manager_->Commit(writer);
+  delete writer;
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+
+  // Read committed keeps no row locks once the scan is done
+  txn = bustub->txn_manager_->Begin(nullptr, IsolationLevel::READ_COMMITTED);
+  ASSERT_EQ(scan(txn), 2000);
+  ASSERT_FALSE(txn->IsTableSharedLocked(oid));
+  ASSERT_TRUE((*txn->GetSharedRowLockSet())[oid].empty());
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  parallel_scan_workers = saved_workers;
+}
+
+}  // namespace bustub
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_test.cpp
+//
+// Identification: test/execution/pipeline_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fmt/format.h>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/pipeline.h"
+#include "execution_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+void FillTables(BustubInstance *bustub) {
+  Query(bustub, "CREATE TABLE t (a INTEGER, b INTEGER);");
+  Query(bustub, "CREATE TABLE s (c INTEGER, d VARCHAR(16));");
+  std::vector<std::string> rows;
+  for (int i = 0; i < 1000; i++) {
+    rows.push_back(fmt::format("({}, {})", i, i % 37));
+  }
+  Query(bustub, fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+  rows.clear();
+  for (int i = 0; i < 300; i++) {
+    rows.push_back(fmt::format("({}, 'd{}')", i * 3, i % 11));
+  }
+  Query(bustub, fmt::format("INSERT INTO s VALUES {};", fmt::join(rows, ", ")));
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(PipelineTest, SplitsAtBreakers) {
+  auto bustub = std::make_unique<BustubInstance>();
+  FillTables(bustub.get());
+  auto *txn = bustub->txn_manager_->Begin();
+  ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_, false);
+
+  // A scan with a filter and a projection is a single pipeline
+  ASSERT_EQ(PipelineGraph(&exec_ctx, Plan(bustub.get(), "SELECT a + 1 FROM t WHERE b = 3;"), nullptr)
+                .GetPipelines()
+                .size(),
+            1);
+
+  // The build of a hash join is a pipeline of its own, the probe runs in the pipeline of the left side
+  auto join_plan = Plan(bustub.get(), "SELECT * FROM t, s WHERE a = c;");
+  ASSERT_EQ(join_plan->GetType(), PlanType::HashJoin);
+  PipelineGraph join(&exec_ctx, join_plan, nullptr);
+  ASSERT_EQ(join.GetPipelines().size(), 2);
+  ASSERT_EQ(join.GetPipelines()[1]->GetDependencies(),
+            std::vector<Pipeline *>{join.GetPipelines()[0].get()});
+
+  // Scan into the aggregation, aggregation into the sort, sort into the result
+  PipelineGraph sort(&exec_ctx, Plan(bustub.get(), "SELECT b, count(*) FROM t GROUP BY b ORDER BY b;"), nullptr);
+  const auto &pipelines = sort.GetPipelines();
+  ASSERT_EQ(pipelines.size(), 3);
+  for (size_t i = 1; i < pipelines.size(); i++) {
+    ASSERT_EQ(pipelines[i]->GetDependencies(), std::vector<Pipeline *>{pipelines[i - 1].get()});
+  }
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST(PipelineTest, MatchesSerialRun) {
+  auto saved_workers = pipeline_workers.load();
+  auto saved_table_locks = pipeline_table_locks.load();
+  // The queries run under repeatable read, which only runs pipelines concurrently when it may lock whole tables
+  pipeline_table_locks = true;
+  auto bustub = std::make_unique<BustubInstance>();
+  FillTables(bustub.get());
+
+  std::vector<std::string> queries = {
+      "SELECT a, d FROM t, s WHERE a = c;",
+      "SELECT b, count(*), sum(a) FROM t GROUP BY b ORDER BY b;",
+      "SELECT d, count(*), min(c) FROM s GROUP BY d;",
+      "SELECT * FROM t LEFT JOIN s ON a = c;",
+      "SELECT b, count(*) FROM t WHERE a > 500 GROUP BY b ORDER BY b DESC;",
+  };
+  for (const auto &sql : queries) {
+    pipeline_workers = 1;
+    auto expected = Query(bustub.get(), sql);
+    pipeline_workers = 4;
+    auto actual = Query(bustub.get(), sql);
+    ASSERT_FALSE(expected.empty()) << sql;
+    // Pipelines hand their output on only once they are done, so the rows come out as a serial run returns them
+    ASSERT_EQ(expected, actual) << sql;
+  }
+  pipeline_workers = saved_workers;
+  pipeline_table_locks = saved_table_locks;
+}
+
+// NOLINTNEXTLINE
+TEST(PipelineTest, LocksTablesOnlyWhenAsked) {
+  auto saved_workers = pipeline_workers.load();
+  auto saved_table_locks = pipeline_table_locks.load();
+  pipeline_workers = 4;
+  pipeline_table_locks = false;
+  auto bustub = std::make_unique<BustubInstance>();
+  FillTables(bustub.get());
+  auto plan = Plan(bustub.get(), "SELECT * FROM t, s WHERE a = c;");
+  auto t_oid = bustub->catalog_->GetTable("t")->oid_;
+  auto s_oid = bustub->catalog_->GetTable("s")->oid_;
+
+  auto init = [&](Transaction *txn) {
+    ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                             bustub->lock_manager_, false);
+    PipelineGraph graph(&exec_ctx, plan, nullptr);
+    graph.Init();
+    return graph.IsConcurrent();
+  };
+
+  // Scans that lock rows keep to the calling thread, under an intention lock on their tables
+  for (auto isolation_level : {IsolationLevel::READ_COMMITTED, IsolationLevel::REPEATABLE_READ}) {
+    auto *txn = bustub->txn_manager_->Begin(nullptr, isolation_level);
+    ASSERT_FALSE(init(txn));
+    ASSERT_TRUE(txn->IsTableIntentionSharedLocked(t_oid));
+    ASSERT_FALSE(txn->IsTableSharedLocked(t_oid));
+    ASSERT_FALSE(txn->IsTableSharedLocked(s_oid));
+    bustub->txn_manager_->Commit(txn);
+    delete txn;
+  }
+
+  // Nothing is locked under read uncommitted
+  auto *txn = bustub->txn_manager_->Begin(nullptr, IsolationLevel::READ_UNCOMMITTED);
+  ASSERT_TRUE(init(txn));
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+
+  // Tables are shared-locked when asked for, and only under repeatable read
+  pipeline_table_locks = true;
+  txn = bustub->txn_manager_->Begin(nullptr, IsolationLevel::READ_COMMITTED);
+  ASSERT_FALSE(init(txn));
+  ASSERT_FALSE(txn->IsTableSharedLocked(t_oid));
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  txn = bustub->txn_manager_->Begin(nullptr, IsolationLevel::REPEATABLE_READ);
+  ASSERT_TRUE(init(txn));
+  ASSERT_TRUE(txn->IsTableSharedLocked(t_oid));
+  ASSERT_TRUE(txn->IsTableSharedLocked(s_oid));
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+
+  pipeline_workers = saved_workers;
+  pipeline_table_locks = saved_table_locks;
+}
+
+}  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// runtime_filter_test.cpp
+//
+// Identification: test/execution/runtime_filter_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fmt/format.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/join_hash_table.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/runtime_filter.h"
+#include "execution_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+void FillTables(BustubInstance *bustub) {
+  Query(bustub, "CREATE TABLE t (a INTEGER, b VARCHAR(16));");
+  Query(bustub, "CREATE TABLE s (c INTEGER, d VARCHAR(16));");
+  std::vector<std::string> rows;
+  for (int i = 0; i < 10000; i++) {
+    rows.push_back(i % 97 == 0 ? fmt::format("(NULL, 'b{}')", i % 5) : fmt::format("({}, 'b{}')", i, i % 5));
+  }
+  Query(bustub, fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+  // The keys of s are a few scattered ones, with a null key that must not match the nulls of t
+  rows.clear();
+  for (int i = 0; i < 40; i++) {
+    rows.push_back(fmt::format("({}, 'b{}')", 3000 + i * 53, i % 3));
+  }
+  rows.emplace_back("(NULL, 'b0')");
+  Query(bustub, fmt::format("INSERT INTO s VALUES {};", fmt::join(rows, ", ")));
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(RuntimeFilterTest, ScanDropsRowsWithoutMatch) {
+  auto bustub = std::make_unique<BustubInstance>();
+  FillTables(bustub.get());
+  auto *table_info = bustub->catalog_->GetTable("t");
+
+  // A filter over the keys 100 to 199 of column a
+  auto key = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto filter = std::make_shared<RuntimeFilter>(std::vector<AbstractExpressionRef>{key});
+  std::vector<std::vector<Value>> keys(1);
+  for (int i = 100; i < 200; i++) {
+    keys[0].push_back(ValueFactory::GetIntegerValue(i));
+  }
+  for (size_t row = 0; row < keys[0].size(); row++) {
+    filter->AddKey(JoinHashTable::HashKey(keys, row), keys, row);
+  }
+  filter->Build();
+
+  auto *txn = bustub->txn_manager_->Begin();
+  ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_, false);
+  auto plan = std::make_shared<SeqScanPlanNode>(std::make_shared<const Schema>(table_info->schema_),
+                                                table_info->oid_, table_info->name_);
+  SeqScanExecutor scan(&exec_ctx, plan.get());
+  scan.Init();
+  scan.AddRuntimeFilter(filter);
+  std::vector<int32_t> kept;
+  TupleBatch batch;
+  while (scan.NextBatch(&batch)) {
+    for (size_t row = 0; row < batch.Size(); row++) {
+      kept.push_back(batch.GetColumn(0)[row].GetAs<int32_t>());
+    }
+  }
+  // No key of the filter is lost; the range drops most other rows, the Bloom filter those within the range
+  std::vector<int32_t> expected;
+  for (int i = 100; i < 200; i++) {
+    if (i % 97 != 0) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_EQ(kept, expected);
+  ASSERT_GT(scan.GetNumRuntimeFiltered(), 0);
+
+  // Initializing the scan again forgets the filter
+  scan.Init();
+  size_t num_rows = 0;
+  while (scan.NextBatch(&batch)) {
+    num_rows += batch.Size();
+  }
+  ASSERT_EQ(num_rows, 10000);
+  ASSERT_EQ(scan.GetNumRuntimeFiltered(), 0);
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST(RuntimeFilterTest, JoinsMatchWithoutFilters) {
+  auto saved_enabled = enable_runtime_filters.load();
+  auto saved_workers = parallel_scan_workers.load();
+  auto bustub = std::make_unique<BustubInstance>();
+  FillTables(bustub.get());
+  ASSERT_GE(bustub->catalog_->GetTable("t")->table_->GetNumPages(), ParallelSeqScanExecutor::MIN_PAGES);
+
+  std::vector<std::string> queries = {
+      "SELECT * FROM t INNER JOIN s ON a = c;",
+      "SELECT * FROM t INNER JOIN s ON a = c AND b = d;",
+      "SELECT * FROM t INNER JOIN s ON b = d;",
+      // A left join keeps the rows without a match, it passes no filter down
+      "SELECT * FROM t LEFT JOIN s ON a = c;",
+  };
+  for (size_t workers : {1, 4}) {
+    parallel_scan_workers = workers;
+    for (const auto &sql : queries) {
+      enable_runtime_filters = false;
+      auto expected = Query(bustub.get(), sql);
+      enable_runtime_filters = true;
+      auto actual = Query(bustub.get(), sql);
+      ASSERT_FALSE(expected.empty()) << sql;
+      ASSERT_EQ(expected, actual) << sql << " with " << workers << " scan workers";
+    }
+  }
+  enable_runtime_filters = saved_enabled;
+  parallel_scan_workers = saved_workers;
+}
+
+}  // namespace bustub
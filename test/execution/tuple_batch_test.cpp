@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch_test.cpp
+//
+// Identification: test/execution/tuple_batch_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/tuple_batch.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, AppendSelectTest) {
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 32}});
+  TupleBatch batch;
+  batch.Reset(schema);
+  for (int i = 0; i < 10; i++) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::to_string(i * 11))}, &schema};
+    batch.Append(tuple, schema, RID{0, static_cast<uint32_t>(i)});
+  }
+  ASSERT_EQ(batch.Size(), 10);
+  ASSERT_EQ(batch.GetColumnCount(), 2);
+  ASSERT_EQ(batch.GetTuple(3, schema).GetValue(&schema, 1).ToString(), "33");
+
+  // Keep the even rows, a null drops its row like false does
+  std::vector<Value> predicate;
+  for (int i = 0; i < 10; i++) {
+    predicate.push_back(i == 4 ? ValueFactory::GetNullValueByType(TypeId::BOOLEAN)
+                               : ValueFactory::GetBooleanValue(i % 2 == 0));
+  }
+  batch.Select(predicate);
+  ASSERT_EQ(batch.Size(), 4);
+  std::vector<int> expected = {0, 2, 6, 8};
+  for (size_t row = 0; row < batch.Size(); row++) {
+    ASSERT_EQ(batch.GetColumn(0)[row].GetAs<int32_t>(), expected[row]);
+    ASSERT_EQ(batch.GetColumn(1)[row].ToString(), std::to_string(expected[row] * 11));
+    ASSERT_EQ(batch.GetRID(row), (RID{0, static_cast<uint32_t>(expected[row])}));
+  }
+
+  batch.Reset(schema);
+  ASSERT_TRUE(batch.IsEmpty());
+  ASSERT_EQ(batch.GetColumn(0).size(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(TupleBatchTest, EvaluateBatchTest) {
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}});
+  TupleBatch batch;
+  batch.Reset(schema);
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; i++) {
+    auto b = i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(100 - i);
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), b}, &schema);
+    batch.Append(tuples.back(), schema, RID{});
+  }
+
+  // (a + b = 100) or (a < 10 and b > 95), with constants and nulls mixed in
+  auto a = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto b = std::make_shared<ColumnValueExpression>(0, 1, TypeId::INTEGER);
+  auto sum = std::make_shared<ArithmeticExpression>(a, b, ArithmeticType::Plus);
+  auto eq = std::make_shared<ComparisonExpression>(
+      sum, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(100)), ComparisonType::Equal);
+  auto lt = std::make_shared<ComparisonExpression>(
+      a, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(10)), ComparisonType::LessThan);
+  auto gt = std::make_shared<ComparisonExpression>(
+      b, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(95)), ComparisonType::GreaterThan);
+  auto expr = std::make_shared<LogicExpression>(eq, std::make_shared<LogicExpression>(lt, gt, LogicType::And),
+                                                LogicType::Or);
+
+  // Every row evaluates to what the row-at-a-time path gives
+  for (const AbstractExpressionRef &e : std::vector<AbstractExpressionRef>{a, sum, eq, expr}) {
+    auto values = e->EvaluateBatch(batch, schema);
+    ASSERT_EQ(values.size(), tuples.size());
+    for (size_t row = 0; row < tuples.size(); row++) {
+      auto expected = e->Evaluate(&tuples[row], schema);
+      ASSERT_EQ(values[row].IsNull(), expected.IsNull()) << e->ToString() << " row " << row;
+      if (!expected.IsNull()) {
+        ASSERT_EQ(values[row].CompareEquals(expected), CmpBool::CmpTrue) << e->ToString() << " row " << row;
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -402,4 +404,70 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, ScanWithWritersTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small pages, so the writers split and merge leaves under the scans all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 4, 4);
+
+  // Even keys stay in the tree for the whole test, odd keys come and go
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t total_keys = 400;
+  for (int64_t i = 1; i <= total_keys; i++) {
+    (i % 2 == 0 ? perserved_keys : dynamic_keys).push_back(i);
+  }
+  InsertHelper(&tree, perserved_keys);
+
+  std::atomic<bool> done{false};
+  auto writer_task = [&](int tid) {
+    while (!done) {
+      InsertHelper(&tree, dynamic_keys, tid);
+      DeleteHelper(&tree, dynamic_keys, tid);
+    }
+  };
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 2; i++) {
+    writers.emplace_back(writer_task, i);
+  }
+
+  // Every scan sees each preserved key exactly once and in order, whatever the writers did meanwhile
+  for (int round = 0; round < 20; round++) {
+    bool reverse = round % 2 == 1;
+    std::vector<int64_t> seen;
+    int64_t prev = reverse ? total_keys + 1 : 0;
+    for (auto iter = reverse ? tree.RBegin() : tree.Begin(); iter != tree.End(); ++iter) {
+      int64_t key = (*iter).first.ToString();
+      EXPECT_TRUE(reverse ? key < prev : key > prev);
+      prev = key;
+      if (key % 2 == 0) {
+        seen.push_back(key);
+      }
+      // a slow consumer, the writers keep going in the meantime
+      std::this_thread::yield();
+    }
+    if (reverse) {
+      std::reverse(seen.begin(), seen.end());
+    }
+    EXPECT_EQ(seen, perserved_keys);
+  }
+  done = true;
+  for (auto &writer : writers) {
+    writer.join();
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -156,4 +156,140 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   delete transaction;
   delete bpm;
 }
+
+TEST(BPlusTreeTests, StatsAndRebuildTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  auto empty_stats = tree.CollectStats();
+  EXPECT_EQ(empty_stats.height_, 0);
+  EXPECT_EQ(empty_stats.num_entries_, 0);
+
+  // 99 entries are left after the deletes, exactly 33 full leaves of 3 entries
+  int64_t scale = 297;
+  for (int64_t key = 1; key <= scale; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  auto stats = tree.CollectStats();
+  EXPECT_EQ(stats.num_entries_, scale);
+  EXPECT_GE(stats.height_, 4);
+  EXPECT_EQ(stats.num_underfull_leaves_, 0);
+  size_t histogram_leaves = 0;
+  for (auto count : stats.leaf_fill_histogram_) {
+    histogram_leaves += count;
+  }
+  EXPECT_EQ(histogram_leaves, stats.num_leaf_pages_);
+
+  // Keep every third key
+  for (int64_t key = 1; key <= scale; key++) {
+    if (key % 3 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  stats = tree.CollectStats();
+  EXPECT_EQ(stats.num_entries_, scale / 3);
+
+  tree.Rebuild();
+  auto rebuilt = tree.CollectStats();
+  EXPECT_EQ(rebuilt.num_entries_, scale / 3);
+  EXPECT_EQ(rebuilt.num_underfull_leaves_, 0);
+  EXPECT_EQ(rebuilt.num_leaf_discontinuities_, 0);
+  EXPECT_LE(rebuilt.num_leaf_pages_, stats.num_leaf_pages_);
+  EXPECT_LE(rebuilt.height_, stats.height_);
+  EXPECT_DOUBLE_EQ(rebuilt.avg_leaf_fill_, 1.0);
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 3 == 0);
+  }
+  int64_t expected = 3;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it, expected += 3) {
+    EXPECT_EQ((*it).second.GetSlotNum(), expected);
+  }
+  EXPECT_EQ(expected, scale + 3);
+  for (auto it = tree.RBegin(); !it.IsEnd(); ++it) {
+    expected -= 3;
+    EXPECT_EQ((*it).second.GetSlotNum(), expected);
+  }
+  EXPECT_EQ(expected, 3);
+
+  // The rebuilt tree keeps working as a regular tree
+  for (int64_t key = 1; key <= scale; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  EXPECT_EQ(tree.CollectStats().num_entries_, scale);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, RebuildWithOpenIteratorTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  int64_t scale = 200;
+  for (int64_t key = 1; key <= scale; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // The iterator pins an old leaf across the rebuild, so that leaf is retired instead of freed
+  auto it = tree.Begin();
+  int64_t expected = 1;
+  for (; expected <= scale / 2; ++it, expected++) {
+    ASSERT_EQ((*it).second.GetSlotNum(), expected);
+  }
+  tree.Rebuild();
+  for (; !it.IsEnd(); ++it, expected++) {
+    ASSERT_EQ((*it).second.GetSlotNum(), expected);
+  }
+  EXPECT_EQ(expected, scale + 1);
+  it = tree.End();
+
+  // The next rebuild frees the retired leaf, and the tree keeps its entries
+  tree.Rebuild();
+  auto stats = tree.CollectStats();
+  EXPECT_EQ(stats.num_entries_, scale);
+  expected = 1;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter, expected++) {
+    ASSERT_EQ((*iter).second.GetSlotNum(), expected);
+  }
+  EXPECT_EQ(expected, scale + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
 }  // namespace bustub
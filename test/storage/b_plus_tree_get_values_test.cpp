@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_get_values_test.cpp
+//
+// Identification: test/storage/b_plus_tree_get_values_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fmt/format.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, GetValuesTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // small nodes, so the keys span many leaves and the tree is a few levels high
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  auto *transaction = new Transaction(0);
+
+  // an empty tree finds nothing
+  std::vector<GenericKey<8>> batch(3);
+  for (size_t i = 0; i < batch.size(); i++) {
+    batch[i].SetFromInteger(static_cast<int64_t>(i));
+  }
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(batch, &results);
+  ASSERT_EQ(results.size(), batch.size());
+  for (const auto &result : results) {
+    EXPECT_TRUE(result.empty());
+  }
+
+  // the even keys 2 to 600
+  for (int64_t key = 2; key <= 600; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+  }
+
+  // keys before and after the range, missing keys, duplicates, runs of neighbours and far jumps
+  std::vector<int64_t> keys = {-5,  0,   1,   2,   2,   3,   4,   6,   8,   9,   10, 11,
+                               12, 100, 101, 102, 102, 300, 598, 599, 600, 601, 900};
+  batch.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    batch[i].SetFromInteger(keys[i]);
+  }
+  tree.GetValues(batch, &results, transaction);
+  ASSERT_EQ(results.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    auto key = keys[i];
+    if (key >= 2 && key <= 600 && key % 2 == 0) {
+      ASSERT_EQ(results[i].size(), 1) << key;
+      EXPECT_EQ(results[i][0].GetSlotNum(), key);
+    } else {
+      EXPECT_TRUE(results[i].empty()) << key;
+    }
+  }
+
+  // every key of the tree in one batch walks the whole leaf chain
+  keys.clear();
+  for (int64_t key = 1; key <= 601; key++) {
+    keys.push_back(key);
+  }
+  batch.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    batch[i].SetFromInteger(keys[i]);
+  }
+  tree.GetValues(batch, &results, transaction);
+  ASSERT_EQ(results.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(results[i].size(), keys[i] % 2 == 0 ? 1 : 0) << keys[i];
+    if (!results[i].empty()) {
+      EXPECT_EQ(results[i][0].GetSlotNum(), keys[i]);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+namespace {
+
+auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true, ",");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, ScanKeysTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  Query(bustub.get(), "CREATE TABLE t (a INTEGER, b INTEGER);");
+  Query(bustub.get(), "CREATE INDEX t_a ON t (a);");
+  Query(bustub.get(), "CREATE INDEX t_b ON t USING HASH (b);");
+  std::vector<std::string> rows;
+  for (int i = 0; i < 500; i += 5) {
+    rows.push_back(fmt::format("({}, {})", i, i));
+  }
+  Query(bustub.get(), fmt::format("INSERT INTO t VALUES {};", fmt::join(rows, ", ")));
+
+  // keys out of order, repeated and missing, each result must come back at the place of its key
+  std::vector<int> keys = {400, 5, 7, 495, 0, 400, 1000, 250, -1, 5, 250, 3};
+  for (const auto *index_name : {"t_a", "t_b"}) {
+    auto *index_info = bustub->catalog_->GetIndex(index_name, "t");
+    ASSERT_NE(index_info, nullptr);
+    std::vector<Tuple> key_tuples;
+    for (auto key : keys) {
+      key_tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(key)}, &index_info->key_schema_);
+    }
+    std::vector<std::vector<RID>> results;
+    index_info->index_->ScanKeys(key_tuples, &results, nullptr);
+    ASSERT_EQ(results.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      std::vector<RID> expected;
+      index_info->index_->ScanKey(key_tuples[i], &expected, nullptr);
+      EXPECT_EQ(results[i], expected) << index_name << " key " << keys[i];
+      EXPECT_EQ(results[i].size(), keys[i] >= 0 && keys[i] < 500 && keys[i] % 5 == 0 ? 1 : 0)
+          << index_name << " key " << keys[i];
+    }
+  }
+}
+
+}  // namespace bustub
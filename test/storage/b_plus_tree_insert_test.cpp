@@ -184,4 +184,42 @@ TEST(BPlusTreeTests, DISABLED_InsertTest3) {
   delete transaction;
   delete bpm;
 }
+// NOLINTNEXTLINE
+TEST(BPlusTreeTests, DuplicateKeyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // small leaves, so that many keys are the first key of their leaf
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  auto *transaction = new Transaction(0);
+
+  for (int64_t key = 1; key <= 30; key++) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction));
+  }
+  // a duplicate is rejected wherever its key sits in the leaf, the first slot included
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 30; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(tree.Insert(index_key, RID(1, static_cast<uint32_t>(key)), transaction)) << key;
+    rids.clear();
+    tree.GetValue(index_key, &rids);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], RID(0, static_cast<uint32_t>(key)));
+  }
+  size_t size = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    size++;
+  }
+  EXPECT_EQ(size, 30);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
 }  // namespace bustub
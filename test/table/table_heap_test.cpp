@@ -0,0 +1,742 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/util/hash_util.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/overflow_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeTuple(const Schema &schema, int id, size_t length) -> Tuple {
+  std::vector<Value> values{ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(std::string(length, 'x'))};
+  return {values, &schema};
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, FreeSpaceReuseTest) {
+  auto *disk_manager = new DiskManager("table_heap_reuse_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *table = new TableHeap(bpm);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 4096}});
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Three large tuples do not fit on one page and leave room behind on the first
+  auto first = table->InsertTuple(meta, MakeTuple(schema, 0, 1500));
+  auto second = table->InsertTuple(meta, MakeTuple(schema, 1, 1500));
+  auto third = table->InsertTuple(meta, MakeTuple(schema, 2, 1500));
+  ASSERT_EQ(first->GetPageId(), second->GetPageId());
+  ASSERT_NE(first->GetPageId(), third->GetPageId());
+  auto room = table->GetFreeSpaceMap().GetFreeSpace(first->GetPageId());
+  ASSERT_TRUE(room.has_value());
+  EXPECT_GT(*room, 500);
+
+  // A small tuple fills the gap on the first page instead of going to the tail
+  auto small = table->InsertTuple(meta, MakeTuple(schema, 3, 100));
+  EXPECT_EQ(first->GetPageId(), small->GetPageId());
+  EXPECT_LT(*table->GetFreeSpaceMap().GetFreeSpace(first->GetPageId()), *room);
+
+  std::set<int> ids;
+  for (auto iter = table->MakeEagerIterator(); !iter.IsEnd(); ++iter) {
+    ids.insert(iter.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ((std::set<int>{0, 1, 2, 3}), ids);
+
+  disk_manager->ShutDown();
+  remove("table_heap_reuse_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("table_heap_concurrent_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *table = new TableHeap(bpm);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 128}});
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  const int num_threads = 4;
+  const int per_thread = 2000;
+  std::mutex rids_latch;
+  std::unordered_set<RID> rids;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<RID> local;
+      for (int i = 0; i < per_thread; i++) {
+        int id = t * per_thread + i;
+        local.push_back(*table->InsertTuple(meta, MakeTuple(schema, id, id % 97)));
+      }
+      std::scoped_lock guard(rids_latch);
+      rids.insert(local.begin(), local.end());
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(num_threads * per_thread, rids.size());
+
+  // Every tuple is reachable from the page chain exactly once
+  std::set<int> ids;
+  size_t scanned = 0;
+  for (auto iter = table->MakeEagerIterator(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ(1, rids.count(iter.GetRID()));
+    ids.insert(iter.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+    scanned++;
+  }
+  EXPECT_EQ(rids.size(), scanned);
+  EXPECT_EQ(rids.size(), ids.size());
+
+  disk_manager->ShutDown();
+  remove("table_heap_concurrent_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, TransactionInsertPageTest) {
+  auto *disk_manager = new DiskManager("table_heap_txn_page_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *table = new TableHeap(bpm);
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 128}});
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Two open transactions each keep their own insert page
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+  std::vector<RID> rids1;
+  std::vector<RID> rids2;
+  for (int i = 0; i < 10; i++) {
+    rids1.push_back(*table->InsertTuple(meta, MakeTuple(schema, i, 10), nullptr, txn1));
+    rids2.push_back(*table->InsertTuple(meta, MakeTuple(schema, 100 + i, 10), nullptr, txn2));
+  }
+  for (int i = 1; i < 10; i++) {
+    EXPECT_EQ(rids1[0].GetPageId(), rids1[i].GetPageId());
+    EXPECT_EQ(rids2[0].GetPageId(), rids2[i].GetPageId());
+  }
+  EXPECT_NE(rids1[0].GetPageId(), rids2[0].GetPageId());
+  EXPECT_EQ(rids1[0].GetPageId(), txn1->GetInsertPageSet()->at(table));
+  EXPECT_FALSE(table->GetFreeSpaceMap().GetFreeSpace(rids1[0].GetPageId()).has_value());
+  // txn2 appended its page, which is claimed all the same, so a vacuum cannot remove it
+  EXPECT_FALSE(table->GetFreeSpaceMap().Remove(rids2[0].GetPageId()));
+
+  // A reserved page is handed back to the free space map when its transaction ends
+  txn_mgr.Commit(txn1);
+  txn_mgr.Abort(txn2);
+  EXPECT_TRUE(txn1->GetInsertPageSet()->empty());
+  EXPECT_TRUE(table->GetFreeSpaceMap().GetFreeSpace(rids1[0].GetPageId()).has_value());
+  EXPECT_TRUE(table->GetFreeSpaceMap().GetFreeSpace(rids2[0].GetPageId()).has_value());
+
+  // Pages linked by concurrent transactions are all reachable, whatever their id order
+  size_t scanned = 0;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    scanned++;
+  }
+  EXPECT_EQ(20, scanned);
+
+  delete txn1;
+  delete txn2;
+  disk_manager->ShutDown();
+  remove("table_heap_txn_page_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, VacuumTest) {
+  auto *disk_manager = new DiskManager("table_heap_vacuum_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *table = new TableHeap(bpm);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 128}});
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  const int num_tuples = 1000;
+  std::vector<RID> rids;
+  std::set<page_id_t> pages;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*table->InsertTuple(meta, MakeTuple(schema, i, 64)));
+    pages.insert(rids.back().GetPageId());
+  }
+  ASSERT_GT(pages.size(), 4);
+
+  // A delete that has not completed yet is never reclaimed
+  for (int i = 0; i < num_tuples; i++) {
+    if (i % 4 != 0) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, 1, true}, rids[i]);
+    }
+  }
+  auto stats = table->Vacuum();
+  EXPECT_EQ(0, stats.num_reclaimed_bytes_);
+  EXPECT_EQ(0, stats.num_freed_pages_);
+
+  // Completing the deletes lets vacuum reclaim them, whether the background worker got there first or not
+  for (int i = 0; i < num_tuples; i++) {
+    if (i % 4 != 0) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[i]);
+    }
+  }
+  table->Vacuum();
+  for (int i = 0; i < num_tuples; i++) {
+    auto [tuple_meta, tuple] = table->GetTuple(rids[i]);
+    EXPECT_EQ(i % 4 != 0, tuple_meta.is_deleted_);
+    if (i % 4 == 0) {
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+  }
+
+  // The reclaimed space takes new tuples before any page is appended
+  for (int i = 0; i < num_tuples / 2; i++) {
+    auto rid = table->InsertTuple(meta, MakeTuple(schema, num_tuples + i, 64));
+    EXPECT_EQ(1, pages.count(rid->GetPageId()));
+  }
+
+  // Pages left with only reclaimed tuples are unlinked, the first and the last page stay
+  std::set<int> live;
+  std::vector<RID> all_rids;
+  for (auto iter = table->MakeEagerIterator(); !iter.IsEnd(); ++iter) {
+    all_rids.push_back(iter.GetRID());
+  }
+  for (const auto &rid : all_rids) {
+    if (!table->GetTupleMeta(rid).is_deleted_) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rid);
+    }
+  }
+  stats = table->Vacuum();
+  EXPECT_EQ(pages.size() - 2, stats.num_freed_pages_);
+  std::set<page_id_t> remaining;
+  for (auto iter = table->MakeEagerIterator(); !iter.IsEnd(); ++iter) {
+    EXPECT_TRUE(iter.GetTuple().first.is_deleted_);
+    remaining.insert(iter.GetRID().GetPageId());
+  }
+  EXPECT_EQ(2, remaining.size());
+  auto rid = table->InsertTuple(meta, MakeTuple(schema, 0, 64));
+  EXPECT_EQ(1, remaining.count(rid->GetPageId()));
+
+  disk_manager->ShutDown();
+  remove("table_heap_vacuum_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, VacuumAbortedInsertPageTest) {
+  auto *disk_manager = new DiskManager("table_heap_vacuum_abort_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *table = new TableHeap(bpm);
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 128}});
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Each transaction inserts into a page of its own: txn1 claims the first page, txn2 and txn3 append theirs
+  std::vector<Transaction *> txns;
+  std::vector<std::vector<RID>> rids(3);
+  for (int t = 0; t < 3; t++) {
+    txns.push_back(txn_mgr.Begin());
+    for (int i = 0; i < 10; i++) {
+      auto rid = *table->InsertTuple(meta, MakeTuple(schema, t * 100 + i, 64), nullptr, txns[t]);
+      txns[t]->AppendTableWriteRecord(TableWriteRecord{0, rid, table});
+      rids[t].push_back(rid);
+    }
+  }
+  auto aborted_page_id = rids[1][0].GetPageId();
+  ASSERT_EQ(3, table->GetNumPages());
+  ASSERT_EQ(aborted_page_id, table->GetPageIds()[1]);
+
+  // The aborted page is vacuumed while a lock-free scan stands on it
+  txn_mgr.Commit(txns[0]);
+  txn_mgr.Commit(txns[2]);
+  txn_mgr.Abort(txns[1]);
+  {
+    auto iter = table->MakeEagerIterator();
+    while (iter.GetRID().GetPageId() != aborted_page_id) {
+      ++iter;
+    }
+    auto stats = table->Vacuum();
+    EXPECT_EQ(1, stats.num_freed_pages_);
+    EXPECT_EQ(2, table->GetNumPages());
+    EXPECT_EQ((std::vector<page_id_t>{rids[0][0].GetPageId(), rids[2][0].GetPageId()}), table->GetPageIds());
+
+    // The unlinked page stays readable, the scan moves on to the live tuples of the next page
+    std::vector<int32_t> ids;
+    for (; !iter.IsEnd(); ++iter) {
+      auto [tuple_meta, tuple] = iter.GetTuple();
+      if (!tuple_meta.is_deleted_) {
+        ids.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      }
+    }
+    std::vector<int32_t> expected;
+    for (int i = 0; i < 10; i++) {
+      expected.push_back(200 + i);
+    }
+    EXPECT_EQ(expected, ids);
+  }
+
+  // With the scan gone the next pass frees the page, and the table keeps working
+  table->Vacuum();
+  auto rid = table->InsertTuple(meta, MakeTuple(schema, 300, 64));
+  EXPECT_NE(aborted_page_id, rid->GetPageId());
+  size_t scanned = 0;
+  for (auto scan = table->MakeEagerIterator(); !scan.IsEnd(); ++scan) {
+    scanned += scan.GetTuple().first.is_deleted_ ? 0 : 1;
+  }
+  EXPECT_EQ(21, scanned);
+
+  for (auto *txn : txns) {
+    delete txn;
+  }
+  disk_manager->ShutDown();
+  remove("table_heap_vacuum_abort_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, BackgroundCompactionTest) {
+  auto *disk_manager = new DiskManager("table_heap_compaction_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *table = new TableHeap(bpm);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 128}});
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    rids.push_back(*table->InsertTuple(meta, MakeTuple(schema, i, 64)));
+  }
+  auto page_id = rids[0].GetPageId();
+  auto before = *table->GetFreeSpaceMap().GetFreeSpace(page_id);
+
+  // Deleting more than the dead fraction of a page wakes the worker, which compacts the page on its own
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == page_id && rid.GetSlotNum() % 2 == 0) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rid);
+    }
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (table->GetFreeSpaceMap().GetFreeSpace(page_id) == before && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GT(table->GetFreeSpaceMap().GetFreeSpace(page_id), before);
+  for (const auto &rid : rids) {
+    auto [tuple_meta, tuple] = table->GetTuple(rid);
+    if (!tuple_meta.is_deleted_) {
+      EXPECT_EQ(rid, rids[tuple.GetValue(&schema, 0).GetAs<int32_t>()]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("table_heap_compaction_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, OverflowTest) {
+  auto *disk_manager = new DiskManager("table_heap_overflow_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 65536}});
+  auto *table = new TableHeap(bpm, &schema);
+  auto *copy = new TableHeap(bpm, &schema);
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Values larger than a page are stored out of line, small tuples stay as they are
+  const size_t wide = 3 * BUSTUB_PAGE_SIZE;
+  std::vector<RID> rids;
+  for (int i = 0; i < 10; i++) {
+    auto rid = table->InsertTuple(meta, MakeTuple(schema, i, i % 2 == 0 ? wide : 16));
+    ASSERT_TRUE(rid.has_value());
+    rids.push_back(*rid);
+  }
+  for (int i = 0; i < 10; i++) {
+    auto [tuple_meta, tuple] = table->GetTuple(rids[i]);
+    EXPECT_LE(tuple.GetLength(), TableHeap::TOAST_TUPLE_THRESHOLD);
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::string(i % 2 == 0 ? wide : 16, 'x'), tuple.GetValue(&schema, 1).ToString());
+    EXPECT_FALSE(tuple.IsNull(&schema, 1));
+  }
+
+  // Narrow columns are read without touching the overflow pages, which a detached view cannot reach
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [tuple_meta, view] = iter.GetTupleView();
+    TupleView detached(view.GetData(), view.GetLength(), view.GetRid());
+    auto id = detached.GetValue(&schema, 0).GetAs<int32_t>();
+    if (id % 2 == 0) {
+      EXPECT_THROW(detached.GetValue(&schema, 1), Exception);
+    }
+    EXPECT_EQ(std::string(id % 2 == 0 ? wide : 16, 'x'), view.GetValue(&schema, 1).ToString());
+    copy->InsertTuple(meta, view.Materialize());
+  }
+
+  // Vacuum frees the chains of reclaimed tuples, the copies own chains of their own
+  for (int i = 0; i < 10; i++) {
+    table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[i]);
+  }
+  auto stats = table->Vacuum();
+  EXPECT_EQ(5 * ((wide + OVERFLOW_PAGE_CAPACITY - 1) / OVERFLOW_PAGE_CAPACITY), stats.num_freed_overflow_pages_);
+  int count = 0;
+  for (auto iter = copy->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [tuple_meta, tuple] = iter.GetTuple();
+    auto id = tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_EQ(std::string(id % 2 == 0 ? wide : 16, 'x'), tuple.GetValue(&schema, 1).ToString());
+    count++;
+  }
+  EXPECT_EQ(10, count);
+
+  disk_manager->ShutDown();
+  remove("table_heap_overflow_test.db");
+  delete copy;
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, OverflowReadAfterVacuumTest) {
+  auto *disk_manager = new DiskManager("table_heap_overflow_vacuum_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 65536}});
+  auto *table = new TableHeap(bpm, &schema);
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  const size_t wide = 3 * BUSTUB_PAGE_SIZE;
+  const size_t chain_pages = (wide + OVERFLOW_PAGE_CAPACITY - 1) / OVERFLOW_PAGE_CAPACITY;
+  auto deleted_rid = *table->InsertTuple(meta, MakeTuple(schema, 0, wide));
+  auto updated_rid = *table->InsertTuple(meta, MakeTuple(schema, 1, wide));
+
+  // A reader holds both tuples while one is deleted and reclaimed and the other one replaced
+  auto read_guard = std::make_unique<TableReadGuard>(table);
+  auto deleted = table->GetTuple(deleted_rid).second;
+  auto updated = table->GetTuple(updated_rid).second;
+  table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, deleted_rid);
+  std::vector<Value> values{ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue(std::string(wide, 'y'))};
+  table->UpdateTuple(Tuple(values, &schema), updated_rid);
+  auto stats = table->Vacuum();
+  EXPECT_EQ(0, stats.num_freed_overflow_pages_);
+
+  // Their toasted values are still there after the vacuum
+  EXPECT_EQ(std::string(wide, 'x'), deleted.GetValue(&schema, 1).ToString());
+  EXPECT_EQ(std::string(wide, 'x'), updated.GetValue(&schema, 1).ToString());
+  EXPECT_EQ(std::string(wide, 'y'), table->GetTuple(updated_rid).second.GetValue(&schema, 1).ToString());
+
+  // Once the reader is gone the next pass frees both chains
+  read_guard.reset();
+  stats = table->Vacuum();
+  EXPECT_EQ(2 * chain_pages, stats.num_freed_overflow_pages_);
+  EXPECT_EQ(std::string(wide, 'y'), table->GetTuple(updated_rid).second.GetValue(&schema, 1).ToString());
+
+  disk_manager->ShutDown();
+  remove("table_heap_overflow_vacuum_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, InPlaceUpdateTest) {
+  auto *disk_manager = new DiskManager("table_heap_update_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 65536}});
+  auto *table = new TableHeap(bpm, &schema);
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  const int num_tuples = 60;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    auto rid = table->InsertTuple(meta, MakeTuple(schema, i, 100));
+    ASSERT_TRUE(rid.has_value());
+    rids.push_back(*rid);
+  }
+  ASSERT_EQ(rids[0].GetPageId(), rids[3].GetPageId());
+  auto check = [&](int id, size_t length) {
+    auto [tuple_meta, tuple] = table->GetTuple(rids[id]);
+    EXPECT_EQ(id, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::string(length, 'x'), tuple.GetValue(&schema, 1).ToString());
+  };
+
+  // Shrinking stays in place, growing rearranges the page while the space freed by the shrink is there
+  table->UpdateTuple(MakeTuple(schema, 0, 10), rids[0]);
+  check(0, 10);
+  table->UpdateTuple(MakeTuple(schema, 1, 150), rids[1]);
+  check(1, 150);
+  EXPECT_FALSE(table->GetTupleMeta(rids[1]).is_forwarded_);
+
+  // A tuple that no longer fits is forwarded to another page, and comes back once it fits again
+  table->UpdateTuple(MakeTuple(schema, 2, 900), rids[2]);
+  EXPECT_TRUE(table->GetTupleMeta(rids[2]).is_forwarded_);
+  check(2, 900);
+  table->UpdateTuple(MakeTuple(schema, 2, 950), rids[2]);
+  check(2, 950);
+  table->UpdateTuple(MakeTuple(schema, 2, 10), rids[2]);
+  EXPECT_FALSE(table->GetTupleMeta(rids[2]).is_forwarded_);
+  check(2, 10);
+
+  // Scans see a forwarded tuple once, at its own RID
+  table->UpdateTuple(MakeTuple(schema, 3, 900), rids[3]);
+  std::set<int> seen;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [tuple_meta, view] = iter.GetTupleView();
+    auto id = view.GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_TRUE(seen.insert(id).second);
+    EXPECT_EQ(rids[id], iter.GetRID());
+    if (id == 3) {
+      EXPECT_EQ(std::string(900, 'x'), view.GetValue(&schema, 1).ToString());
+    }
+  }
+  EXPECT_EQ(num_tuples, seen.size());
+
+  // Reclaiming a forwarded tuple releases the slot storing it, the next pass reclaims that one too
+  table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[3]);
+  table->Vacuum();
+  auto stats = table->Vacuum();
+  EXPECT_EQ(0, stats.num_reclaimed_bytes_);
+  int count = 0;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [tuple_meta, tuple] = iter.GetTuple();
+    count += tuple_meta.is_deleted_ ? 0 : 1;
+  }
+  EXPECT_EQ(num_tuples - 1, count);
+
+  disk_manager->ShutDown();
+  remove("table_heap_update_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, PaxTest) {
+  auto *disk_manager = new DiskManager("table_heap_pax_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 65536}});
+  auto *table = new TableHeap(bpm, &schema, TableFormat::PAX);
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Short, wide and overflowing values all keep their fixed-size part in the minipages
+  const int num_tuples = 200;
+  const size_t wide = 3 * BUSTUB_PAGE_SIZE;
+  auto length = [&](int id) -> size_t { return id == 7 ? wide : id % 50 == 0 ? 900 : id % 10; };
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    auto rid = table->InsertTuple(meta, MakeTuple(schema, i, length(i)));
+    ASSERT_TRUE(rid.has_value());
+    rids.push_back(*rid);
+  }
+  {
+    auto page_guard = bpm->FetchPageRead(rids[0].GetPageId());
+    EXPECT_TRUE(page_guard.As<TablePage>()->IsPax());
+  }
+  for (int i = 0; i < num_tuples; i++) {
+    auto [tuple_meta, tuple] = table->GetTuple(rids[i]);
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::string(length(i), 'x'), tuple.GetValue(&schema, 1).ToString());
+  }
+
+  // A grown tuple is forwarded like in a row table
+  table->UpdateTuple(MakeTuple(schema, 1, 900), rids[1]);
+  EXPECT_TRUE(table->GetTupleMeta(rids[1]).is_forwarded_);
+  auto expected = [&](int id) -> size_t { return id == 1 ? 900 : length(id); };
+
+  // Reading some columns touches only their minipages and values, the whole tuple is still there
+  std::set<int> seen;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [tuple_meta, view] = iter.GetTupleColumns({0});
+    auto id = view.GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_TRUE(seen.insert(id).second);
+    EXPECT_EQ(rids[id], iter.GetRID());
+    auto [full_meta, full] = iter.GetTupleView();
+    EXPECT_EQ(std::string(expected(id), 'x'), full.GetValue(&schema, 1).ToString());
+    auto [column_meta, column] = iter.GetTupleColumns({1});
+    EXPECT_EQ(std::string(expected(id), 'x'), column.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(std::string(expected(id), 'x'), iter.GetTuple().second.GetValue(&schema, 1).ToString());
+  }
+  EXPECT_EQ(num_tuples, seen.size());
+
+  // Vacuum reclaims the varlen parts, the moved slot and the overflow pages
+  for (int i = 0; i < num_tuples; i++) {
+    table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[i]);
+  }
+  auto stats = table->Vacuum();
+  EXPECT_EQ((wide + OVERFLOW_PAGE_CAPACITY - 1) / OVERFLOW_PAGE_CAPACITY, stats.num_freed_overflow_pages_);
+  EXPECT_GT(stats.num_reclaimed_bytes_, 0);
+  table->Vacuum();
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    EXPECT_TRUE(iter.GetTupleView().first.is_deleted_);
+  }
+
+  disk_manager->ShutDown();
+  remove("table_heap_pax_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ZoneMapTest) {
+  auto *disk_manager = new DiskManager("table_heap_zone_map_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 4096}});
+  auto *table = new TableHeap(bpm, &schema);
+  auto *zone_map = table->GetZoneMap();
+  ASSERT_NE(nullptr, zone_map);
+  EXPECT_TRUE(zone_map->IsTracked(0));
+  EXPECT_FALSE(zone_map->IsTracked(1));
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Ids are inserted in order, so every page covers a range of its own
+  const int num_tuples = 300;
+  std::vector<RID> rids;
+  std::vector<page_id_t> pages;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*table->InsertTuple(meta, MakeTuple(schema, i, 100)));
+    if (pages.empty() || pages.back() != rids.back().GetPageId()) {
+      pages.push_back(rids.back().GetPageId());
+    }
+  }
+  ASSERT_GT(pages.size(), 2);
+  for (auto page_id : pages) {
+    int min = num_tuples;
+    int max = -1;
+    for (int i = 0; i < num_tuples; i++) {
+      if (rids[i].GetPageId() == page_id) {
+        min = std::min(min, i);
+        max = std::max(max, i);
+      }
+    }
+    auto zone = zone_map->GetZone(page_id);
+    ASSERT_TRUE(zone.has_value());
+    EXPECT_EQ(max - min + 1, zone->columns_[0].num_values_);
+    EXPECT_EQ(0, zone->columns_[0].null_count_);
+    EXPECT_EQ(min, zone->columns_[0].min_.GetAs<int32_t>());
+    EXPECT_EQ(max, zone->columns_[0].max_.GetAs<int32_t>());
+  }
+
+  // A scan can move on to the next page without reading the rest of the current one
+  auto iter = table->MakeIterator();
+  EXPECT_EQ(pages[0], iter.GetRID().GetPageId());
+  iter.GetTupleView();
+  iter.SkipPage();
+  EXPECT_EQ((RID{pages[1], 0}), iter.GetRID());
+  size_t num_pages = 1;
+  while (!iter.IsEnd()) {
+    iter.SkipPage();
+    num_pages++;
+  }
+  EXPECT_EQ(pages.size(), num_pages);
+
+  // Updates and nulls widen the zone of the page of the tuple, deletes leave it as it is
+  table->UpdateTuple(MakeTuple(schema, 10000, 100), rids[0]);
+  table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[1]);
+  std::vector<Value> values{ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetVarcharValue("x")};
+  auto null_rid = table->InsertTuple(meta, Tuple(values, &schema));
+  auto zone = zone_map->GetZone(pages[0]);
+  EXPECT_EQ(0, zone->columns_[0].min_.GetAs<int32_t>());
+  EXPECT_EQ(10000, zone->columns_[0].max_.GetAs<int32_t>());
+  EXPECT_EQ(1, zone_map->GetZone(null_rid->GetPageId())->columns_[0].null_count_);
+
+  disk_manager->ShutDown();
+  remove("table_heap_zone_map_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, DictionaryTest) {
+  auto *disk_manager = new DiskManager("table_heap_dictionary_test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema schema({Column{"id", TypeId::INTEGER}, Column{"s", TypeId::VARCHAR, 4096}});
+  auto *table = new TableHeap(bpm, &schema, TableFormat::ROW, TableEncoding::DICTIONARY);
+  TupleMeta meta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+
+  // Tuples keep a code in place of the string
+  const int num_tuples = 200;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*table->InsertTuple(meta, MakeTuple(schema, i, 100 + i % 4)));
+  }
+  EXPECT_EQ(4, table->GetDictionary()->Size());
+  auto [meta0, tuple0] = table->GetTuple(rids[0]);
+  auto [meta4, tuple4] = table->GetTuple(rids[4]);
+  auto [meta5, tuple5] = table->GetTuple(rids[5]);
+  EXPECT_EQ(schema.GetLength() + VARLEN_DICTIONARY_CODE_SIZE, tuple0.GetLength());
+
+  // Values of the dictionary compare by code and hash like the strings they stand for
+  auto value0 = tuple0.GetValue(&schema, 1);
+  auto value4 = tuple4.GetValue(&schema, 1);
+  auto value5 = tuple5.GetValue(&schema, 1);
+  auto plain = ValueFactory::GetVarcharValue(std::string(100, 'x'));
+  ASSERT_NE(nullptr, value0.GetDictionaryEntry());
+  EXPECT_EQ(value0.GetDictionaryEntry(), value4.GetDictionaryEntry());
+  EXPECT_EQ(std::string(100, 'x'), value0.ToString());
+  EXPECT_EQ(CmpBool::CmpTrue, value0.CompareEquals(value4));
+  EXPECT_EQ(CmpBool::CmpFalse, value0.CompareEquals(value5));
+  EXPECT_EQ(CmpBool::CmpTrue, value0.CompareEquals(plain));
+  EXPECT_EQ(HashUtil::HashValue(&plain), HashUtil::HashValue(&value0));
+
+  // A tuple of the dictionary stored in a plain heap is decoded first
+  auto *plain_table = new TableHeap(bpm, &schema);
+  auto plain_rid = plain_table->InsertTuple(meta, tuple5);
+  auto [plain_meta, plain_tuple] = plain_table->GetTuple(*plain_rid);
+  EXPECT_EQ(nullptr, plain_tuple.GetValue(&schema, 1).GetDictionaryEntry());
+  EXPECT_EQ(std::string(101, 'x'), plain_tuple.GetValue(&schema, 1).ToString());
+
+  // Once the dictionary is full, new strings are stored as they are
+  Dictionary dictionary;
+  for (uint32_t i = 0; i < Dictionary::CAPACITY; i++) {
+    auto s = std::to_string(i);
+    ASSERT_EQ(i, dictionary.Intern(s.c_str(), s.size() + 1)->code_);
+  }
+  auto s = std::to_string(Dictionary::CAPACITY);
+  EXPECT_EQ(nullptr, dictionary.Intern(s.c_str(), s.size() + 1));
+  EXPECT_EQ(nullptr, dictionary.Find(s.c_str(), s.size() + 1));
+  EXPECT_EQ(7, dictionary.Find("7", 2)->code_);
+  EXPECT_EQ("7", std::string(dictionary.GetEntry(7)->data_.c_str()));
+
+  disk_manager->ShutDown();
+  remove("table_heap_dictionary_test.db");
+  delete plain_table;
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -17,10 +17,14 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -61,4 +65,67 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TupleViewTest) {
+  Schema schema{std::vector<Column>{{"id", TypeId::INTEGER}, {"name", TypeId::VARCHAR, 64}}};
+  auto *disk_manager = new DiskManager("tuple_view_test.db");
+  // A handful of frames: a scan that leaks a pin runs out of them
+  auto *bpm = new BufferPoolManager(4, disk_manager);
+  auto *table = new TableHeap(bpm);
+
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("name-" + std::to_string(i))},
+                &schema};
+    ASSERT_NE(std::nullopt, table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+
+  auto id_expr = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto name_expr = std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR);
+  auto name_const = std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue("name-42"));
+  ComparisonExpression name_pred{name_expr, name_const, ComparisonType::Equal};
+
+  int count = 0;
+  int matches = 0;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, view] = iter.GetTupleView();
+    EXPECT_FALSE(meta.is_deleted_);
+    EXPECT_EQ(iter.GetRID(), view.GetRid());
+    EXPECT_EQ(count, id_expr->EvaluateView(view, schema).GetAs<int32_t>());
+
+    // The varchar value points into the page instead of owning a copy
+    auto name = view.GetValue(&schema, 1);
+    EXPECT_GE(name.GetData(), view.GetData());
+    EXPECT_LT(name.GetData(), view.GetData() + view.GetLength());
+    EXPECT_EQ("name-" + std::to_string(count), name.ToString());
+    if (name_pred.EvaluateView(view, schema).GetAs<bool>()) {
+      matches++;
+    }
+
+    auto tuple = view.Materialize();
+    EXPECT_EQ(view.GetRid(), tuple.GetRid());
+    EXPECT_EQ(view.GetLength(), tuple.GetLength());
+    EXPECT_EQ(name.ToString(), tuple.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(iter.GetTuple().second.GetLength(), tuple.GetLength());
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_EQ(1, matches);
+
+  // Every page was released by the scan
+  std::vector<page_id_t> page_ids(4);
+  for (auto &page_id : page_ids) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (auto page_id : page_ids) {
+    bpm->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("tuple_view_test.db");
+  delete table;
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
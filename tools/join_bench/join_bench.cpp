@@ -0,0 +1,197 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "catalog/schema.h"
+#include "common/util/hash_util.h"
+#include "execution/join_hash_table.h"
+#include "fmt/format.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+namespace {
+
+using bustub::hash_t;
+using bustub::JoinHashTable;
+using bustub::Tuple;
+using bustub::TupleView;
+using bustub::Value;
+
+/** The layout the hash join had before JoinHashTable: a node per key holding a vector of tuples */
+struct NodeKey {
+  std::vector<Value> keys_;
+
+  auto operator==(const NodeKey &other) const -> bool {
+    for (size_t i = 0; i < keys_.size(); i++) {
+      if (keys_[i].CompareEquals(other.keys_[i]) != bustub::CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+struct NodeKeyHash {
+  auto operator()(const NodeKey &key) const -> size_t {
+    size_t hash = 0;
+    for (const auto &value : key.keys_) {
+      hash = bustub::HashUtil::CombineHashes(hash, bustub::HashUtil::HashValue(&value));
+    }
+    return hash;
+  }
+};
+
+struct BenchResult {
+  uint64_t build_ms_{0};
+  uint64_t probe_ms_{0};
+  size_t matches_{0};
+};
+
+/** A build or probe side: a batch of key values, one column, and the tuples of the rows */
+struct Side {
+  std::vector<std::vector<Value>> keys_;
+  std::vector<Tuple> tuples_;
+};
+
+auto MakeSide(const bustub::Schema &schema, size_t num_rows, size_t key_range, std::mt19937_64 *gen) -> Side {
+  std::uniform_int_distribution<int32_t> dist(0, static_cast<int32_t>(key_range) - 1);
+  Side side;
+  side.keys_.resize(1);
+  for (size_t i = 0; i < num_rows; i++) {
+    auto key = bustub::ValueFactory::GetIntegerValue(dist(*gen));
+    side.keys_[0].push_back(key);
+    side.tuples_.emplace_back(
+        std::vector<Value>{key, bustub::ValueFactory::GetIntegerValue(static_cast<int32_t>(i)),
+                           bustub::ValueFactory::GetVarcharValue(fmt::format("payload{}", i))},
+        &schema);
+  }
+  return side;
+}
+
+auto RunNodeTable(const Side &build, const Side &probe) -> BenchResult {
+  BenchResult result;
+  auto start = ClockMs();
+  std::unordered_map<NodeKey, std::vector<Tuple>, NodeKeyHash> table;
+  for (size_t i = 0; i < build.tuples_.size(); i++) {
+    table[NodeKey{{build.keys_[0][i]}}].push_back(build.tuples_[i]);
+  }
+  result.build_ms_ = ClockMs() - start;
+  start = ClockMs();
+  for (size_t i = 0; i < probe.tuples_.size(); i++) {
+    auto it = table.find(NodeKey{{probe.keys_[0][i]}});
+    if (it != table.end()) {
+      result.matches_ += it->second.size();
+    }
+  }
+  result.probe_ms_ = ClockMs() - start;
+  return result;
+}
+
+auto RunJoinHashTable(const Side &build, const Side &probe, size_t batch_size) -> BenchResult {
+  BenchResult result;
+  auto start = ClockMs();
+  JoinHashTable table(1);
+  auto keys = build.keys_;
+  for (size_t i = 0; i < build.tuples_.size(); i++) {
+    table.Append(JoinHashTable::HashKey(keys, i), &keys, i, build.tuples_[i]);
+  }
+  table.Build();
+  result.build_ms_ = ClockMs() - start;
+  start = ClockMs();
+  // Probed a batch at a time, as the hash join does
+  std::vector<std::vector<Value>> batch_keys(1);
+  std::vector<hash_t> hashes;
+  std::vector<uint32_t> heads;
+  for (size_t begin = 0; begin < probe.tuples_.size(); begin += batch_size) {
+    auto end = std::min(begin + batch_size, probe.tuples_.size());
+    batch_keys[0].assign(probe.keys_[0].begin() + begin, probe.keys_[0].begin() + end);
+    hashes.resize(end - begin);
+    for (size_t i = 0; i < hashes.size(); i++) {
+      hashes[i] = JoinHashTable::HashKey(batch_keys, i);
+    }
+    table.FindBatch(hashes, batch_keys, &heads);
+    for (auto head : heads) {
+      for (auto row = head; row != JoinHashTable::NO_ROW; row = table.NextMatch(row)) {
+        result.matches_++;
+      }
+    }
+  }
+  result.probe_ms_ = ClockMs() - start;
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-join-bench");
+  program.add_argument("--build-rows").help("number of rows on the build side");
+  program.add_argument("--probe-rows").help("number of rows on the probe side");
+  program.add_argument("--keys").help("number of distinct join keys the rows are drawn from");
+  program.add_argument("--batch").help("number of probe rows looked up at a time");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t build_rows = 1000000;
+  if (program.present("--build-rows")) {
+    build_rows = std::stoul(program.get("--build-rows"));
+  }
+  size_t probe_rows = 4000000;
+  if (program.present("--probe-rows")) {
+    probe_rows = std::stoul(program.get("--probe-rows"));
+  }
+  size_t num_keys = 2000000;
+  if (program.present("--keys")) {
+    num_keys = std::stoul(program.get("--keys"));
+  }
+  size_t batch_size = 2048;
+  if (program.present("--batch")) {
+    batch_size = std::stoul(program.get("--batch"));
+  }
+
+  fmt::print(stderr, "[info] build_rows={}, probe_rows={}, keys={}, batch={}\n", build_rows, probe_rows, num_keys,
+             batch_size);
+
+  bustub::Schema schema({bustub::Column("key", bustub::TypeId::INTEGER),
+                         bustub::Column("id", bustub::TypeId::INTEGER),
+                         bustub::Column("payload", bustub::TypeId::VARCHAR, 32)});
+  std::mt19937_64 gen(42);
+  auto build = MakeSide(schema, build_rows, num_keys, &gen);
+  auto probe = MakeSide(schema, probe_rows, num_keys, &gen);
+
+  fmt::print(stderr, "[info] benchmark start\n");
+  auto node = RunNodeTable(build, probe);
+  auto flat = RunJoinHashTable(build, probe, batch_size);
+  if (node.matches_ != flat.matches_) {
+    fmt::print(stderr, "[error] the tables found {} and {} matches\n", node.matches_, flat.matches_);
+    return 1;
+  }
+
+  auto rate = [](size_t rows, uint64_t ms) { return rows / static_cast<double>(std::max<uint64_t>(ms, 1)) * 1000; };
+  fmt::print("<<< BEGIN\n");
+  fmt::print("matches: {}\n", flat.matches_);
+  fmt::print("unordered_map build: {:.0f} rows/s, probe: {:.0f} rows/s\n", rate(build_rows, node.build_ms_),
+             rate(probe_rows, node.probe_ms_));
+  fmt::print("join_hash_table build: {:.0f} rows/s, probe: {:.0f} rows/s\n", rate(build_rows, flat.build_ms_),
+             rate(probe_rows, flat.probe_ms_));
+  fmt::print(">>> END\n");
+  return 0;
+}